@@ -0,0 +1,68 @@
+#include "agreement_ops.h"
+
+#include <iomanip>
+
+#include "report.h"
+
+namespace bench {
+
+const char* agreementModeName(AgreementMode mode) {
+    return mode == AgreementMode::Static ? "static" : "ephemeral";
+}
+
+EphemeralAgreementOperation::~EphemeralAgreementOperation() {
+    if (times_) {
+        times_->add(totals_);
+    }
+    EVP_PKEY_free(peer_);
+    EVP_PKEY_CTX_free(keygen_ctx_);
+}
+
+StaticAgreementOperation::StaticAgreementOperation(EVP_PKEY* key, EVP_PKEY* peer, OSSL_LIB_CTX* libctx,
+                                                   HandshakeTimes* times)
+    : key_(key), peer_(peer), ctx_(EVP_PKEY_CTX_new_from_pkey(libctx, key, nullptr)), ready_(false), timer_(true),
+      times_(times) {
+    ready_ = ctx_ != nullptr && EVP_PKEY_derive_init(ctx_) > 0 && EVP_PKEY_derive_set_peer(ctx_, peer_) > 0;
+}
+
+StaticAgreementOperation::~StaticAgreementOperation() {
+    if (times_) {
+        times_->add(totals_);
+    }
+    EVP_PKEY_CTX_free(ctx_);
+    EVP_PKEY_free(peer_);
+    EVP_PKEY_free(key_);
+}
+
+void printAgreementTable(std::ostream& out, const std::vector<AgreementResult>& results) {
+    if (results.empty()) {
+        return;
+    }
+
+    out << std::endl;
+    out << std::left << std::setw(8) << "Curve" << std::setw(11) << "Mode" << std::right << std::setw(12) << "ops/s"
+        << std::setw(11) << "p50(ms)" << std::setw(11) << "p99(ms)" << std::setw(11) << "p99.9(ms)" << std::setw(12)
+        << "keygen(us)" << std::setw(12) << "derive(us)" << std::endl;
+    for (const auto& r : results) {
+        const HandshakeTimes& t = r.times;
+        out << std::left << std::setw(8) << r.curve << std::setw(11) << agreementModeName(r.mode) << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12) << r.throughput << std::setprecision(3)
+            << std::setw(11) << nsToMs(r.p50_ns) << std::setw(11) << nsToMs(r.p99_ns) << std::setw(11)
+            << nsToMs(r.p999_ns) << std::setprecision(1);
+        if (r.mode == AgreementMode::Ephemeral) {
+            out << std::setw(12) << meanUs(t.keygen_ns, t.operations);
+        } else {
+            out << std::setw(12) << "-";
+        }
+        out << std::setw(12) << meanUs(t.derive_ns, t.operations);
+        if (r.failures > 0) {
+            out << "  (" << r.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "ephemeral: key pair generation plus derive per handshake; static: EVP_PKEY_derive on a context"
+        << std::endl;
+    out << "set up once with both long-lived keys. keygen/derive are mean times per operation." << std::endl;
+}
+
+} // namespace bench
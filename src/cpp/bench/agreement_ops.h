@@ -0,0 +1,136 @@
+#ifndef BENCH_AGREEMENT_OPS_H
+#define BENCH_AGREEMENT_OPS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "engine.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+enum class AgreementMode {
+    Ephemeral, // fresh key pair plus derive per handshake, as an (EC)DHE server does
+    Static     // derive only, between two long-lived keys
+};
+
+const char* agreementModeName(AgreementMode mode);
+
+// Time spent generating the ephemeral key and deriving, summed over a
+// worker's handshakes. Static runs only fill derive_ns.
+struct HandshakeTimes {
+    uint64_t operations = 0;
+    uint64_t keygen_ns = 0;
+    uint64_t derive_ns = 0;
+
+    void add(const HandshakeTimes& other) {
+        operations += other.operations;
+        keygen_ns += other.keygen_ns;
+        derive_ns += other.derive_ns;
+    }
+};
+
+// Derive a shared secret from `key` and `peer` with a fresh context:
+// EVP_PKEY_derive_init, EVP_PKEY_derive_set_peer (which validates the peer
+// key) and EVP_PKEY_derive.
+inline bool deriveSecret(OSSL_LIB_CTX* libctx, EVP_PKEY* key, EVP_PKEY* peer, unsigned char* secret,
+                         size_t* secret_len) {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_pkey(libctx, key, nullptr);
+    bool ok = ctx != nullptr && EVP_PKEY_derive_init(ctx) > 0 && EVP_PKEY_derive_set_peer(ctx, peer) > 0 &&
+              EVP_PKEY_derive(ctx, secret, secret_len) > 0;
+    EVP_PKEY_CTX_free(ctx);
+    return ok;
+}
+
+// One ephemeral handshake: generate a key pair on the worker's reused keygen
+// context, then derive with the peer's public key. The peer key is fixed, but
+// it is set and validated on every handshake as it would be for a new client.
+class EphemeralAgreementOperation : public Operation {
+public:
+    // Takes ownership of `keygen_ctx` and `peer`.
+    EphemeralAgreementOperation(EVP_PKEY_CTX* keygen_ctx, EVP_PKEY* peer, OSSL_LIB_CTX* libctx,
+                                HandshakeTimes* times)
+        : keygen_ctx_(keygen_ctx), peer_(peer), libctx_(libctx), timer_(true), times_(times) {}
+
+    ~EphemeralAgreementOperation();
+
+    EphemeralAgreementOperation(const EphemeralAgreementOperation&) = delete;
+    EphemeralAgreementOperation& operator=(const EphemeralAgreementOperation&) = delete;
+
+    bool operator()() {
+        EVP_PKEY* key = nullptr;
+        size_t secret_len = sizeof(secret_);
+        timer_.start();
+        bool ok = EVP_PKEY_keygen(keygen_ctx_, &key) > 0;
+        timer_.lap(totals_.keygen_ns);
+        ok = ok && deriveSecret(libctx_, key, peer_, secret_, &secret_len);
+        timer_.lap(totals_.derive_ns);
+        EVP_PKEY_free(key);
+        totals_.operations++;
+        return ok;
+    }
+
+private:
+    EVP_PKEY_CTX* keygen_ctx_;
+    EVP_PKEY* peer_;
+    OSSL_LIB_CTX* libctx_;
+    unsigned char secret_[128]; // X448 and P-521 secrets are 56 and 66 bytes
+    PhaseTimer timer_;
+    HandshakeTimes totals_;
+    HandshakeTimes* times_;
+};
+
+// Static-static agreement: the derive context is initialised and given the
+// peer once, so each operation is a bare EVP_PKEY_derive.
+class StaticAgreementOperation : public Operation {
+public:
+    // Takes ownership of `key` and `peer`.
+    StaticAgreementOperation(EVP_PKEY* key, EVP_PKEY* peer, OSSL_LIB_CTX* libctx, HandshakeTimes* times);
+    ~StaticAgreementOperation();
+
+    StaticAgreementOperation(const StaticAgreementOperation&) = delete;
+    StaticAgreementOperation& operator=(const StaticAgreementOperation&) = delete;
+
+    bool valid() const { return ready_; }
+
+    bool operator()() {
+        size_t secret_len = sizeof(secret_);
+        timer_.start();
+        bool ok = EVP_PKEY_derive(ctx_, secret_, &secret_len) > 0;
+        timer_.lap(totals_.derive_ns);
+        totals_.operations++;
+        return ok;
+    }
+
+private:
+    EVP_PKEY* key_;
+    EVP_PKEY* peer_;
+    EVP_PKEY_CTX* ctx_;
+    bool ready_;
+    unsigned char secret_[128];
+    PhaseTimer timer_;
+    HandshakeTimes totals_;
+    HandshakeTimes* times_;
+};
+
+struct AgreementResult {
+    std::string curve;
+    AgreementMode mode = AgreementMode::Ephemeral;
+    double throughput = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t failures = 0;
+    HandshakeTimes times;
+};
+
+// One row per curve and mode: rate, percentiles and, for ephemeral
+// handshakes, how the time splits between keygen and derive.
+void printAgreementTable(std::ostream& out, const std::vector<AgreementResult>& results);
+
+} // namespace bench
+
+#endif // BENCH_AGREEMENT_OPS_H
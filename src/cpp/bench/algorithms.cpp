@@ -0,0 +1,39 @@
+#include "algorithms.h"
+
+namespace bench {
+
+bool parseFetchMode(const std::string& name, FetchMode& mode) {
+    if (name == "implicit") {
+        mode = FetchMode::Implicit;
+    } else if (name == "explicit") {
+        mode = FetchMode::Explicit;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* fetchModeName(FetchMode mode) {
+    return mode == FetchMode::Explicit ? "explicit (EVP_MD_fetch once)" : "implicit (EVP_sha256() per init)";
+}
+
+FetchedAlgorithms::~FetchedAlgorithms() {
+    EVP_SIGNATURE_free(signature_);
+    EVP_MD_free(sha256_);
+}
+
+bool FetchedAlgorithms::fetch(const char* signature_name) {
+    if (!sha256_) {
+        sha256_ = EVP_MD_fetch(nullptr, "SHA256", nullptr);
+    }
+    if (signature_ && !EVP_SIGNATURE_is_a(signature_, signature_name)) {
+        EVP_SIGNATURE_free(signature_);
+        signature_ = nullptr;
+    }
+    if (!signature_) {
+        signature_ = EVP_SIGNATURE_fetch(nullptr, signature_name, nullptr);
+    }
+    return sha256_ != nullptr && signature_ != nullptr;
+}
+
+} // namespace bench
@@ -0,0 +1,45 @@
+#ifndef BENCH_ALGORITHMS_H
+#define BENCH_ALGORITHMS_H
+
+#include <string>
+#include <openssl/evp.h>
+
+namespace bench {
+
+// How the hot loops obtain their algorithm implementations.
+enum class FetchMode {
+    Implicit, // pass EVP_sha256(), which OpenSSL 3 resolves through the provider store on every init
+    Explicit  // EVP_MD_fetch once up front and pass the fetched object everywhere
+};
+
+bool parseFetchMode(const std::string& name, FetchMode& mode);
+const char* fetchModeName(FetchMode mode);
+
+// Algorithm objects fetched once from the default library context and
+// shared read-only by every worker for the length of a run.
+//
+// The EVP_SIGNATURE is held rather than passed on: OpenSSL 3.0 has no init
+// call that accepts one (EVP_PKEY_sign_init_ex2 arrived in 3.2), so holding
+// it only keeps the provider's implementation pinned in the store.
+class FetchedAlgorithms {
+public:
+    FetchedAlgorithms() : sha256_(nullptr), signature_(nullptr) {}
+    ~FetchedAlgorithms();
+
+    FetchedAlgorithms(const FetchedAlgorithms&) = delete;
+    FetchedAlgorithms& operator=(const FetchedAlgorithms&) = delete;
+
+    // Fetch SHA-256 and the named signature algorithm ("ECDSA", "RSA",
+    // "ED25519"), replacing a different one fetched earlier.
+    bool fetch(const char* signature_name);
+
+    const EVP_MD* sha256() const { return sha256_; }
+
+private:
+    EVP_MD* sha256_;
+    EVP_SIGNATURE* signature_;
+};
+
+} // namespace bench
+
+#endif // BENCH_ALGORITHMS_H
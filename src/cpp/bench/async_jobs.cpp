@@ -0,0 +1,24 @@
+#include "async_jobs.h"
+
+#include <iostream>
+
+namespace bench {
+
+bool initAsyncThread(int jobs) {
+    if (!ASYNC_is_capable()) {
+        std::cerr << "ASYNC jobs are not supported on this platform" << std::endl;
+        return false;
+    }
+    // Every job stays paused between its turns, so the pool must hold all of them
+    if (!ASYNC_init_thread(static_cast<size_t>(jobs), static_cast<size_t>(jobs))) {
+        std::cerr << "Failed to create a pool of " << jobs << " ASYNC jobs" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void cleanupAsyncThread() {
+    ASYNC_cleanup_thread();
+}
+
+} // namespace bench
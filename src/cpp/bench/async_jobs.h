@@ -0,0 +1,128 @@
+#ifndef BENCH_ASYNC_JOBS_H
+#define BENCH_ASYNC_JOBS_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <openssl/async.h>
+
+namespace bench {
+
+// Prepare the calling thread to run `jobs` ASYNC_JOBs at once. False if
+// OpenSSL has no fiber support on this platform.
+bool initAsyncThread(int jobs);
+
+void cleanupAsyncThread();
+
+// --async K: a worker's K operations, each driven by its own ASYNC_JOB and
+// resumed round-robin, the way a service keeps several requests in flight
+// per thread through ASYNC_start_job so an offload engine can later pause
+// them while hardware works.
+//
+// Each job loops over its operation and calls ASYNC_pause_job() after every
+// call, so one engine iteration is one resume: a fiber switch in, the
+// operation, and a switch back out. Software providers never pause on their
+// own, so this is the fixed cost of the async plumbing with nothing to hide
+// behind it. The operations are created and destroyed on the worker thread,
+// and the jobs are run to completion before that.
+template <typename Op>
+class AsyncJobsOperation {
+public:
+    explicit AsyncJobsOperation(std::vector<std::unique_ptr<Op>> ops) : slots_(ops.size()), next_(0), ready_(false) {
+        for (size_t i = 0; i < ops.size(); i++) {
+            slots_[i].op = std::move(ops[i]);
+        }
+        initialised_ = initAsyncThread(static_cast<int>(slots_.size()));
+        ready_ = initialised_ && !slots_.empty();
+        for (auto& slot : slots_) {
+            slot.wait_ctx = ASYNC_WAIT_CTX_new();
+            ready_ = ready_ && slot.wait_ctx != nullptr;
+        }
+    }
+
+    ~AsyncJobsOperation() {
+        // Let every paused job leave its loop and finish
+        for (auto& slot : slots_) {
+            slot.stop = true;
+            int ret = 0;
+            while (slot.job && ASYNC_start_job(&slot.job, slot.wait_ctx, &ret, runJob, nullptr, 0) == ASYNC_PAUSE) {
+            }
+            ASYNC_WAIT_CTX_free(slot.wait_ctx);
+        }
+        slots_.clear();
+        if (initialised_) {
+            cleanupAsyncThread();
+        }
+    }
+
+    AsyncJobsOperation(const AsyncJobsOperation&) = delete;
+    AsyncJobsOperation& operator=(const AsyncJobsOperation&) = delete;
+
+    bool valid() const { return ready_; }
+
+    void prepare() { slots_[next_].op->prepare(); }
+
+    bool operator()() {
+        Slot* slot = &slots_[next_];
+        next_ = next_ + 1 == slots_.size() ? 0 : next_ + 1;
+        int ret = 0;
+        // Starts the job on first use; afterwards the function and argument are ignored and it resumes
+        if (ASYNC_start_job(&slot->job, slot->wait_ctx, &ret, runJob, &slot, sizeof(slot)) != ASYNC_PAUSE) {
+            slot->job = nullptr;
+            return false;
+        }
+        return slot->ok;
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<Op> op;
+        ASYNC_JOB* job = nullptr;
+        ASYNC_WAIT_CTX* wait_ctx = nullptr;
+        bool ok = false;
+        bool stop = false;
+    };
+
+    // The job body; ASYNC_start_job hands it a copy of the Slot pointer
+    static int runJob(void* arg) {
+        Slot* slot = *static_cast<Slot**>(arg);
+        while (!slot->stop) {
+            slot->ok = (*slot->op)();
+            ASYNC_pause_job();
+        }
+        return 1;
+    }
+
+    std::vector<Slot> slots_; // never resized once jobs hold pointers into it
+    size_t next_;
+    bool initialised_;
+    bool ready_;
+};
+
+namespace detail {
+
+// Wrap `jobs` operations from `make_op` for one worker, or nullptr on failure.
+template <typename OpFactory>
+auto makeAsyncJobs(int jobs, OpFactory& make_op, int thread_index)
+    -> std::unique_ptr<AsyncJobsOperation<typename decltype(make_op(0))::element_type>> {
+    typedef typename decltype(make_op(0))::element_type Op;
+    std::vector<std::unique_ptr<Op>> ops;
+    for (int j = 0; j < jobs; j++) {
+        std::unique_ptr<Op> op = make_op(thread_index);
+        if (!op) {
+            return nullptr;
+        }
+        ops.push_back(std::move(op));
+    }
+    std::unique_ptr<AsyncJobsOperation<Op>> async(new AsyncJobsOperation<Op>(std::move(ops)));
+    if (!async->valid()) {
+        return nullptr;
+    }
+    return async;
+}
+
+} // namespace detail
+
+} // namespace bench
+
+#endif // BENCH_ASYNC_JOBS_H
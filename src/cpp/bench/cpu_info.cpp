@@ -0,0 +1,111 @@
+#include "cpu_info.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <unistd.h>
+
+namespace bench {
+
+int logicalCpuCount() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+static bool readIntFile(const std::string& path, int& value) {
+    std::ifstream in(path);
+    return static_cast<bool>(in >> value);
+}
+
+int physicalCoreCount() {
+    long configured = sysconf(_SC_NPROCESSORS_CONF);
+    std::set<std::pair<int, int>> cores;
+    for (long cpu = 0; cpu < configured; cpu++) {
+        std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        int online = 1;
+        if (readIntFile(base + "/online", online) && online == 0) {
+            continue; // cpu0 usually has no "online" file and is always online
+        }
+        int package = 0;
+        int core = 0;
+        if (!readIntFile(base + "/topology/physical_package_id", package) ||
+            !readIntFile(base + "/topology/core_id", core)) {
+            continue;
+        }
+        cores.insert(std::make_pair(package, core));
+    }
+    return cores.empty() ? logicalCpuCount() : static_cast<int>(cores.size());
+}
+
+std::string cpuModelName() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos && colon + 2 <= line.size()) {
+                return line.substr(colon + 2);
+            }
+        }
+    }
+    return "unknown";
+}
+
+std::string cpuCryptoFlags() {
+    static const char* kCryptoFlags[] = {"aes", "sha_ni", "avx", "avx2", "sse4_1", "sse4_2",
+                                         "pclmulqdq", "rdrand", "rdseed"};
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 5, "flags") != 0) {
+            continue;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            break;
+        }
+        std::istringstream flags(line.substr(colon + 1));
+        std::string flag;
+        std::string found;
+        while (flags >> flag) {
+            for (const char* wanted : kCryptoFlags) {
+                if (flag == wanted) {
+                    found += (found.empty() ? "" : ", ") + flag;
+                }
+            }
+        }
+        return found.empty() ? "none detected" : found;
+    }
+    return "unavailable";
+}
+
+std::vector<CacheLevel> dataCacheLevels() {
+    std::vector<CacheLevel> levels;
+    for (int index = 0;; index++) {
+        std::string base = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index);
+        std::ifstream type_file(base + "/type");
+        std::string type;
+        if (!(type_file >> type)) {
+            break;
+        }
+        int level = 0;
+        std::ifstream size_file(base + "/size");
+        std::string size;
+        if (type == "Instruction" || !readIntFile(base + "/level", level) || !(size_file >> size)) {
+            continue;
+        }
+        // "48K", "2048K", "32M"
+        uint64_t bytes = std::strtoull(size.c_str(), nullptr, 10);
+        char unit = size.empty() ? '\0' : size[size.size() - 1];
+        bytes *= unit == 'K' ? 1024 : unit == 'M' ? 1024 * 1024 : unit == 'G' ? 1024 * 1024 * 1024 : 1;
+        levels.push_back(CacheLevel{level, bytes});
+    }
+    std::sort(levels.begin(), levels.end(),
+              [](const CacheLevel& a, const CacheLevel& b) { return a.level < b.level; });
+    return levels;
+}
+
+} // namespace bench
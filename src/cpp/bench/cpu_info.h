@@ -0,0 +1,37 @@
+#ifndef BENCH_CPU_INFO_H
+#define BENCH_CPU_INFO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Online logical CPUs (hardware threads), at least 1.
+int logicalCpuCount();
+
+// Distinct (package, core) pairs among the online CPUs in sysfs, i.e. the
+// logical count with SMT siblings folded together. Falls back to the
+// logical count when the topology files are unavailable.
+int physicalCoreCount();
+
+// "model name" from /proc/cpuinfo, or "unknown".
+std::string cpuModelName();
+
+// The crypto-relevant instruction set flags (AES-NI, SHA-NI, AVX2, ...) from
+// /proc/cpuinfo, comma separated; "none detected" or "unavailable".
+std::string cpuCryptoFlags();
+
+// One level of the data cache hierarchy as CPU 0 sees it.
+struct CacheLevel {
+    int level;           // 1, 2, 3, ...
+    uint64_t size_bytes;
+};
+
+// CPU 0's data and unified caches from sysfs, L1d first; empty when sysfs
+// doesn't describe them.
+std::vector<CacheLevel> dataCacheLevels();
+
+} // namespace bench
+
+#endif // BENCH_CPU_INFO_H
@@ -0,0 +1,75 @@
+#include "curves.h"
+
+#include <strings.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+
+#include "keys.h"
+
+namespace bench {
+
+const std::vector<CurveInfo>& nistCurves() {
+    static const std::vector<CurveInfo> curves = {
+        {"P256", "EC", EVP_PKEY_EC, NID_X9_62_prime256v1, "NIST P-256 (secp256r1, prime256v1) - 256-bit"},
+        {"P384", "EC", EVP_PKEY_EC, NID_secp384r1, "NIST P-384 (secp384r1) - 384-bit"},
+        {"P521", "EC", EVP_PKEY_EC, NID_secp521r1, "NIST P-521 (secp521r1) - 521-bit"},
+    };
+    return curves;
+}
+
+const std::vector<CurveInfo>& signatureCurves() {
+    static const std::vector<CurveInfo> curves = [] {
+        std::vector<CurveInfo> all = nistCurves();
+        all.push_back({"Ed25519", "ED25519", EVP_PKEY_ED25519, NID_undef, "Edwards25519 EdDSA (RFC 8032) - 255-bit"});
+        all.push_back({"Ed448", "ED448", EVP_PKEY_ED448, NID_undef, "Edwards448 EdDSA (RFC 8032) - 448-bit"});
+        return all;
+    }();
+    return curves;
+}
+
+const std::vector<CurveInfo>& agreementCurves() {
+    static const std::vector<CurveInfo> curves = [] {
+        std::vector<CurveInfo> all = nistCurves();
+        all.push_back({"X25519", "X25519", EVP_PKEY_X25519, NID_undef, "Curve25519 (RFC 7748) - 255-bit"});
+        all.push_back({"X448", "X448", EVP_PKEY_X448, NID_undef, "Curve448 (RFC 7748) - 448-bit"});
+        return all;
+    }();
+    return curves;
+}
+
+const CurveInfo* findCurve(const std::vector<CurveInfo>& curves, const std::string& name) {
+    for (const auto& curve : curves) {
+        if (strcasecmp(name.c_str(), curve.name) == 0) {
+            return &curve;
+        }
+    }
+    return nullptr;
+}
+
+EVP_PKEY_CTX* newCurveKeygenContext(const CurveInfo& curve, OSSL_LIB_CTX* libctx) {
+    EVP_PKEY_CTX* pctx = newKeyContext(curve.key_type, curve.pkey_id, libctx);
+    if (!pctx) {
+        return nullptr;
+    }
+    if (EVP_PKEY_keygen_init(pctx) <= 0 ||
+        (curve.nid != NID_undef && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, curve.nid) <= 0)) {
+        EVP_PKEY_CTX_free(pctx);
+        return nullptr;
+    }
+    return pctx;
+}
+
+EVP_PKEY* generateCurveKey(const CurveInfo& curve, OSSL_LIB_CTX* libctx) {
+    EVP_PKEY_CTX* pctx = newCurveKeygenContext(curve, libctx);
+    if (!pctx) {
+        return nullptr;
+    }
+    EVP_PKEY* pkey = nullptr;
+    if (EVP_PKEY_keygen(pctx, &pkey) <= 0) {
+        pkey = nullptr;
+    }
+    EVP_PKEY_CTX_free(pctx);
+    return pkey;
+}
+
+} // namespace bench
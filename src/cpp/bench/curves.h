@@ -0,0 +1,46 @@
+#ifndef BENCH_CURVES_H
+#define BENCH_CURVES_H
+
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+namespace bench {
+
+// A curve as the EC tools name it on the command line.
+struct CurveInfo {
+    const char* name;        // e.g. "P256", "X25519"
+    const char* key_type;    // OpenSSL key type: "EC", "X25519", "ED25519", ...
+    int pkey_id;             // the matching EVP_PKEY_* id
+    int nid;                 // curve NID for "EC" keys, NID_undef otherwise
+    const char* description; // for --curves listings
+};
+
+// The NIST prime curves: P256, P384, P521.
+const std::vector<CurveInfo>& nistCurves();
+
+// Curves usable for signatures: the NIST curves (ECDSA) plus Ed25519 and
+// Ed448 (EdDSA).
+const std::vector<CurveInfo>& signatureCurves();
+
+// EdDSA keys sign with the one-shot API and no separate digest.
+inline bool isEdDSA(const CurveInfo& curve) {
+    return curve.pkey_id == EVP_PKEY_ED25519 || curve.pkey_id == EVP_PKEY_ED448;
+}
+
+// Curves usable for key agreement: the NIST curves plus X25519 and X448.
+const std::vector<CurveInfo>& agreementCurves();
+
+// `name` in `curves`, or nullptr. Names match case-insensitively.
+const CurveInfo* findCurve(const std::vector<CurveInfo>& curves, const std::string& name);
+
+// A key generation context for `curve`, ready for EVP_PKEY_keygen, in the
+// default library context or `libctx`. Returns nullptr on failure.
+EVP_PKEY_CTX* newCurveKeygenContext(const CurveInfo& curve, OSSL_LIB_CTX* libctx = nullptr);
+
+// Generate one key on `curve`, or nullptr on failure.
+EVP_PKEY* generateCurveKey(const CurveInfo& curve, OSSL_LIB_CTX* libctx = nullptr);
+
+} // namespace bench
+
+#endif // BENCH_CURVES_H
@@ -0,0 +1,174 @@
+#include "engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+#include "report.h"
+
+namespace bench {
+
+namespace {
+
+const uint64_t kCalibrationIterations = 200000;
+
+// Time-bounded runs sample throughput in windows of 1/20th of the run,
+// clamped to [0.1s, 1s]. Steady state is declared once the last five
+// windows have a coefficient of variation of 2% or less; without
+// --duration a steady-state run gives up after five minutes.
+const double kMinWindowSeconds = 0.1;
+const double kMaxWindowSeconds = 1.0;
+const size_t kSteadyWindows = 5;
+const double kSteadyTolerance = 0.02;
+const double kSteadyStateLimitSeconds = 300.0;
+
+Clock::duration toDuration(double seconds) {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+bool windowsSettled(const std::vector<double>& windows) {
+    if (windows.size() < kSteadyWindows) {
+        return false;
+    }
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (size_t i = windows.size() - kSteadyWindows; i < windows.size(); i++) {
+        sum += windows[i];
+        sum_sq += windows[i] * windows[i];
+    }
+    double mean = sum / kSteadyWindows;
+    double variance = std::max(0.0, sum_sq / kSteadyWindows - mean * mean);
+    return mean > 0.0 && std::sqrt(variance) / mean <= kSteadyTolerance;
+}
+
+} // namespace
+
+bool parseSchedule(const std::string& name, Schedule& schedule) {
+    if (name == "static") {
+        schedule = Schedule::Static;
+        return true;
+    }
+    if (name == "dynamic") {
+        schedule = Schedule::Dynamic;
+        return true;
+    }
+    return false;
+}
+
+const char* scheduleName(Schedule schedule) {
+    return schedule == Schedule::Dynamic ? "dynamic (shared work counter)" : "static (fixed loops per thread)";
+}
+
+HarnessOverhead measureHarnessOverhead(StatsMode mode) {
+    LatencyRecorder recorder(1, mode);
+    NullOperation op;
+    ThreadResult ignored;
+
+    // One short pass to fault in the histogram and settle the timer path
+    detail::WorkQueue warmup(Schedule::Static, kCalibrationIterations / 10, 1);
+    detail::timedLoop(op, recorder, 0, warmup, ignored);
+
+    LatencyRecorder measured(1, mode);
+    detail::WorkQueue work(Schedule::Static, kCalibrationIterations, 1);
+    Clock::time_point start = Clock::now();
+    detail::timedLoop(op, measured, 0, work, ignored);
+    Clock::time_point end = Clock::now();
+
+    LatencyHistogram hist;
+    measured.snapshot(hist);
+
+    HarnessOverhead overhead;
+    overhead.loop_ns_per_iteration = static_cast<double>(elapsedNs(start, end)) / kCalibrationIterations;
+    overhead.timer_floor_ns = hist.valueAtPercentile(50.0);
+    return overhead;
+}
+
+namespace detail {
+
+void controlTimedRun(const RunConfig& config, LatencyRecorder& recorder, WorkQueue& work,
+                     const std::atomic<int>& running, Clock::time_point start, RunResult& result) {
+    double limit = config.duration_seconds > 0.0 ? config.duration_seconds : kSteadyStateLimitSeconds;
+    double window = std::min(kMaxWindowSeconds, std::max(kMinWindowSeconds, limit / 20.0));
+    result.window_seconds = window;
+
+    Clock::time_point deadline = start + toDuration(limit);
+    Clock::time_point window_start = start;
+    uint64_t window_base = 0;
+    LatencyHistogram snapshot;
+    while (running.load() > 0) {
+        Clock::time_point window_end = std::min(deadline, window_start + toDuration(window));
+        // Nap in short slices so a run whose workers all fail ends promptly
+        while (running.load() > 0 && Clock::now() < window_end) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(window_end - Clock::now(),
+                                                                  std::chrono::milliseconds(10)));
+        }
+        Clock::time_point now = Clock::now();
+        recorder.snapshot(snapshot);
+        uint64_t count = snapshot.count();
+        double seconds = elapsedSeconds(window_start, now);
+        // A short final window before the deadline would only add noise
+        if (seconds >= 0.99 * window) {
+            result.window_throughput.push_back(static_cast<double>(count - window_base) / seconds);
+        }
+        if (config.steady_state && windowsSettled(result.window_throughput)) {
+            result.steady_state_reached = true;
+            break;
+        }
+        if (now >= deadline) {
+            break;
+        }
+        window_start = now;
+        window_base = count;
+    }
+    work.stop();
+}
+
+struct LiveStatsPrinter::State {
+    const RunConfig& config;
+    LatencyRecorder& recorder;
+    Clock::time_point start;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    std::thread thread;
+
+    State(const RunConfig& c, LatencyRecorder& r, Clock::time_point s) : config(c), recorder(r), start(s) {}
+};
+
+LiveStatsPrinter::LiveStatsPrinter(const RunConfig& config, LatencyRecorder& recorder, Clock::time_point start)
+    : state_(new State(config, recorder, start)) {
+    if (!config.live_stats) {
+        return;
+    }
+    State* state = state_.get();
+    state->thread = std::thread([state]() {
+        LatencyHistogram snapshot;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (!state->done) {
+            state->recorder.snapshot(snapshot);
+            printStatsLine(std::cout, state->config, snapshot, elapsedSeconds(state->start, Clock::now()));
+            state->wake.wait_for(lock, std::chrono::milliseconds(1000));
+        }
+    });
+}
+
+LiveStatsPrinter::~LiveStatsPrinter() {
+    stop();
+}
+
+void LiveStatsPrinter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->done = true;
+    }
+    state_->wake.notify_all();
+    if (state_->thread.joinable()) {
+        state_->thread.join();
+    }
+}
+
+} // namespace detail
+
+} // namespace bench
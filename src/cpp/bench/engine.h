@@ -0,0 +1,436 @@
+#ifndef BENCH_ENGINE_H
+#define BENCH_ENGINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_jobs.h"
+#include "latency_histogram.h"
+#include "latency_recorder.h"
+#include "library_context.h"
+#include "open_loop.h"
+#include "seeded_random.h"
+#include "topology.h"
+
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+inline uint64_t elapsedNs(Clock::time_point start, Clock::time_point end) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+inline double elapsedSeconds(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+enum class Schedule {
+    Static, // every worker performs exactly loops_per_thread operations
+    Dynamic // workers claim operations from a shared counter until the total is reached
+};
+
+bool parseSchedule(const std::string& name, Schedule& schedule);
+const char* scheduleName(Schedule schedule);
+
+// Settings shared by every benchmark tool.
+struct RunConfig {
+    int num_threads = 1;
+    uint64_t loops_per_thread = 1;
+    Schedule schedule = Schedule::Static;
+    bool schedule_given = false; // --schedule on the command line, not a tool default
+    StatsMode stats_mode = StatsMode::Sharded;
+    // Labels for the live statistics line, e.g. "Keys" and "keys/s"
+    const char* unit_label = "Ops";
+    const char* rate_label = "ops/s";
+    bool live_stats = true;
+    bool per_thread_report = false;
+    bool sweep = false;          // --sweep: run at every scalingSteps() count up to num_threads
+    std::string sweep_output;    // --sweep-out: CSV or JSON file for the sweep results
+    LibCtxMode libctx_mode = LibCtxMode::Shared;
+    bool compare_libctx = false; // --libctx compare: tools run shared and isolated side by side
+    Placement placement = Placement::None; // --pin: how workers are pinned to CPUs
+    double duration_seconds = 0.0; // --duration: measure for this long instead of loops_per_thread
+    double warmup_seconds = 0.0;   // --warmup: unrecorded operations per worker before measuring
+    bool steady_state = false;     // --steady-state: stop once windowed throughput settles
+    std::string results_output;    // --output: JSON or CSV file each measured run is appended to
+    bool seeded = false;           // --seed: deterministic, INSECURE randomness (see seeded_random.h)
+    uint64_t seed = 0;
+    int async_jobs = 0;            // --async K: each worker round-robins K ASYNC_JOBs (0 = call directly)
+    bool async_sweep = false;      // --async-sweep: compare direct calls with 1, 2, 4, ... K jobs
+    double target_rate = 0.0;      // --rate: open loop at this many ops/s in total (0 = closed loop)
+    Arrivals arrivals = Arrivals::Fixed;
+    bool rate_sweep = false;       // --rate-sweep: latency against offered rate, up to saturation
+
+    // Runs until a deadline (or steady state) rather than for a fixed count.
+    bool timeBounded() const { return duration_seconds > 0.0 || steady_state; }
+
+    // Operations start on an arrival schedule (see open_loop.h).
+    bool openLoop() const { return target_rate > 0.0; }
+};
+
+struct ThreadResult {
+    uint64_t operations = 0;
+    uint64_t failures = 0;
+    bool setup_failed = false;
+    uint64_t busy_ns = 0;          // time spent inside timed operations
+    double finish_seconds = 0.0;   // when this worker ran out of work, relative to the run start
+    int cpu = -1;                  // CPU the worker last ran on
+    bool pin_failed = false;       // the placement's CPU set was rejected
+    double offered_rate = 0.0;     // open loop: the rate this worker's arrivals came at
+    double achieved_rate = 0.0;    // open loop: the rate it completed them at, from its first arrival
+};
+
+// Cost of the measurement loop itself, taken by running an empty operation
+// through exactly the same code path as the real one.
+struct HarnessOverhead {
+    double loop_ns_per_iteration = 0.0; // wall time per empty iteration
+    uint64_t timer_floor_ns = 0;        // median latency recorded for an empty op
+};
+
+struct RunResult {
+    RunResult() : latency(new LatencyHistogram()) {}
+
+    uint64_t operations = 0;
+    uint64_t failures = 0;
+    double elapsed_seconds = 0.0;
+    std::unique_ptr<LatencyHistogram> latency; // open loop: from intended start, queueing included
+    std::unique_ptr<LatencyHistogram> service; // open loop only: time inside the operation
+    std::vector<ThreadResult> threads;
+    HarnessOverhead overhead;
+    double setup_seconds = 0.0;           // thread start, operation setup and warmup, before measuring
+    double window_seconds = 0.0;          // time-bounded runs: length of each throughput window
+    std::vector<double> window_throughput; // time-bounded runs: throughput of each complete window
+    bool steady_state_reached = false;
+
+    double throughput() const {
+        return elapsed_seconds > 0.0 ? static_cast<double>(operations) / elapsed_seconds : 0.0;
+    }
+
+    // Open loop: the total rate operations were offered at, and the rate
+    // they were completed at, which falls short once the run saturates.
+    // Both are summed over the workers, each measured over its own
+    // schedule, so the random length of a Poisson schedule cancels out.
+    double offeredRate() const {
+        double rate = 0.0;
+        for (const auto& t : threads) {
+            rate += t.offered_rate;
+        }
+        return rate;
+    }
+
+    double achievedRate() const {
+        double rate = 0.0;
+        for (const auto& t : threads) {
+            rate += t.achieved_rate;
+        }
+        return rate;
+    }
+};
+
+// Base for benchmark operations.
+//
+// A tool's factory creates one operation per worker thread, on that thread,
+// so it can own its keys and contexts. The engine then calls prepare()
+// (untimed, e.g. to refill an input buffer) followed by operator()() (timed)
+// once per iteration; operator()() returns false on failure, which stops
+// that worker. Operations are used through their concrete type, so the call
+// is resolved at compile time and inlined into the loop.
+struct Operation {
+    void prepare() {}
+};
+
+struct NullOperation : Operation {
+    bool operator()() { return true; }
+};
+
+namespace detail {
+
+// Hands out iterations to workers. With a static schedule each worker counts
+// its own quota; with a dynamic one they race on a shared counter so fast
+// workers pick up the slack of slow ones (RSA keygen time varies several-fold
+// with the prime search) and nobody idles at the end while work remains.
+class WorkQueue {
+public:
+    WorkQueue(Schedule schedule, uint64_t per_thread, int num_threads)
+        : schedule_(schedule), per_thread_(per_thread), total_(per_thread * num_threads), stopped_(false),
+          next_(0) {}
+
+    // Hand out no more work; used to end time-bounded runs.
+    void stop() { stopped_.store(true, std::memory_order_relaxed); }
+
+    bool claim(uint64_t done_by_caller) {
+        if (stopped_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (schedule_ == Schedule::Static) {
+            return done_by_caller < per_thread_;
+        }
+        return next_.fetch_add(1, std::memory_order_relaxed) < total_;
+    }
+
+private:
+    Schedule schedule_;
+    uint64_t per_thread_;
+    uint64_t total_;
+    std::atomic<bool> stopped_; // written once, so it can share the read-only line
+    // Keep the contended counter off the cache line holding the read-only fields
+    char pad_[64];
+    std::atomic<uint64_t> next_;
+};
+
+// Counters are kept in locals and only written to `result` at the end, as
+// neighbouring workers' ThreadResults share cache lines.
+template <typename Op>
+void timedLoop(Op& op, LatencyRecorder& recorder, int thread_index, WorkQueue& work, ThreadResult& result) {
+    uint64_t operations = 0;
+    uint64_t failures = 0;
+    uint64_t busy_ns = 0;
+    while (work.claim(operations)) {
+        op.prepare();
+        Clock::time_point start = Clock::now();
+        bool ok = op();
+        Clock::time_point end = Clock::now();
+        uint64_t ns = elapsedNs(start, end);
+        busy_ns += ns;
+        if (!ok) {
+            failures++;
+            break;
+        }
+        recorder.record(thread_index, ns);
+        operations++;
+    }
+    result.operations += operations;
+    result.failures += failures;
+    result.busy_ns += busy_ns;
+}
+
+// timedLoop() for open-loop runs: each operation waits for its intended
+// start time, `recorder` gets the time from that intended start to the end
+// of the operation and `service` the time inside it.
+template <typename Op>
+void openLoopTimedLoop(Op& op, LatencyRecorder& recorder, LatencyRecorder& service, int thread_index,
+                       WorkQueue& work, ArrivalSchedule& schedule, ThreadResult& result) {
+    uint64_t operations = 0;
+    uint64_t failures = 0;
+    uint64_t busy_ns = 0;
+    while (work.claim(operations)) {
+        Clock::time_point intended = schedule.next();
+        op.prepare();
+        waitUntil(intended);
+        Clock::time_point start = Clock::now();
+        bool ok = op();
+        Clock::time_point end = Clock::now();
+        uint64_t ns = elapsedNs(start, end);
+        busy_ns += ns;
+        if (!ok) {
+            failures++;
+            break;
+        }
+        recorder.record(thread_index, elapsedNs(intended, end));
+        service.record(thread_index, ns);
+        operations++;
+    }
+    result.operations += operations;
+    result.failures += failures;
+    result.busy_ns += busy_ns;
+}
+
+// Untimed, unrecorded iterations until `seconds` have passed, to fault in
+// buffers and let caches, branch predictors and clock frequency settle.
+// Returns false if an operation failed.
+template <typename Op>
+bool warmupLoop(Op& op, double seconds) {
+    Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                               std::chrono::duration<double>(seconds));
+    while (Clock::now() < end) {
+        op.prepare();
+        if (!op()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Holds every worker back until all of them have set up and warmed up, so
+// the measured run starts at one instant with every thread hot.
+class StartGate {
+public:
+    explicit StartGate(int workers) : waiting_(workers), open_(false) {}
+
+    // Called by each worker; returns the measured start time.
+    Clock::time_point arriveAndWait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (--waiting_ == 0) {
+            all_arrived_.notify_one();
+        }
+        opened_.wait(lock, [this]() { return open_; });
+        return start_;
+    }
+
+    // Called by the coordinator: waits for every worker, then starts the clock.
+    Clock::time_point open() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        all_arrived_.wait(lock, [this]() { return waiting_ == 0; });
+        start_ = Clock::now();
+        open_ = true;
+        opened_.notify_all();
+        return start_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable all_arrived_;
+    std::condition_variable opened_;
+    int waiting_;
+    bool open_;
+    Clock::time_point start_;
+};
+
+// Sleeps through a time-bounded run, sampling throughput once per window,
+// and stops `work` at the deadline or, with steady_state, once the last few
+// windows agree. Returns early when no worker is left running.
+void controlTimedRun(const RunConfig& config, LatencyRecorder& recorder, WorkQueue& work,
+                     const std::atomic<int>& running, Clock::time_point start, RunResult& result);
+
+// Prints the live statistics line once a second until stopped.
+class LiveStatsPrinter {
+public:
+    LiveStatsPrinter(const RunConfig& config, LatencyRecorder& recorder, Clock::time_point start);
+    ~LiveStatsPrinter();
+    void stop();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+} // namespace detail
+
+HarnessOverhead measureHarnessOverhead(StatsMode mode);
+
+namespace detail {
+
+// run() for one operation type.
+template <typename OpFactory>
+RunResult runWorkers(const RunConfig& config, OpFactory make_op) {
+    typedef typename decltype(make_op(0))::element_type Op;
+
+    RunResult result;
+    result.overhead = measureHarnessOverhead(config.stats_mode);
+    result.threads.resize(config.num_threads);
+
+    LatencyRecorder recorder(config.num_threads, config.stats_mode);
+    LatencyRecorder service(config.openLoop() ? config.num_threads : 0, config.stats_mode);
+    uint64_t loops = config.timeBounded() ? std::numeric_limits<uint64_t>::max() / config.num_threads
+                                          : config.loops_per_thread;
+    detail::WorkQueue work(config.schedule, loops, config.num_threads);
+    std::vector<std::vector<int>> plan = placeWorkers(cpuTopology(), config.placement, config.num_threads);
+    detail::StartGate gate(config.num_threads);
+    std::atomic<int> running(config.num_threads);
+    Clock::time_point spawn = Clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < config.num_threads; i++) {
+        threads.emplace_back([&config, &make_op, &recorder, &service, &work, &result, &plan, &gate, &running, i]() {
+            ThreadResult& mine = result.threads[i];
+            if (!plan.empty()) {
+                mine.pin_failed = !pinCurrentThread(plan[i]);
+            }
+            std::unique_ptr<LibraryContext> libctx;
+            if (config.libctx_mode == LibCtxMode::Isolated) {
+                libctx.reset(new LibraryContext());
+            }
+            detail::ScopedThreadLibraryContext scope(libctx.get());
+            seedThreadRandom(i);
+            std::unique_ptr<Op> op;
+            if (!libctx || libctx->valid()) {
+                op = make_op(i);
+            }
+            if (!op) {
+                mine.setup_failed = true;
+            } else if (config.warmup_seconds > 0.0 && !detail::warmupLoop(*op, config.warmup_seconds)) {
+                mine.failures++;
+            }
+            Clock::time_point start = gate.arriveAndWait();
+            if (op && mine.failures == 0 && config.openLoop()) {
+                ArrivalSchedule schedule(config.target_rate, config.arrivals, config.num_threads, i, config.seed,
+                                         start);
+                detail::openLoopTimedLoop(*op, recorder, service, i, work, schedule, mine);
+                double completed_seconds = elapsedSeconds(schedule.first(), Clock::now());
+                mine.offered_rate = schedule.offeredRate(mine.operations + mine.failures);
+                mine.achieved_rate = completed_seconds > 0.0 ? mine.operations / completed_seconds : 0.0;
+            } else if (op && mine.failures == 0) {
+                detail::timedLoop(*op, recorder, i, work, mine);
+            }
+            mine.finish_seconds = elapsedSeconds(start, Clock::now());
+            running.fetch_sub(1);
+            op.reset();
+            mine.cpu = currentCpu();
+        });
+    }
+
+    Clock::time_point start = gate.open();
+    result.setup_seconds = elapsedSeconds(spawn, start);
+    detail::LiveStatsPrinter printer(config, recorder, start);
+    if (config.timeBounded()) {
+        detail::controlTimedRun(config, recorder, work, running, start, result);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    printer.stop();
+
+    // The run ends when the last worker leaves its timed loop; teardown of
+    // keys and contexts is not part of it
+    recorder.snapshot(*result.latency);
+    if (config.openLoop()) {
+        result.service.reset(new LatencyHistogram());
+        service.snapshot(*result.service);
+    }
+    for (const auto& t : result.threads) {
+        result.operations += t.operations;
+        result.failures += t.failures;
+        result.elapsed_seconds = std::max(result.elapsed_seconds, t.finish_seconds);
+    }
+    return result;
+}
+
+} // namespace detail
+
+// Run `config.num_threads` workers, each performing `config.loops_per_thread`
+// timed operations, or as many as fit in a time-bounded run.
+// `make_op(thread_index)` is called on the worker thread and must return a
+// std::unique_ptr to an Operation subclass, or nullptr if setup failed; it
+// is called concurrently and must be safe to do so. With an
+// isolated libctx_mode each worker's private context is created first and
+// is available to the factory through threadLibraryContext(); it outlives
+// the operation. With a placement the worker pins itself before doing
+// anything else, so its keys and contexts are allocated on the CPU (and
+// NUMA node) that will use them. Measurement starts only once every worker
+// has built its operation and finished any warmup. With config.async_jobs
+// set, each worker builds that many operations and drives them through
+// ASYNC_JOBs, one resume per timed iteration (see AsyncJobsOperation).
+// With config.target_rate set the run is open loop: operations start on an
+// arrival schedule and latency is measured from the intended start time.
+template <typename OpFactory>
+RunResult run(const RunConfig& config, OpFactory make_op) {
+    if (config.async_jobs > 0) {
+        return detail::runWorkers(config, [&config, &make_op](int thread_index) {
+            return detail::makeAsyncJobs(config.async_jobs, make_op, thread_index);
+        });
+    }
+    return detail::runWorkers(config, make_op);
+}
+
+} // namespace bench
+
+#endif // BENCH_ENGINE_H
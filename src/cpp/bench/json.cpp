@@ -0,0 +1,263 @@
+#include "json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace bench {
+
+std::string jsonString(const std::string& value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        switch (c) {
+        case '"':
+        case '\\':
+            escaped += '\\';
+            escaped += c;
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                escaped += buf;
+            } else {
+                escaped += c;
+            }
+            break;
+        }
+    }
+    return escaped + "\"";
+}
+
+std::string jsonNumber(double value) {
+    if (std::isnan(value) || std::isinf(value)) {
+        return "null";
+    }
+    std::ostringstream out;
+    out << std::setprecision(10) << value;
+    return out.str();
+}
+
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const {
+    static const JsonValue null_value;
+    auto it = members_.find(key);
+    return it == members_.end() ? null_value : it->second;
+}
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+    bool document(JsonValue& value, std::string& error) {
+        if (!parseValue(value, 0)) {
+            error = error_ + " at offset " + std::to_string(pos_);
+            return false;
+        }
+        skipSpace();
+        if (pos_ != text_.size()) {
+            error = "trailing characters at offset " + std::to_string(pos_);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static const int kMaxDepth = 64;
+
+    void skipSpace() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool fail(const char* message) {
+        error_ = message;
+        return false;
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::char_traits<char>::length(word);
+        if (text_.compare(pos_, n, word) != 0) {
+            return fail("invalid literal");
+        }
+        pos_ += n;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        pos_++; // opening quote
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= text_.size()) {
+                break;
+            }
+            char e = text_[pos_++];
+            switch (e) {
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'u': {
+                // The tools only escape control characters this way
+                if (pos_ + 4 > text_.size()) {
+                    return fail("truncated \\u escape");
+                }
+                unsigned long code = std::strtoul(text_.substr(pos_, 4).c_str(), nullptr, 16);
+                out += code < 0x80 ? static_cast<char>(code) : '?';
+                pos_ += 4;
+                break;
+            }
+            default:
+                out += e;
+                break;
+            }
+        }
+        return fail("unterminated string");
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        if (depth > kMaxDepth) {
+            return fail("nesting too deep");
+        }
+        skipSpace();
+        if (pos_ >= text_.size()) {
+            return fail("unexpected end of input");
+        }
+        char c = text_[pos_];
+        if (c == '{') {
+            value.type_ = JsonValue::Object;
+            pos_++;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                pos_++;
+                return true;
+            }
+            for (;;) {
+                skipSpace();
+                if (pos_ >= text_.size() || text_[pos_] != '"') {
+                    return fail("expected member name");
+                }
+                std::string key;
+                if (!parseString(key)) {
+                    return false;
+                }
+                skipSpace();
+                if (pos_ >= text_.size() || text_[pos_] != ':') {
+                    return fail("expected ':'");
+                }
+                pos_++;
+                if (!parseValue(value.members_[key], depth + 1)) {
+                    return false;
+                }
+                skipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    pos_++;
+                } else if (pos_ < text_.size() && text_[pos_] == '}') {
+                    pos_++;
+                    return true;
+                } else {
+                    return fail("expected ',' or '}'");
+                }
+            }
+        }
+        if (c == '[') {
+            value.type_ = JsonValue::Array;
+            pos_++;
+            skipSpace();
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                pos_++;
+                return true;
+            }
+            for (;;) {
+                value.items_.push_back(JsonValue());
+                if (!parseValue(value.items_.back(), depth + 1)) {
+                    return false;
+                }
+                skipSpace();
+                if (pos_ < text_.size() && text_[pos_] == ',') {
+                    pos_++;
+                } else if (pos_ < text_.size() && text_[pos_] == ']') {
+                    pos_++;
+                    return true;
+                } else {
+                    return fail("expected ',' or ']'");
+                }
+            }
+        }
+        if (c == '"') {
+            value.type_ = JsonValue::String;
+            return parseString(value.string_);
+        }
+        if (c == 't' || c == 'f') {
+            value.type_ = JsonValue::Bool;
+            value.number_ = c == 't' ? 1.0 : 0.0;
+            return literal(c == 't' ? "true" : "false");
+        }
+        if (c == 'n') {
+            value.type_ = JsonValue::Null;
+            return literal("null");
+        }
+        const char* start = text_.c_str() + pos_;
+        char* end = nullptr;
+        value.number_ = std::strtod(start, &end);
+        if (end == start) {
+            return fail("unexpected character");
+        }
+        value.type_ = JsonValue::Number;
+        pos_ += static_cast<size_t>(end - start);
+        return true;
+    }
+
+    const std::string& text_;
+    size_t pos_;
+    std::string error_;
+};
+
+bool JsonValue::parse(const std::string& text, JsonValue& value, std::string& error) {
+    value = JsonValue();
+    JsonParser parser(text);
+    return parser.document(value, error);
+}
+
+} // namespace bench
@@ -0,0 +1,57 @@
+#ifndef BENCH_JSON_H
+#define BENCH_JSON_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Quoted, escaped JSON string.
+std::string jsonString(const std::string& value);
+
+// Number with enough digits to round-trip; NaN and infinity become null.
+std::string jsonNumber(double value);
+
+// CSV field, quoted only if it contains a comma, quote or newline.
+std::string csvField(const std::string& value);
+
+// Just enough of a JSON document model to read back the files the tools
+// write: objects, arrays, strings, numbers, booleans and null.
+class JsonValue {
+public:
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    JsonValue() : type_(Null), number_(0.0) {}
+
+    Type type() const { return type_; }
+    bool isObject() const { return type_ == Object; }
+    bool isArray() const { return type_ == Array; }
+
+    double number(double fallback = 0.0) const { return type_ == Number ? number_ : fallback; }
+    const std::string& string() const { return string_; }
+    bool boolean() const { return type_ == Bool && number_ != 0.0; }
+
+    const std::vector<JsonValue>& items() const { return items_; }
+    const std::map<std::string, JsonValue>& members() const { return members_; }
+
+    // Member `key` of an object, or a shared null value if absent.
+    const JsonValue& operator[](const std::string& key) const;
+
+    // Parse a complete document; on failure returns false with `error` set.
+    static bool parse(const std::string& text, JsonValue& value, std::string& error);
+
+private:
+    friend class JsonParser;
+
+    Type type_;
+    double number_;
+    std::string string_;
+    std::vector<JsonValue> items_;
+    std::map<std::string, JsonValue> members_;
+};
+
+} // namespace bench
+
+#endif // BENCH_JSON_H
@@ -0,0 +1,270 @@
+#include "key_working_set.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <malloc.h>
+
+#include "cpu_info.h"
+#include "options.h"
+#include "report.h"
+
+namespace bench {
+
+namespace {
+
+// Bytes the allocator has handed out and not had back
+uint64_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<uint64_t>(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// log1p(x) / x and expm1(x) / x, with their Taylor series near 0
+double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+} // namespace
+
+bool parseKeyAccess(const std::string& name, KeyAccess& access, double& zipf_exponent) {
+    if (name == "uniform") {
+        access = KeyAccess::Uniform;
+    } else if (name == "sequential") {
+        access = KeyAccess::Sequential;
+    } else if (name == "zipf") {
+        access = KeyAccess::Zipf;
+        zipf_exponent = 1.0;
+    } else if (name.compare(0, 5, "zipf:") == 0) {
+        char* end = nullptr;
+        double s = std::strtod(name.c_str() + 5, &end);
+        if (*end != '\0' || !(s > 0.0) || s > 10.0) {
+            return false;
+        }
+        access = KeyAccess::Zipf;
+        zipf_exponent = s;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* keyAccessName(KeyAccess access) {
+    switch (access) {
+    case KeyAccess::Uniform:
+        return "uniform";
+    case KeyAccess::Zipf:
+        return "zipf";
+    case KeyAccess::Sequential:
+        return "sequential";
+    }
+    return "unknown";
+}
+
+KeyWorkingSet::~KeyWorkingSet() {
+    for (EVP_PKEY* key : keys_) {
+        EVP_PKEY_free(key);
+    }
+}
+
+bool KeyWorkingSet::build(const CurveInfo& curve, size_t count, bool verify, const SignatureParams& params,
+                          size_t message_size, std::string& error) {
+    uint64_t heap_before = heapInUse();
+    keys_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        EVP_PKEY* key = generateCurveKey(curve);
+        if (!key) {
+            error = "failed to generate key " + std::to_string(i);
+            return false;
+        }
+        keys_.push_back(key);
+    }
+
+    if (verify) {
+        EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+        if (!md_ctx) {
+            error = "failed to create a digest context";
+            return false;
+        }
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<unsigned int> dis(0, 255);
+        signed_.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            SignatureCorpus::Entry& entry = signed_[i];
+            entry.message.resize(message_size);
+            for (auto& byte : entry.message) {
+                byte = static_cast<unsigned char>(dis(gen));
+            }
+            entry.signature.resize(EVP_PKEY_get_size(keys_[i]));
+            size_t signature_len = entry.signature.size();
+            // OpenSSL 3.0 keeps the previous key's EVP_PKEY_CTX when a context
+            // is re-initialised for another key
+            EVP_MD_CTX_reset(md_ctx);
+            if (!digestSign(md_ctx, keys_[i], params, entry.message.data(), entry.message.size(),
+                            entry.signature.data(), &signature_len)) {
+                EVP_MD_CTX_free(md_ctx);
+                error = "failed to sign a message with key " + std::to_string(i);
+                return false;
+            }
+            entry.signature.resize(signature_len);
+            entry.signature.shrink_to_fit();
+        }
+        EVP_MD_CTX_free(md_ctx);
+    }
+
+    uint64_t heap_after = heapInUse();
+    heap_bytes_ = heap_after > heap_before ? heap_after - heap_before : 0;
+    return true;
+}
+
+KeyPicker::KeyPicker(size_t keys, KeyAccess access, double zipf_exponent, int worker, int workers, uint64_t seed)
+    : keys_(std::max<size_t>(keys, 1)), access_(access), s_(zipf_exponent),
+      position_(keys_ * static_cast<size_t>(worker) / static_cast<size_t>(std::max(workers, 1))), stride_(1),
+      gen_(seed * 1000003 + static_cast<uint64_t>(worker)), unit_(0.0, 1.0), h_integral_x1_(0.0),
+      h_integral_n_(0.0), s_div_(0.0) {
+    if (keys_ > 1) {
+        stride_ = 0x9E3779B97F4A7C15ULL % keys_;
+        while (stride_ == 0 || gcd(stride_, keys_) != 1) {
+            stride_ = (stride_ + 1) % keys_;
+        }
+    }
+    if (access_ == KeyAccess::Zipf) {
+        h_integral_x1_ = hIntegral(1.5) - 1.0;
+        h_integral_n_ = hIntegral(static_cast<double>(keys_) + 0.5);
+        s_div_ = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    }
+}
+
+size_t KeyPicker::next() {
+    switch (access_) {
+    case KeyAccess::Uniform:
+        return static_cast<size_t>(gen_() % keys_);
+    case KeyAccess::Sequential: {
+        size_t key = position_;
+        if (++position_ == keys_) {
+            position_ = 0;
+        }
+        return key;
+    }
+    case KeyAccess::Zipf:
+        return static_cast<size_t>(((zipfRank() - 1) * stride_) % keys_);
+    }
+    return 0;
+}
+
+double KeyPicker::hIntegral(double x) const {
+    double log_x = std::log(x);
+    return helper2((1.0 - s_) * log_x) * log_x;
+}
+
+double KeyPicker::h(double x) const {
+    return std::exp(-s_ * std::log(x));
+}
+
+double KeyPicker::hIntegralInverse(double x) const {
+    double t = std::max(x * (1.0 - s_), -1.0);
+    return std::exp(helper1(t) * x);
+}
+
+size_t KeyPicker::zipfRank() {
+    for (;;) {
+        double u = h_integral_n_ + unit_(gen_) * (h_integral_x1_ - h_integral_n_);
+        double x = hIntegralInverse(u);
+        double k = std::floor(x + 0.5);
+        k = std::min(std::max(k, 1.0), static_cast<double>(keys_));
+        if (k - x <= s_div_ || u >= hIntegral(k + 0.5) - h(k)) {
+            return static_cast<size_t>(k);
+        }
+    }
+}
+
+WorkingSetOperation::WorkingSetOperation(const KeyWorkingSet& keys, const SignatureParams& params, bool verify,
+                                         size_t message_size, const KeyPicker& picker)
+    : keys_(keys), params_(params), verify_(verify), picker_(picker), current_(0), md_ctx_(EVP_MD_CTX_new()),
+      message_(message_size), gen_(std::random_device{}()), dis_(0, 255) {
+    size_t signature_size = 0;
+    if (!verify_ && keys_.size() > 0) {
+        signature_size = static_cast<size_t>(EVP_PKEY_get_size(keys_.key(0)));
+    }
+    signature_.resize(signature_size);
+}
+
+WorkingSetOperation::~WorkingSetOperation() {
+    EVP_MD_CTX_free(md_ctx_);
+}
+
+std::vector<size_t> workingSetSteps(size_t max_keys) {
+    std::vector<size_t> steps;
+    for (size_t keys = 1; keys < max_keys; keys *= 4) {
+        steps.push_back(keys);
+    }
+    steps.push_back(max_keys);
+    return steps;
+}
+
+void printWorkingSetTable(std::ostream& out, const RunConfig& config, const std::vector<WorkingSetPoint>& points) {
+    std::vector<CacheLevel> caches = dataCacheLevels();
+    out << std::endl;
+    out << std::setw(9) << "Keys" << std::setw(12) << "footprint" << std::setw(9) << "fits in" << std::setw(14)
+        << config.rate_label << std::setw(8) << "rel" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+        << std::endl;
+    double base = points.empty() ? 0.0 : points[0].throughput;
+    for (const auto& p : points) {
+        std::string fits = "-";
+        if (p.footprint_bytes > 0) {
+            fits = caches.empty() ? "?" : "DRAM";
+            for (const auto& cache : caches) {
+                if (p.footprint_bytes <= cache.size_bytes) {
+                    fits = "L" + std::to_string(cache.level);
+                    break;
+                }
+            }
+        }
+        out << std::setw(9) << p.keys << std::setw(12)
+            << (p.footprint_bytes > 0 ? approximateBytes(static_cast<double>(p.footprint_bytes)) : std::string("?"))
+            << std::setw(9) << fits << std::fixed << std::setprecision(1) << std::setw(14) << p.throughput
+            << std::setprecision(2) << std::setw(8) << (base > 0.0 ? p.throughput / base : 0.0)
+            << std::setprecision(4) << std::setw(10) << nsToMs(p.p50_ns) << std::setw(10) << nsToMs(p.p99_ns);
+        if (p.failures > 0) {
+            out << "  (" << p.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "footprint: heap held by the keys";
+    if (!points.empty() && points.back().footprint_bytes > 0) {
+        out << " (" << std::fixed << std::setprecision(0)
+            << static_cast<double>(points.back().footprint_bytes) / static_cast<double>(points.back().keys)
+            << " bytes each)";
+    }
+    out << " and messages in use, against CPU 0's caches";
+    if (!caches.empty()) {
+        out << " (";
+        for (size_t i = 0; i < caches.size(); i++) {
+            out << (i ? ", " : "") << "L" << caches[i].level << " "
+                << approximateBytes(static_cast<double>(caches[i].size_bytes));
+        }
+        out << ")";
+    }
+    out << "." << std::endl;
+    out << "rel: throughput relative to the first row. L3 is shared by every core, L1 and L2 usually are not."
+        << std::endl;
+}
+
+} // namespace bench
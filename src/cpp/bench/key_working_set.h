@@ -0,0 +1,165 @@
+#ifndef BENCH_KEY_WORKING_SET_H
+#define BENCH_KEY_WORKING_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "curves.h"
+#include "engine.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+// Signing with many keys (--keys): a multi-tenant signer holds one key per
+// tenant and moves between them on every request, so key material,
+// precomputation and the contexts built from them come from further down
+// the cache hierarchy than in a single-key benchmark, where everything
+// stays in L1/L2.
+
+// Which key each operation uses.
+enum class KeyAccess {
+    Uniform,   // any key with equal probability
+    Zipf,      // key of rank k with probability proportional to 1/k^s: a few hot tenants, a long tail
+    Sequential // each worker walks the keys in order, so every key is as cold as possible when reused
+};
+
+// "uniform", "sequential", "zipf" (s = 1) or "zipf:S" with S > 0.
+bool parseKeyAccess(const std::string& name, KeyAccess& access, double& zipf_exponent);
+const char* keyAccessName(KeyAccess access);
+
+// The shared keys, and for verification one signed message per key, made
+// once before the run. Workers use the keys directly rather than copies,
+// as the threads of a signing service would, so the working set is the
+// same whatever the thread count.
+class KeyWorkingSet {
+public:
+    KeyWorkingSet() : heap_bytes_(0) {}
+    ~KeyWorkingSet();
+
+    KeyWorkingSet(const KeyWorkingSet&) = delete;
+    KeyWorkingSet& operator=(const KeyWorkingSet&) = delete;
+
+    // Generate `count` keys on `curve`, signing one message each when
+    // `verify`.
+    bool build(const CurveInfo& curve, size_t count, bool verify, const SignatureParams& params, size_t message_size,
+               std::string& error);
+
+    size_t size() const { return keys_.size(); }
+    EVP_PKEY* key(size_t i) const { return keys_[i]; }
+    const SignatureCorpus::Entry& signedMessage(size_t i) const { return signed_[i]; }
+
+    // Heap the keys and messages occupy, measured as the allocator's growth
+    // while building them; 0 where the allocator can't report it.
+    uint64_t heapBytes() const { return heap_bytes_; }
+
+private:
+    std::vector<EVP_PKEY*> keys_;
+    std::vector<SignatureCorpus::Entry> signed_;
+    uint64_t heap_bytes_;
+};
+
+// A worker's sequence of key indices over the first `keys` keys of a set.
+// Zipf ranks are drawn by rejection-inversion (Hörmann and Derflinger),
+// which needs no table, so the sampler adds nothing to the working set; a
+// fixed permutation then scatters the ranks over the set so the hot keys
+// are not neighbours in memory.
+class KeyPicker {
+public:
+    KeyPicker(size_t keys, KeyAccess access, double zipf_exponent, int worker, int workers, uint64_t seed);
+
+    size_t next();
+
+private:
+    double hIntegral(double x) const;
+    double h(double x) const;
+    double hIntegralInverse(double x) const;
+    size_t zipfRank();
+
+    size_t keys_;
+    KeyAccess access_;
+    double s_;
+    size_t position_; // sequential
+    uint64_t stride_; // rank-to-index permutation: rank * stride mod keys, stride coprime to keys
+    std::mt19937_64 gen_;
+    std::uniform_real_distribution<double> unit_;
+    double h_integral_x1_;
+    double h_integral_n_;
+    double s_div_;
+};
+
+// Signs or verifies with the key the picker chooses for each operation.
+// Every operation starts from a reset context, so a run with one key pays
+// the same setup as one with a million and the difference between them is
+// where the key's data had to come from.
+class WorkingSetOperation : public Operation {
+public:
+    WorkingSetOperation(const KeyWorkingSet& keys, const SignatureParams& params, bool verify, size_t message_size,
+                        const KeyPicker& picker);
+    ~WorkingSetOperation();
+
+    WorkingSetOperation(const WorkingSetOperation&) = delete;
+    WorkingSetOperation& operator=(const WorkingSetOperation&) = delete;
+
+    bool valid() const { return md_ctx_ != nullptr; }
+
+    void prepare() {
+        current_ = picker_.next();
+        if (!verify_) {
+            for (auto& byte : message_) {
+                byte = static_cast<unsigned char>(dis_(gen_));
+            }
+        }
+    }
+
+    bool operator()() {
+        EVP_MD_CTX_reset(md_ctx_);
+        EVP_PKEY* key = keys_.key(current_);
+        if (verify_) {
+            const SignatureCorpus::Entry& entry = keys_.signedMessage(current_);
+            return digestVerify(md_ctx_, key, params_, entry.message.data(), entry.message.size(),
+                                entry.signature.data(), entry.signature.size());
+        }
+        size_t signature_len = signature_.size();
+        return digestSign(md_ctx_, key, params_, message_.data(), message_.size(), signature_.data(),
+                          &signature_len);
+    }
+
+private:
+    const KeyWorkingSet& keys_;
+    SignatureParams params_;
+    bool verify_;
+    KeyPicker picker_;
+    size_t current_;
+    EVP_MD_CTX* md_ctx_;
+    std::vector<unsigned char> message_;
+    std::vector<unsigned char> signature_;
+    std::mt19937 gen_;
+    std::uniform_int_distribution<unsigned int> dis_;
+};
+
+// Working-set sizes for --keys-sweep: 1, 4, 16, ... and `max_keys`.
+std::vector<size_t> workingSetSteps(size_t max_keys);
+
+// One row of the --keys-sweep table.
+struct WorkingSetPoint {
+    size_t keys = 0;
+    uint64_t footprint_bytes = 0; // share of the measured heap; 0 if unknown
+    double throughput = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+};
+
+// Throughput and latency against working-set size, each row marked with
+// the smallest cache its footprint fits in and its throughput relative to
+// the first row.
+void printWorkingSetTable(std::ostream& out, const RunConfig& config, const std::vector<WorkingSetPoint>& points);
+
+} // namespace bench
+
+#endif // BENCH_KEY_WORKING_SET_H
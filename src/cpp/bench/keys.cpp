@@ -0,0 +1,59 @@
+#include "keys.h"
+
+#include <openssl/ec.h>
+#include <openssl/rsa.h>
+
+namespace bench {
+
+EVP_PKEY_CTX* newKeyContext(const char* name, int legacy_id, OSSL_LIB_CTX* libctx) {
+    if (libctx) {
+        return EVP_PKEY_CTX_new_from_name(libctx, name, nullptr);
+    }
+    return EVP_PKEY_CTX_new_id(legacy_id, nullptr);
+}
+
+EVP_PKEY* generateECKey(int curve_nid, OSSL_LIB_CTX* libctx) {
+    EVP_PKEY_CTX* pctx = newKeyContext("EC", EVP_PKEY_EC, libctx);
+    if (!pctx) {
+        return nullptr;
+    }
+
+    EVP_PKEY* pkey = nullptr;
+    if (EVP_PKEY_keygen_init(pctx) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, curve_nid) <= 0 ||
+        EVP_PKEY_keygen(pctx, &pkey) <= 0) {
+        pkey = nullptr;
+    }
+
+    EVP_PKEY_CTX_free(pctx);
+    return pkey;
+}
+
+EVP_PKEY_CTX* newRSAKeygenContext(int bits, OSSL_LIB_CTX* libctx) {
+    EVP_PKEY_CTX* pctx = newKeyContext("RSA", EVP_PKEY_RSA, libctx);
+    if (pctx && (EVP_PKEY_keygen_init(pctx) <= 0 || EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, bits) <= 0)) {
+        EVP_PKEY_CTX_free(pctx);
+        pctx = nullptr;
+    }
+    return pctx;
+}
+
+EVP_PKEY* generateRSAKey(int bits, OSSL_LIB_CTX* libctx, int primes) {
+    EVP_PKEY_CTX* pctx = newKeyContext("RSA", EVP_PKEY_RSA, libctx);
+    if (!pctx) {
+        return nullptr;
+    }
+
+    EVP_PKEY* pkey = nullptr;
+    if (EVP_PKEY_keygen_init(pctx) <= 0 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, bits) <= 0 ||
+        (primes != 2 && EVP_PKEY_CTX_set_rsa_keygen_primes(pctx, primes) <= 0) ||
+        EVP_PKEY_keygen(pctx, &pkey) <= 0) {
+        pkey = nullptr;
+    }
+
+    EVP_PKEY_CTX_free(pctx);
+    return pkey;
+}
+
+} // namespace bench
@@ -0,0 +1,26 @@
+#ifndef BENCH_KEYS_H
+#define BENCH_KEYS_H
+
+#include <openssl/evp.h>
+
+namespace bench {
+
+// A key context for the named algorithm: EVP_PKEY_CTX_new_id(legacy_id) in
+// the default library context, or EVP_PKEY_CTX_new_from_name in `libctx`.
+EVP_PKEY_CTX* newKeyContext(const char* name, int legacy_id, OSSL_LIB_CTX* libctx);
+
+// Generate one EC key on the curve with the given NID, or nullptr on failure.
+EVP_PKEY* generateECKey(int curve_nid, OSSL_LIB_CTX* libctx = nullptr);
+
+// An RSA key generation context for `bits`-bit keys, ready for
+// EVP_PKEY_keygen, or nullptr on failure.
+EVP_PKEY_CTX* newRSAKeygenContext(int bits, OSSL_LIB_CTX* libctx = nullptr);
+
+// Generate one RSA key of the given modulus size and number of primes
+// (2 for standard RSA, up to maxRSAPrimes(bits) for multi-prime), or
+// nullptr on failure.
+EVP_PKEY* generateRSAKey(int bits, OSSL_LIB_CTX* libctx = nullptr, int primes = 2);
+
+} // namespace bench
+
+#endif // BENCH_KEYS_H
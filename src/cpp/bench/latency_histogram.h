@@ -0,0 +1,168 @@
+#ifndef BENCH_LATENCY_HISTOGRAM_H
+#define BENCH_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace bench {
+
+// Log-linear latency histogram in the spirit of HdrHistogram.
+//
+// Values are recorded in nanoseconds. Values below kSubBucketCount get an
+// exact bucket each; above that every power-of-two range is split into
+// kSubBucketHalfCount linear sub-buckets, so the relative error of any
+// reported value is below 1/kSubBucketHalfCount (~0.8%).
+//
+// A histogram has exactly one writer at a time (its owning worker thread, or
+// whoever holds the lock in mutex mode). All fields are relaxed atomics so
+// the stats thread can read a live histogram without a data race; the
+// single-writer rule means record() never needs a locked read-modify-write.
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 8;
+    static const uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+    static const uint64_t kSubBucketHalfCount = kSubBucketCount / 2;
+    // Largest trackable value is 2^44 ns (~4.9 hours); larger values are clamped.
+    static const int kMaxValueBits = 44;
+    static const int kBucketCount =
+        static_cast<int>(kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalfCount);
+
+    LatencyHistogram()
+        : counts_(new std::atomic<uint64_t>[kBucketCount]()) {
+        reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    static int bucketIndex(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<int>(value);
+        }
+        if (value >= (1ULL << kMaxValueBits)) {
+            return kBucketCount - 1;
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - (kSubBucketBits - 1);
+        uint64_t mantissa = value >> shift;
+        return static_cast<int>(kSubBucketCount + (shift - 1) * kSubBucketHalfCount +
+                                (mantissa - kSubBucketHalfCount));
+    }
+
+    static uint64_t bucketLowValue(int index) {
+        if (index < static_cast<int>(kSubBucketCount)) {
+            return static_cast<uint64_t>(index);
+        }
+        uint64_t offset = static_cast<uint64_t>(index) - kSubBucketCount;
+        int shift = static_cast<int>(offset / kSubBucketHalfCount) + 1;
+        uint64_t mantissa = kSubBucketHalfCount + offset % kSubBucketHalfCount;
+        return mantissa << shift;
+    }
+
+    static uint64_t bucketHighValue(int index) {
+        if (index < static_cast<int>(kSubBucketCount)) {
+            return static_cast<uint64_t>(index);
+        }
+        int shift = static_cast<int>((static_cast<uint64_t>(index) - kSubBucketCount) / kSubBucketHalfCount) + 1;
+        return bucketLowValue(index) + (1ULL << shift) - 1;
+    }
+
+    void record(uint64_t value_ns) {
+        bump(counts_[bucketIndex(value_ns)], 1);
+        bump(total_count_, 1);
+        bump(total_sum_, value_ns);
+        if (value_ns < min_.load(std::memory_order_relaxed)) {
+            min_.store(value_ns, std::memory_order_relaxed);
+        }
+        if (value_ns > max_.load(std::memory_order_relaxed)) {
+            max_.store(value_ns, std::memory_order_relaxed);
+        }
+    }
+
+    // Add another histogram's counts into this one. The caller must be the
+    // only writer of *this; `other` may still be recording concurrently.
+    void add(const LatencyHistogram& other) {
+        uint64_t added = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+            if (c != 0) {
+                bump(counts_[i], c);
+                added += c;
+            }
+        }
+        // Derive the count from the buckets so percentiles stay consistent
+        // with the merged total even while `other` is being written to.
+        bump(total_count_, added);
+        bump(total_sum_, other.total_sum_.load(std::memory_order_relaxed));
+        uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+        uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+        if (other_min < min_.load(std::memory_order_relaxed)) {
+            min_.store(other_min, std::memory_order_relaxed);
+        }
+        if (other_max > max_.load(std::memory_order_relaxed)) {
+            max_.store(other_max, std::memory_order_relaxed);
+        }
+    }
+
+    void reset() {
+        for (int i = 0; i < kBucketCount; i++) {
+            counts_[i].store(0, std::memory_order_relaxed);
+        }
+        total_count_.store(0, std::memory_order_relaxed);
+        total_sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT64_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total_count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return total_sum_.load(std::memory_order_relaxed); }
+    uint64_t min() const { return count() == 0 ? 0 : min_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t bucketCount(int index) const { return counts_[index].load(std::memory_order_relaxed); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n == 0 ? 0.0 : static_cast<double>(sum()) / n;
+    }
+
+    // Value at the given percentile (0-100], reported as the midpoint of the
+    // bucket holding that rank and clamped to the observed min/max.
+    uint64_t valueAtPercentile(double percentile) const {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * n + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > n) rank = n;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; i++) {
+            seen += counts_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t lo = bucketLowValue(i);
+                uint64_t mid = lo + (bucketHighValue(i) - lo) / 2;
+                if (mid < min()) mid = min();
+                if (mid > max()) mid = max();
+                return mid;
+            }
+        }
+        return max();
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& field, uint64_t delta) {
+        field.store(field.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_count_;
+    std::atomic<uint64_t> total_sum_;
+    std::atomic<uint64_t> min_;
+    std::atomic<uint64_t> max_;
+};
+
+} // namespace bench
+
+#endif // BENCH_LATENCY_HISTOGRAM_H
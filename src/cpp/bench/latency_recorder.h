@@ -0,0 +1,94 @@
+#ifndef BENCH_LATENCY_RECORDER_H
+#define BENCH_LATENCY_RECORDER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace bench {
+
+enum class StatsMode {
+    Sharded, // one histogram per worker thread, merged only by readers
+    Mutex    // one shared histogram behind a mutex (the original design)
+};
+
+inline bool parseStatsMode(const std::string& name, StatsMode& mode) {
+    if (name == "sharded") {
+        mode = StatsMode::Sharded;
+        return true;
+    }
+    if (name == "mutex") {
+        mode = StatsMode::Mutex;
+        return true;
+    }
+    return false;
+}
+
+inline const char* statsModeName(StatsMode mode) {
+    return mode == StatsMode::Mutex ? "mutex" : "sharded";
+}
+
+// Collects per-operation latencies from a fixed set of worker threads.
+//
+// In sharded mode each worker owns a histogram padded out to its own cache
+// lines, so record() touches no shared state. Readers (the stats thread and
+// the final report) merge the shards into a scratch histogram. Mutex mode
+// keeps the old single-lock path so its cost can still be measured.
+class LatencyRecorder {
+public:
+    static const size_t kCacheLineSize = 64;
+
+    LatencyRecorder(int num_threads, StatsMode mode) : mode_(mode) {
+        if (mode_ == StatsMode::Sharded) {
+            for (int i = 0; i < num_threads; i++) {
+                shards_.emplace_back(new Shard());
+            }
+        }
+    }
+
+    StatsMode mode() const { return mode_; }
+
+    void record(int thread_index, uint64_t value_ns) {
+        if (mode_ == StatsMode::Sharded) {
+            shards_[thread_index]->histogram.record(value_ns);
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shared_.record(value_ns);
+        }
+    }
+
+    // Merge everything recorded so far into `out` (which is reset first).
+    void snapshot(LatencyHistogram& out) {
+        out.reset();
+        if (mode_ == StatsMode::Sharded) {
+            for (auto& shard : shards_) {
+                out.add(shard->histogram);
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            out.add(shared_);
+        }
+    }
+
+private:
+    // Padding on both sides keeps the hot count/sum/min/max fields of
+    // neighbouring shards off each other's cache lines.
+    struct Shard {
+        char pad_before[kCacheLineSize];
+        LatencyHistogram histogram;
+        char pad_after[kCacheLineSize];
+    };
+
+    StatsMode mode_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::mutex mutex_;
+    LatencyHistogram shared_;
+};
+
+} // namespace bench
+
+#endif // BENCH_LATENCY_RECORDER_H
@@ -0,0 +1,86 @@
+#include "library_context.h"
+
+#include <openssl/core.h>
+#include <openssl/params.h>
+
+namespace bench {
+
+namespace {
+
+thread_local LibraryContext* current_library_context = nullptr;
+
+} // namespace
+
+bool parseLibCtxMode(const std::string& name, LibCtxMode& mode) {
+    if (name == "shared") {
+        mode = LibCtxMode::Shared;
+    } else if (name == "isolated") {
+        mode = LibCtxMode::Isolated;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* libCtxModeName(LibCtxMode mode) {
+    return mode == LibCtxMode::Isolated ? "isolated (one OSSL_LIB_CTX per worker)" : "shared (default OSSL_LIB_CTX)";
+}
+
+LibraryContext::LibraryContext()
+    : ctx_(OSSL_LIB_CTX_new()), provider_(nullptr), sha256_(nullptr) {
+    if (ctx_) {
+        provider_ = OSSL_PROVIDER_load(ctx_, "default");
+    }
+    if (provider_) {
+        sha256_ = EVP_MD_fetch(ctx_, "SHA256", nullptr);
+    }
+}
+
+LibraryContext::~LibraryContext() {
+    EVP_MD_free(sha256_);
+    if (provider_) {
+        OSSL_PROVIDER_unload(provider_);
+    }
+    OSSL_LIB_CTX_free(ctx_);
+}
+
+LibraryContext* threadLibraryContext() {
+    return current_library_context;
+}
+
+namespace detail {
+
+ScopedThreadLibraryContext::ScopedThreadLibraryContext(LibraryContext* ctx) : previous_(current_library_context) {
+    current_library_context = ctx;
+}
+
+ScopedThreadLibraryContext::~ScopedThreadLibraryContext() {
+    current_library_context = previous_;
+}
+
+} // namespace detail
+
+EVP_PKEY* importKey(EVP_PKEY* key, OSSL_LIB_CTX* libctx) {
+    OSSL_PARAM* params = nullptr;
+    if (EVP_PKEY_todata(key, EVP_PKEY_KEYPAIR, &params) <= 0) {
+        return nullptr;
+    }
+
+    EVP_PKEY* imported = nullptr;
+    EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_from_name(libctx, EVP_PKEY_get0_type_name(key), nullptr);
+    if (!pctx || EVP_PKEY_fromdata_init(pctx) <= 0 ||
+        EVP_PKEY_fromdata(pctx, &imported, EVP_PKEY_KEYPAIR, params) <= 0) {
+        imported = nullptr;
+    }
+
+    EVP_PKEY_CTX_free(pctx);
+    OSSL_PARAM_free(params);
+    return imported;
+}
+
+EVP_PKEY* copyKeyForThread(EVP_PKEY* key) {
+    LibraryContext* libctx = threadLibraryContext();
+    return libctx ? importKey(key, libctx->get()) : EVP_PKEY_dup(key);
+}
+
+} // namespace bench
@@ -0,0 +1,77 @@
+#ifndef BENCH_LIBRARY_CONTEXT_H
+#define BENCH_LIBRARY_CONTEXT_H
+
+#include <string>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/provider.h>
+
+namespace bench {
+
+enum class LibCtxMode {
+    Shared,  // every worker uses OpenSSL's default library context
+    Isolated // every worker creates its own OSSL_LIB_CTX and loads the default provider into it
+};
+
+bool parseLibCtxMode(const std::string& name, LibCtxMode& mode);
+const char* libCtxModeName(LibCtxMode mode);
+
+// A worker's private library context. Fetches, the method store and
+// provider state are local to it, so nothing is shared with other threads
+// except what OpenSSL keeps truly global.
+class LibraryContext {
+public:
+    LibraryContext();
+    ~LibraryContext();
+
+    LibraryContext(const LibraryContext&) = delete;
+    LibraryContext& operator=(const LibraryContext&) = delete;
+
+    bool valid() const { return ctx_ != nullptr && provider_ != nullptr && sha256_ != nullptr; }
+    OSSL_LIB_CTX* get() const { return ctx_; }
+
+    // SHA-256 fetched from this context once, at construction
+    const EVP_MD* sha256() const { return sha256_; }
+
+private:
+    OSSL_LIB_CTX* ctx_;
+    OSSL_PROVIDER* provider_;
+    EVP_MD* sha256_;
+};
+
+// The calling worker's private context in isolated mode, or nullptr when
+// workers share the default context. Set by the engine around each worker's
+// factory call and timed loop, so it is valid inside an op factory.
+LibraryContext* threadLibraryContext();
+
+namespace detail {
+
+// Installs `ctx` as the calling thread's library context for its lifetime.
+class ScopedThreadLibraryContext {
+public:
+    explicit ScopedThreadLibraryContext(LibraryContext* ctx);
+    ~ScopedThreadLibraryContext();
+
+    ScopedThreadLibraryContext(const ScopedThreadLibraryContext&) = delete;
+    ScopedThreadLibraryContext& operator=(const ScopedThreadLibraryContext&) = delete;
+
+private:
+    LibraryContext* previous_;
+};
+
+} // namespace detail
+
+// Re-create `key` inside `libctx` through EVP_PKEY_todata/EVP_PKEY_fromdata.
+// EVP_PKEY_dup keeps a copy bound to the original key's context, so an
+// isolated worker needs this to sign with a key generated elsewhere.
+// Returns nullptr on failure.
+EVP_PKEY* importKey(EVP_PKEY* key, OSSL_LIB_CTX* libctx);
+
+// A worker's own copy of a shared key (so threads don't contend on one
+// reference count): imported into the worker's private context in isolated
+// mode, EVP_PKEY_dup otherwise.
+EVP_PKEY* copyKeyForThread(EVP_PKEY* key);
+
+} // namespace bench
+
+#endif // BENCH_LIBRARY_CONTEXT_H
@@ -0,0 +1,33 @@
+#ifndef BENCH_MAPPED_FILE_H
+#define BENCH_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace bench {
+
+// A whole file mapped read-only, so large inputs are hashed straight from
+// the page cache without being copied into a buffer first.
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0) {}
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map `path`; on failure returns false with `error` set. An empty file
+    // maps to a null pointer and size 0.
+    bool open(const std::string& path, std::string& error);
+
+    const unsigned char* data() const { return static_cast<const unsigned char*>(data_); }
+    size_t size() const { return size_; }
+
+private:
+    void* data_;
+    size_t size_;
+};
+
+} // namespace bench
+
+#endif // BENCH_MAPPED_FILE_H
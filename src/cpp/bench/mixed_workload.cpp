@@ -0,0 +1,599 @@
+#include "mixed_workload.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "keys.h"
+#include "library_context.h"
+#include "open_loop.h"
+#include "report.h"
+
+namespace bench {
+
+namespace {
+
+const size_t kDefaultMessageSize = 32;
+const size_t kMaxMessageSize = 1 << 20;
+const int kMaxKeyId = 1 << 20;
+
+std::string upper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return std::string();
+    }
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string stripComment(const std::string& line) {
+    size_t hash = line.find('#');
+    return hash == std::string::npos ? line : line.substr(0, hash);
+}
+
+bool parseMixOp(const std::string& name, MixOp& op) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "keygen") {
+        op = MixOp::Keygen;
+    } else if (lower == "sign") {
+        op = MixOp::Sign;
+    } else if (lower == "verify") {
+        op = MixOp::Verify;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// A whole non-negative decimal number, nothing else.
+bool parseCount(const std::string& text, long long& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos || text.size() > 15) {
+        return false;
+    }
+    value = std::atoll(text.c_str());
+    return true;
+}
+
+bool parseMessageSize(const std::string& text, size_t& size) {
+    long long value = 0;
+    if (!parseCount(text, value) || value < 1 || value > static_cast<long long>(kMaxMessageSize)) {
+        return false;
+    }
+    size = static_cast<size_t>(value);
+    return true;
+}
+
+int addAlgorithm(Workload& workload, const MixAlgorithm& algorithm) {
+    for (size_t i = 0; i < workload.algorithms.size(); i++) {
+        if (workload.algorithms[i].name == algorithm.name) {
+            return static_cast<int>(i);
+        }
+    }
+    workload.algorithms.push_back(algorithm);
+    workload.keys.push_back(0);
+    return static_cast<int>(workload.algorithms.size() - 1);
+}
+
+// The class for (op, algorithm, message size), added if new. Keygen has no
+// message, so its size is always 0.
+int addClass(Workload& workload, MixOp op, int algorithm, size_t message_size) {
+    if (op == MixOp::Keygen) {
+        message_size = 0;
+    }
+    for (size_t i = 0; i < workload.classes.size(); i++) {
+        const OpClass& c = workload.classes[i];
+        if (c.op == op && c.algorithm == algorithm && c.message_size == message_size) {
+            return static_cast<int>(i);
+        }
+    }
+    OpClass c;
+    c.op = op;
+    c.algorithm = algorithm;
+    c.message_size = message_size;
+    c.label = std::string(mixOpName(op)) + " " + workload.algorithms[algorithm].name;
+    if (op != MixOp::Keygen && message_size != kDefaultMessageSize) {
+        c.label += " " + std::to_string(message_size) + "B";
+    }
+    workload.classes.push_back(c);
+    return static_cast<int>(workload.classes.size() - 1);
+}
+
+std::vector<std::string> splitOn(const std::string& text, char separator) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream in(text);
+    while (std::getline(in, field, separator)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    contents = text.str();
+    return true;
+}
+
+} // namespace
+
+const char* mixOpName(MixOp op) {
+    switch (op) {
+    case MixOp::Keygen:
+        return "keygen";
+    case MixOp::Sign:
+        return "sign";
+    case MixOp::Verify:
+        return "verify";
+    }
+    return "unknown";
+}
+
+SignatureParams MixAlgorithm::params() const {
+    if (rsa_bits > 0) {
+        return SignatureParams::rsaPSS();
+    }
+    SignatureParams params;
+    params.one_shot = isEdDSA(*curve);
+    return params;
+}
+
+bool parseMixAlgorithm(const std::string& name, MixAlgorithm& algorithm) {
+    std::string upper_name = upper(name);
+    if (upper_name.compare(0, 3, "RSA") == 0) {
+        std::string bits = upper_name.substr(upper_name.size() > 3 && upper_name[3] == '-' ? 4 : 3);
+        long long value = 0;
+        if (!parseCount(bits, value) || value < 1024 || value > 16384) {
+            return false;
+        }
+        algorithm.name = "RSA-" + std::to_string(value);
+        algorithm.curve = nullptr;
+        algorithm.rsa_bits = static_cast<int>(value);
+        return true;
+    }
+    const CurveInfo* curve = findCurve(signatureCurves(), name);
+    if (!curve) {
+        return false;
+    }
+    algorithm.name = curve->name;
+    algorithm.curve = curve;
+    algorithm.rsa_bits = 0;
+    return true;
+}
+
+bool parseMix(const std::string& spec, int keys_per_algorithm, Workload& workload, std::string& error) {
+    std::string text;
+    if (!readFile(spec, text)) {
+        text = spec;
+    }
+
+    workload = Workload();
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        for (const std::string& raw : splitOn(stripComment(line), ',')) {
+            std::string entry = trim(raw);
+            if (entry.empty()) {
+                continue;
+            }
+            std::vector<std::string> fields = splitOn(entry, ':');
+            if (fields.size() < 3 || fields.size() > 4) {
+                error = "mix entry '" + entry + "' is not op:algorithm:weight[:bytes]";
+                return false;
+            }
+            MixOp op;
+            if (!parseMixOp(trim(fields[0]), op)) {
+                error = "unknown operation '" + trim(fields[0]) + "' (keygen, sign or verify)";
+                return false;
+            }
+            MixAlgorithm algorithm;
+            if (!parseMixAlgorithm(trim(fields[1]), algorithm)) {
+                error = "unknown algorithm '" + trim(fields[1]) + "' (P256, P384, P521, Ed25519, Ed448, RSA-<bits>)";
+                return false;
+            }
+            char* end = nullptr;
+            std::string weight_text = trim(fields[2]);
+            double weight = std::strtod(weight_text.c_str(), &end);
+            if (weight_text.empty() || *end != '\0' || !(weight > 0.0)) {
+                error = "weight '" + weight_text + "' in '" + entry + "' must be a positive number";
+                return false;
+            }
+            size_t message_size = kDefaultMessageSize;
+            if (fields.size() == 4) {
+                if (op == MixOp::Keygen) {
+                    error = "'" + entry + "': keygen takes no message size";
+                    return false;
+                }
+                if (!parseMessageSize(trim(fields[3]), message_size)) {
+                    error = "message size in '" + entry + "' must be between 1 and " +
+                            std::to_string(kMaxMessageSize);
+                    return false;
+                }
+            }
+            int a = addAlgorithm(workload, algorithm);
+            workload.classes[addClass(workload, op, a, message_size)].weight += weight;
+            if (op != MixOp::Keygen) {
+                workload.keys[a] = keys_per_algorithm;
+            }
+        }
+    }
+    if (workload.classes.empty()) {
+        error = "the mix has no entries";
+        return false;
+    }
+    return true;
+}
+
+bool loadTrace(const std::string& path, Workload& workload, std::string& error) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        error = "cannot open trace file '" + path + "'";
+        return false;
+    }
+
+    workload = Workload();
+    int untimed = 0;
+    int64_t last_timestamp = -1;
+    std::string line;
+    for (int line_number = 1; std::getline(in, line); line_number++) {
+        std::string text = stripComment(line);
+        std::replace(text.begin(), text.end(), ',', ' ');
+        std::istringstream fields_in(text);
+        std::vector<std::string> fields;
+        std::string field;
+        while (fields_in >> field) {
+            fields.push_back(field);
+        }
+        if (fields.empty()) {
+            continue;
+        }
+
+        std::string where = path + ":" + std::to_string(line_number) + ": ";
+        if (fields.size() < 2 || fields.size() > 5) {
+            error = where + "expected op algorithm [key_id [message_bytes [timestamp_us]]]";
+            return false;
+        }
+        MixOp op;
+        if (!parseMixOp(fields[0], op)) {
+            error = where + "unknown operation '" + fields[0] + "'";
+            return false;
+        }
+        MixAlgorithm algorithm;
+        if (!parseMixAlgorithm(fields[1], algorithm)) {
+            error = where + "unknown algorithm '" + fields[1] + "'";
+            return false;
+        }
+        TraceEntry entry;
+        long long value = 0;
+        if (fields.size() > 2) {
+            if (!parseCount(fields[2], value) || value >= kMaxKeyId) {
+                error = where + "key id must be between 0 and " + std::to_string(kMaxKeyId - 1);
+                return false;
+            }
+            entry.key_id = static_cast<int>(value);
+        }
+        size_t message_size = kDefaultMessageSize;
+        if (fields.size() > 3 && !parseMessageSize(fields[3], message_size)) {
+            error = where + "message size must be between 1 and " + std::to_string(kMaxMessageSize);
+            return false;
+        }
+        if (fields.size() > 4) {
+            if (!parseCount(fields[4], value)) {
+                error = where + "timestamp must be a whole number of microseconds";
+                return false;
+            }
+            entry.timestamp_us = value;
+            last_timestamp = std::max<int64_t>(last_timestamp, value);
+        } else {
+            untimed++;
+        }
+
+        int a = addAlgorithm(workload, algorithm);
+        entry.op_class = addClass(workload, op, a, message_size);
+        if (op == MixOp::Keygen) {
+            entry.key_id = 0;
+        } else {
+            workload.keys[a] = std::max(workload.keys[a], entry.key_id + 1);
+        }
+        workload.trace.push_back(entry);
+    }
+    if (workload.trace.empty()) {
+        error = "trace file '" + path + "' has no operations";
+        return false;
+    }
+    if (untimed > 0 && untimed < static_cast<int>(workload.trace.size())) {
+        error = "trace file '" + path + "': either every line has a timestamp or none does";
+        return false;
+    }
+    workload.timed = untimed == 0;
+    workload.trace_span_us = last_timestamp + 1;
+    return true;
+}
+
+MixedKeys::~MixedKeys() {
+    for (auto& keys : keys_) {
+        for (EVP_PKEY* key : keys) {
+            EVP_PKEY_free(key);
+        }
+    }
+}
+
+bool MixedKeys::build(const Workload& workload, std::string& error) {
+    keys_.assign(workload.algorithms.size(), std::vector<EVP_PKEY*>());
+    for (size_t a = 0; a < workload.algorithms.size(); a++) {
+        const MixAlgorithm& algorithm = workload.algorithms[a];
+        for (int k = 0; k < workload.keys[a]; k++) {
+            EVP_PKEY* key = algorithm.rsa_bits > 0 ? generateRSAKey(algorithm.rsa_bits)
+                                                   : generateCurveKey(*algorithm.curve);
+            if (!key) {
+                error = "failed to generate a " + algorithm.name + " key";
+                return false;
+            }
+            keys_[a].push_back(key);
+        }
+    }
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<unsigned int> dis(0, 255);
+    signed_.assign(workload.classes.size(), std::vector<SignatureCorpus::Entry>());
+    for (size_t c = 0; c < workload.classes.size(); c++) {
+        const OpClass& op_class = workload.classes[c];
+        if (op_class.op != MixOp::Verify) {
+            continue;
+        }
+        EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+        if (!md_ctx) {
+            error = "failed to create a digest context";
+            return false;
+        }
+        SignatureParams params = workload.algorithms[op_class.algorithm].params();
+        bool ok = true;
+        for (EVP_PKEY* key : keys_[op_class.algorithm]) {
+            SignatureCorpus::Entry entry;
+            entry.message.resize(op_class.message_size);
+            for (auto& byte : entry.message) {
+                byte = static_cast<unsigned char>(dis(gen));
+            }
+            entry.signature.resize(EVP_PKEY_get_size(key));
+            size_t signature_len = entry.signature.size();
+            EVP_MD_CTX_reset(md_ctx);
+            if (!digestSign(md_ctx, key, params, entry.message.data(), entry.message.size(),
+                            entry.signature.data(), &signature_len)) {
+                ok = false;
+                break;
+            }
+            entry.signature.resize(signature_len);
+            signed_[c].push_back(entry);
+        }
+        EVP_MD_CTX_free(md_ctx);
+        if (!ok) {
+            error = "failed to sign a message for " + op_class.label;
+            return false;
+        }
+    }
+    return true;
+}
+
+MixedLatency::MixedLatency(int workers, int classes) : classes_(classes), started_(false) {
+    for (int i = 0; i < workers * classes; i++) {
+        histograms_.emplace_back(new LatencyHistogram());
+    }
+}
+
+void MixedLatency::merge(int op_class, LatencyHistogram& out) const {
+    for (size_t i = static_cast<size_t>(op_class); i < histograms_.size(); i += classes_) {
+        out.add(*histograms_[i]);
+    }
+}
+
+Clock::time_point MixedLatency::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        start_ = Clock::now();
+        started_ = true;
+    }
+    return start_;
+}
+
+MixedOperation::MixedOperation(const Workload& workload, const MixedKeys& keys, int worker, int workers,
+                               double speed, uint64_t seed, MixedLatency* latency)
+    : workload_(workload), shared_keys_(keys), worker_(worker), workers_(workers), speed_(speed),
+      latency_(latency), ready_(true),
+      gen_(seed * 1000003 + static_cast<uint64_t>(worker)), byte_(0, 255),
+      trace_pos_(static_cast<size_t>(worker)), lap_(0), started_(false), op_class_(0), key_id_(0) {
+    LibraryContext* ctx = threadLibraryContext();
+    OSSL_LIB_CTX* libctx = ctx ? ctx->get() : nullptr;
+
+    size_t algorithms = workload_.algorithms.size();
+    keys_.assign(algorithms, std::vector<EVP_PKEY*>());
+    keygen_.assign(algorithms, nullptr);
+    md_ctx_.assign(algorithms, nullptr);
+    last_key_.assign(algorithms, -1);
+    size_t signature_size = 0;
+    for (size_t a = 0; a < algorithms; a++) {
+        SignatureParams params = workload_.algorithms[a].params();
+        params.libctx = libctx;
+        if (ctx && !params.one_shot) {
+            params.md = ctx->sha256();
+        }
+        params_.push_back(params);
+        md_ctx_[a] = EVP_MD_CTX_new();
+        if (!md_ctx_[a]) {
+            ready_ = false;
+            return;
+        }
+
+        for (int k = 0; k < workload_.keys[a]; k++) {
+            EVP_PKEY* key = copyKeyForThread(shared_keys_.key(static_cast<int>(a), k));
+            if (!key) {
+                ready_ = false;
+                return;
+            }
+            keys_[a].push_back(key);
+            signature_size = std::max(signature_size, static_cast<size_t>(EVP_PKEY_get_size(key)));
+        }
+    }
+
+    std::vector<double> weights;
+    for (const OpClass& op_class : workload_.classes) {
+        weights.push_back(op_class.weight);
+        if (op_class.op == MixOp::Keygen && !keygen_[op_class.algorithm]) {
+            const MixAlgorithm& algorithm = workload_.algorithms[op_class.algorithm];
+            keygen_[op_class.algorithm] = algorithm.rsa_bits > 0 ? newRSAKeygenContext(algorithm.rsa_bits, libctx)
+                                                                 : newCurveKeygenContext(*algorithm.curve, libctx);
+            if (!keygen_[op_class.algorithm]) {
+                ready_ = false;
+            }
+        }
+    }
+    if (!workload_.isTrace()) {
+        pick_class_ = std::discrete_distribution<int>(weights.begin(), weights.end());
+    }
+    signature_.resize(signature_size);
+}
+
+MixedOperation::~MixedOperation() {
+    for (auto& keys : keys_) {
+        for (EVP_PKEY* key : keys) {
+            EVP_PKEY_free(key);
+        }
+    }
+    for (EVP_PKEY_CTX* pctx : keygen_) {
+        EVP_PKEY_CTX_free(pctx);
+    }
+    for (EVP_MD_CTX* md_ctx : md_ctx_) {
+        EVP_MD_CTX_free(md_ctx);
+    }
+}
+
+void MixedOperation::prepare() {
+    if (workload_.isTrace()) {
+        const TraceEntry& entry = workload_.trace[trace_pos_];
+        op_class_ = entry.op_class;
+        key_id_ = entry.key_id;
+        if (workload_.timed) {
+            if (!started_) {
+                trace_start_ = latency_->start();
+                started_ = true;
+            }
+            // Later laps of the trace follow on from the end of the previous one
+            double offset_us = (static_cast<double>(entry.timestamp_us) +
+                                static_cast<double>(lap_) * static_cast<double>(workload_.trace_span_us)) / speed_;
+            intended_ = trace_start_ + std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double, std::micro>(offset_us));
+        }
+        trace_pos_ += static_cast<size_t>(workers_);
+        if (trace_pos_ >= workload_.trace.size()) {
+            trace_pos_ = static_cast<size_t>(worker_);
+            lap_++;
+        }
+    } else {
+        op_class_ = pick_class_(gen_);
+        int keys = workload_.keys[workload_.classes[op_class_].algorithm];
+        key_id_ = keys > 1 ? static_cast<int>(gen_() % static_cast<uint64_t>(keys)) : 0;
+    }
+
+    const OpClass& op_class = workload_.classes[op_class_];
+    if (op_class.op == MixOp::Sign) {
+        message_.resize(op_class.message_size);
+        for (auto& byte : message_) {
+            byte = static_cast<unsigned char>(byte_(gen_));
+        }
+    }
+    if (workload_.timed) {
+        waitUntil(intended_);
+    }
+}
+
+bool MixedOperation::operator()() {
+    Clock::time_point start = Clock::now();
+    bool ok = perform(workload_.classes[op_class_]);
+    Clock::time_point end = Clock::now();
+    latency_->record(worker_, op_class_, elapsedNs(workload_.timed ? intended_ : start, end));
+    return ok;
+}
+
+bool MixedOperation::perform(const OpClass& op_class) {
+    int a = op_class.algorithm;
+    if (op_class.op != MixOp::Keygen && last_key_[a] != key_id_) {
+        // Re-initialising a context for another key keeps the previous key's
+        // EVP_PKEY_CTX in OpenSSL 3.0, so start from a clean one
+        EVP_MD_CTX_reset(md_ctx_[a]);
+        last_key_[a] = key_id_;
+    }
+    switch (op_class.op) {
+    case MixOp::Keygen: {
+        EVP_PKEY* key = nullptr;
+        bool ok = EVP_PKEY_keygen(keygen_[a], &key) > 0;
+        EVP_PKEY_free(key);
+        return ok;
+    }
+    case MixOp::Sign: {
+        size_t signature_len = signature_.size();
+        return digestSign(md_ctx_[a], keys_[a][key_id_], params_[a], message_.data(), message_.size(),
+                          signature_.data(), &signature_len);
+    }
+    case MixOp::Verify: {
+        const SignatureCorpus::Entry& entry = shared_keys_.signedMessage(op_class_, key_id_);
+        return digestVerify(md_ctx_[a], keys_[a][key_id_], params_[a], entry.message.data(), entry.message.size(),
+                            entry.signature.data(), entry.signature.size());
+    }
+    }
+    return false;
+}
+
+void printMixTable(std::ostream& out, const std::vector<MixClassResult>& rows, double total_throughput,
+                   const char* latency_origin) {
+    size_t label_width = 5;
+    uint64_t total = 0;
+    bool isolated = false;
+    for (const auto& row : rows) {
+        label_width = std::max(label_width, row.label.size());
+        total += row.operations;
+        isolated = isolated || row.isolated_p50_ns > 0;
+    }
+    label_width += 2;
+
+    out << std::endl;
+    out << std::left << std::setw(label_width) << "Class" << std::right << std::setw(10) << "ops" << std::setw(8)
+        << "share" << std::setw(12) << "ops/s" << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+        << std::setw(10) << "p99 ms" << std::setw(11) << "p99.9 ms";
+    if (isolated) {
+        out << std::setw(12) << "alone p50" << std::setw(12) << "alone p99" << std::setw(10) << "p50 x";
+    }
+    out << std::endl;
+    for (const auto& row : rows) {
+        double share = total ? 100.0 * static_cast<double>(row.operations) / static_cast<double>(total) : 0.0;
+        out << std::left << std::setw(label_width) << row.label << std::right << std::setw(10) << row.operations
+            << std::fixed << std::setprecision(1) << std::setw(7) << share << "%" << std::setw(12) << row.throughput
+            << std::setprecision(4) << std::setw(10) << nsToMs(static_cast<uint64_t>(row.mean_ns)) << std::setw(10)
+            << nsToMs(row.p50_ns) << std::setw(10) << nsToMs(row.p99_ns) << std::setw(11) << nsToMs(row.p999_ns);
+        if (row.isolated_p50_ns > 0) {
+            out << std::setw(12) << nsToMs(row.isolated_p50_ns) << std::setw(12) << nsToMs(row.isolated_p99_ns)
+                << std::setprecision(2) << std::setw(10)
+                << static_cast<double>(row.p50_ns) / static_cast<double>(row.isolated_p50_ns);
+        }
+        out << std::endl;
+    }
+    out << "Total: " << total << " operations, " << std::fixed << std::setprecision(1) << total_throughput
+        << " ops/s" << std::endl;
+    out << "Latency per class " << latency_origin << "." << std::endl;
+    if (isolated) {
+        out << "alone: the class run by itself on the same threads; p50 x = mixed p50 / alone p50." << std::endl;
+    }
+}
+
+} // namespace bench
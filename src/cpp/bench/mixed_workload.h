@@ -0,0 +1,200 @@
+#ifndef BENCH_MIXED_WORKLOAD_H
+#define BENCH_MIXED_WORKLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "curves.h"
+#include "engine.h"
+#include "latency_histogram.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+// A production-like mix of keygen, sign and verify across several
+// algorithms in one run, so the algorithms share caches and branch
+// predictors the way they do in a real service. The mix is given either as
+// weights, drawn at random per operation, or as a trace replayed in order.
+
+enum class MixOp { Keygen, Sign, Verify };
+
+const char* mixOpName(MixOp op);
+
+// An algorithm as mixes and traces name it: P256, P384, P521, Ed25519,
+// Ed448 or RSA-<bits>. Signatures are ECDSA with SHA-256, EdDSA, or
+// RSA-PSS with SHA-256 as in rsa_signer.
+struct MixAlgorithm {
+    std::string name;
+    const CurveInfo* curve = nullptr; // EC and EdDSA
+    int rsa_bits = 0;                 // RSA
+
+    SignatureParams params() const;
+};
+
+bool parseMixAlgorithm(const std::string& name, MixAlgorithm& algorithm);
+
+// One kind of operation; latency is reported per class.
+struct OpClass {
+    MixOp op = MixOp::Sign;
+    int algorithm = 0;       // index into Workload::algorithms
+    size_t message_size = 0; // sign and verify
+    double weight = 0.0;     // weighted mixes
+    std::string label;       // e.g. "verify P256", "sign RSA-2048 1024B"
+};
+
+struct TraceEntry {
+    int op_class = 0;
+    int key_id = 0;
+    int64_t timestamp_us = -1; // from the start of the trace; -1 if untimed
+};
+
+struct Workload {
+    std::vector<MixAlgorithm> algorithms;
+    std::vector<int> keys;          // per algorithm: keys made up front for sign and verify
+    std::vector<OpClass> classes;
+    std::vector<TraceEntry> trace;  // empty for a weighted mix
+    bool timed = false;             // every trace entry has a timestamp
+    int64_t trace_span_us = 0;      // timed traces: one past the last timestamp
+
+    bool isTrace() const { return !trace.empty(); }
+};
+
+// A weighted mix: comma- or newline-separated op:algorithm:weight[:bytes]
+// entries, e.g. "verify:P256:85,sign:P256:12,keygen:RSA-2048:3". `spec` is
+// the text itself or the path of a file holding it; '#' starts a comment.
+// Each algorithm used for sign or verify gets `keys_per_algorithm` keys,
+// picked uniformly per operation.
+bool parseMix(const std::string& spec, int keys_per_algorithm, Workload& workload, std::string& error);
+
+// A trace file: one operation per line, fields separated by spaces or
+// commas:
+//   op algorithm [key_id [message_bytes [timestamp_us]]]
+// key_id picks one of the algorithm's keys (default 0), message_bytes
+// defaults to 32. Either every line has a timestamp or none does.
+bool loadTrace(const std::string& path, Workload& workload, std::string& error);
+
+// Keys and, for verify classes, one signed message per key, made once
+// before the run and shared read-only by the workers.
+class MixedKeys {
+public:
+    MixedKeys() = default;
+    ~MixedKeys();
+
+    MixedKeys(const MixedKeys&) = delete;
+    MixedKeys& operator=(const MixedKeys&) = delete;
+
+    bool build(const Workload& workload, std::string& error);
+
+    EVP_PKEY* key(int algorithm, int id) const { return keys_[algorithm][id]; }
+    const SignatureCorpus::Entry& signedMessage(int op_class, int key_id) const {
+        return signed_[op_class][key_id];
+    }
+
+private:
+    std::vector<std::vector<EVP_PKEY*>> keys_;                 // [algorithm][key id]
+    std::vector<std::vector<SignatureCorpus::Entry>> signed_;  // [class][key id], verify classes only
+};
+
+// Per-class latency histograms, one set per worker so each has a single
+// writer, and the time origin a timed trace is replayed against.
+class MixedLatency {
+public:
+    MixedLatency(int workers, int classes);
+
+    void record(int worker, int op_class, uint64_t ns) { histograms_[worker * classes_ + op_class]->record(ns); }
+
+    // Every worker's samples for `op_class`, merged into `out`.
+    void merge(int op_class, LatencyHistogram& out) const;
+
+    // The first caller's current time, returned to every later caller.
+    Clock::time_point start();
+
+private:
+    int classes_;
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms_;
+    std::mutex mutex_;
+    bool started_;
+    Clock::time_point start_;
+};
+
+// One worker's share of the workload. prepare() picks the next operation
+// (a weighted draw, or the next entry of this worker's slice of the trace:
+// entries worker, worker + workers, ...) and refills a sign message; for a
+// timed trace it then waits for the entry's timestamp, scaled by `speed`.
+// operator()() performs it and records its latency under its class, from
+// the intended start for timed traces.
+class MixedOperation : public Operation {
+public:
+    MixedOperation(const Workload& workload, const MixedKeys& keys, int worker, int workers, double speed,
+                   uint64_t seed, MixedLatency* latency);
+    ~MixedOperation();
+
+    MixedOperation(const MixedOperation&) = delete;
+    MixedOperation& operator=(const MixedOperation&) = delete;
+
+    bool valid() const { return ready_; }
+
+    void prepare();
+    bool operator()();
+
+private:
+    bool perform(const OpClass& op_class);
+
+    const Workload& workload_;
+    const MixedKeys& shared_keys_;
+    int worker_;
+    int workers_;
+    double speed_;
+    MixedLatency* latency_;
+    bool ready_;
+
+    std::vector<std::vector<EVP_PKEY*>> keys_; // this worker's copies, [algorithm][key id]
+    std::vector<EVP_PKEY_CTX*> keygen_;        // per algorithm, where a keygen class uses it
+    std::vector<SignatureParams> params_;      // per algorithm
+    std::vector<EVP_MD_CTX*> md_ctx_;         // per algorithm, reset whenever its key changes
+    std::vector<int> last_key_;               // the key each context was last initialised with
+    std::vector<unsigned char> message_;
+    std::vector<unsigned char> signature_;
+
+    std::mt19937_64 gen_;
+    std::discrete_distribution<int> pick_class_;
+    std::uniform_int_distribution<unsigned int> byte_;
+    size_t trace_pos_;
+    uint64_t lap_;
+    Clock::time_point trace_start_;
+    bool started_;
+
+    // The operation prepare() chose
+    int op_class_;
+    int key_id_;
+    Clock::time_point intended_;
+};
+
+// One row of the per-class report.
+struct MixClassResult {
+    std::string label;
+    uint64_t operations = 0;
+    double throughput = 0.0;      // this class's completions per second of the mixed run
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t isolated_p50_ns = 0; // --isolated: the class run on its own; 0 if not measured
+    uint64_t isolated_p99_ns = 0;
+};
+
+// Operations, share, rate and latency per class, with the isolated run and
+// the mixed/isolated ratio at the median where measured.
+void printMixTable(std::ostream& out, const std::vector<MixClassResult>& rows, double total_throughput,
+                   const char* latency_origin);
+
+} // namespace bench
+
+#endif // BENCH_MIXED_WORKLOAD_H
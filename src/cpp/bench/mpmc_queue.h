@@ -0,0 +1,106 @@
+#ifndef BENCH_MPMC_QUEUE_H
+#define BENCH_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace bench {
+
+// Bounded lock-free multi-producer/multi-consumer ring (Dmitry Vyukov's
+// design). Every cell carries a sequence number that tells producers and
+// consumers whether it is free for the lap they are on, so a push or pop is
+// one CAS on the shared position plus one release store on the cell.
+//
+// The capacity is exact rather than rounded to a power of two, because in
+// pool mode the capacity *is* the pool depth being measured. It must be at
+// least 2: with one cell the sequence after a push equals the sequence
+// after a pop, so a full queue looks empty to producers. Smaller values are
+// raised to 2.
+template <typename T>
+class MPMCQueue {
+public:
+    explicit MPMCQueue(size_t capacity)
+        : capacity_(capacity < 2 ? 2 : capacity), cells_(new Cell[capacity_]), enqueue_pos_(0), dequeue_pos_(0) {
+        for (size_t i = 0; i < capacity_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    size_t capacity() const { return capacity_; }
+
+    bool tryPush(const T& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& value) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos % capacity_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate number of queued items; exact when the queue is quiescent.
+    size_t sizeApprox() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t deq = dequeue_pos_.load(std::memory_order_relaxed);
+        if (enq <= deq) {
+            return 0;
+        }
+        size_t size = enq - deq;
+        return size > capacity_ ? capacity_ : size;
+    }
+
+private:
+    static const size_t kCacheLineSize = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+    char pad0_[kCacheLineSize];
+    std::atomic<size_t> enqueue_pos_;
+    char pad1_[kCacheLineSize];
+    std::atomic<size_t> dequeue_pos_;
+    char pad2_[kCacheLineSize];
+};
+
+} // namespace bench
+
+#endif // BENCH_MPMC_QUEUE_H
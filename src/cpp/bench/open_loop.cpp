@@ -0,0 +1,21 @@
+#include "open_loop.h"
+
+namespace bench {
+
+bool parseArrivals(const std::string& name, Arrivals& arrivals) {
+    if (name == "fixed") {
+        arrivals = Arrivals::Fixed;
+        return true;
+    }
+    if (name == "poisson") {
+        arrivals = Arrivals::Poisson;
+        return true;
+    }
+    return false;
+}
+
+const char* arrivalsName(Arrivals arrivals) {
+    return arrivals == Arrivals::Poisson ? "Poisson" : "fixed";
+}
+
+} // namespace bench
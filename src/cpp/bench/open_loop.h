@@ -0,0 +1,102 @@
+#ifndef BENCH_OPEN_LOOP_H
+#define BENCH_OPEN_LOOP_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace bench {
+
+// Open-loop load (--rate): operations arrive on a schedule instead of each
+// worker starting the next one as soon as the last returns.
+//
+// A closed loop slows down with the system it measures. When one operation
+// stalls, the operations that would have arrived meanwhile are never issued,
+// so the stall is recorded once instead of once per waiting request
+// ("coordinated omission"). In open-loop mode every operation has an
+// intended start time, and its latency is measured from that time. A worker
+// that falls behind starts late and the delay counts against every
+// operation that queued up behind the stall, as it would for a client of a
+// signing service.
+enum class Arrivals {
+    Fixed,  // evenly spaced
+    Poisson // exponentially distributed gaps with the same mean
+};
+
+bool parseArrivals(const std::string& name, Arrivals& arrivals);
+const char* arrivalsName(Arrivals arrivals);
+
+// The intended start times of one worker's operations. Each of `workers`
+// workers takes an equal share of `total_rate`; with fixed arrivals the
+// workers are staggered so that together they issue evenly spaced
+// operations. Poisson gaps come from a generator seeded with `seed` and the
+// worker's index, so the same arrival pattern is offered on every run.
+class ArrivalSchedule {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ArrivalSchedule(double total_rate, Arrivals arrivals, int workers, int worker, uint64_t seed,
+                    Clock::time_point start)
+        : arrivals_(arrivals), mean_gap_ns_(1e9 * workers / total_rate), start_(start), offset_ns_(0.0),
+          random_(seed * 1000003 + static_cast<uint64_t>(worker)), gap_(1.0) {
+        if (arrivals_ == Arrivals::Fixed) {
+            offset_ns_ = 1e9 * worker / total_rate;
+        } else {
+            offset_ns_ = mean_gap_ns_ * gap_(random_);
+        }
+        first_ns_ = offset_ns_;
+    }
+
+    // Intended start of the next operation.
+    Clock::time_point next() {
+        Clock::time_point intended =
+            start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(
+                         static_cast<int64_t>(std::llround(offset_ns_))));
+        offset_ns_ += arrivals_ == Arrivals::Fixed ? mean_gap_ns_ : mean_gap_ns_ * gap_(random_);
+        return intended;
+    }
+
+    // Intended start of the first operation.
+    Clock::time_point first() const {
+        return start_ + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::nanoseconds(static_cast<int64_t>(std::llround(first_ns_))));
+    }
+
+    // The rate actually offered by the `issued` operations handed out so
+    // far: with Poisson arrivals a short run can differ noticeably from the
+    // mean. Measured up to the arrival that would have come next, so a
+    // worker's gaps are counted once each.
+    double offeredRate(uint64_t issued) const {
+        return offset_ns_ > first_ns_ ? 1e9 * static_cast<double>(issued) / (offset_ns_ - first_ns_) : 0.0;
+    }
+
+private:
+    Arrivals arrivals_;
+    double mean_gap_ns_;
+    Clock::time_point start_;
+    double offset_ns_; // kept as a running sum so rounding does not drift the rate
+    double first_ns_;
+    std::mt19937_64 random_;
+    std::exponential_distribution<double> gap_;
+};
+
+// Wait until `when`: sleep while it is far off, then yield until it
+// arrives, so a worker ahead of schedule starts within a few microseconds
+// of its intended time without holding a CPU other workers need.
+inline void waitUntil(std::chrono::steady_clock::time_point when) {
+    const std::chrono::microseconds kSpin(200);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (when - now > kSpin) {
+        std::this_thread::sleep_until(when - kSpin);
+    }
+    while (std::chrono::steady_clock::now() < when) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace bench
+
+#endif // BENCH_OPEN_LOOP_H
@@ -0,0 +1,22 @@
+#include "openssl_util.h"
+
+#include <iostream>
+#include <openssl/err.h>
+
+namespace bench {
+
+std::string lastOpenSSLError() {
+    unsigned long err = ERR_get_error();
+    if (err == 0) {
+        return "unknown error";
+    }
+    char err_buf[256];
+    ERR_error_string_n(err, err_buf, sizeof(err_buf));
+    return err_buf;
+}
+
+void reportOpenSSLError(const std::string& what) {
+    std::cerr << what << ". OpenSSL error: " << lastOpenSSLError() << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,17 @@
+#ifndef BENCH_OPENSSL_UTIL_H
+#define BENCH_OPENSSL_UTIL_H
+
+#include <string>
+
+namespace bench {
+
+// Pop the oldest error from this thread's OpenSSL error queue as a
+// human-readable string ("unknown error" if the queue is empty).
+std::string lastOpenSSLError();
+
+// Print "<what>. OpenSSL error: <error>" to stderr.
+void reportOpenSSLError(const std::string& what);
+
+} // namespace bench
+
+#endif // BENCH_OPENSSL_UTIL_H
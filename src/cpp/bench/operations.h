@@ -0,0 +1,42 @@
+#ifndef BENCH_OPERATIONS_H
+#define BENCH_OPERATIONS_H
+
+#include <string>
+#include <openssl/evp.h>
+
+#include "engine.h"
+#include "openssl_util.h"
+
+namespace bench {
+
+// Generates (and immediately frees) one key per call from a keygen context
+// that the operation owns and reuses for the whole run.
+class KeygenOperation : public Operation {
+public:
+    KeygenOperation(EVP_PKEY_CTX* ctx, const std::string& label) : ctx_(ctx), label_(label) {}
+
+    ~KeygenOperation() {
+        EVP_PKEY_CTX_free(ctx_);
+    }
+
+    KeygenOperation(const KeygenOperation&) = delete;
+    KeygenOperation& operator=(const KeygenOperation&) = delete;
+
+    bool operator()() {
+        EVP_PKEY* pkey = nullptr;
+        if (EVP_PKEY_keygen(ctx_, &pkey) <= 0) {
+            reportOpenSSLError(label_ + " key generation failed in thread");
+            return false;
+        }
+        EVP_PKEY_free(pkey);
+        return true;
+    }
+
+private:
+    EVP_PKEY_CTX* ctx_;
+    std::string label_;
+};
+
+} // namespace bench
+
+#endif // BENCH_OPERATIONS_H
@@ -0,0 +1,326 @@
+#include "options.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "seeded_random.h"
+
+namespace bench {
+
+static bool parseSeconds(const std::string& value, double& seconds) {
+    char* end = nullptr;
+    double parsed = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || !(parsed >= 0.0) || parsed > 86400.0) {
+        return false;
+    }
+    seconds = parsed;
+    return true;
+}
+
+bool optionValue(int argc, char* argv[], int& i, std::string& value) {
+    if (i + 1 >= argc) {
+        return false;
+    }
+    value = argv[++i];
+    return true;
+}
+
+bool parseCount(const std::string& text, uint64_t min, uint64_t max, uint64_t& count) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < min || value > max) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+bool parseByteSize(const std::string& text, size_t& bytes) {
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (text.empty() || end == text.c_str() || text[0] == '-') {
+        return false;
+    }
+    unsigned shift = 0;
+    switch (*end) {
+    case '\0':
+        break;
+    case 'k':
+    case 'K':
+        shift = 10;
+        break;
+    case 'm':
+    case 'M':
+        shift = 20;
+        break;
+    case 'g':
+    case 'G':
+        shift = 30;
+        break;
+    default:
+        return false;
+    }
+    if (*end != '\0' && end[1] != '\0') {
+        return false;
+    }
+    bytes = static_cast<size_t>(value) << shift;
+    return true;
+}
+
+bool parseByteSizeList(const std::string& text, std::vector<size_t>& sizes) {
+    sizes.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t comma = text.find(',', start);
+        std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t bytes = 0;
+        if (!parseByteSize(item, bytes)) {
+            return false;
+        }
+        sizes.push_back(bytes);
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return !sizes.empty();
+}
+
+std::string formatByteSize(size_t bytes) {
+    static const char* kSuffixes[] = {"G", "M", "K"};
+    static const unsigned kShifts[] = {30, 20, 10};
+    for (int i = 0; i < 3; i++) {
+        size_t unit = static_cast<size_t>(1) << kShifts[i];
+        if (bytes >= unit && bytes % unit == 0) {
+            return std::to_string(bytes / unit) + kSuffixes[i];
+        }
+    }
+    return std::to_string(bytes);
+}
+
+std::string approximateBytes(double bytes) {
+    static const char* kUnits[] = {"", "K", "M", "G"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 3) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(unit > 0 ? 1 : 0) << bytes << kUnits[unit];
+    return text.str();
+}
+
+// Options whose results depend on each worker having a fixed share of the
+// work. They override a tool's default schedule, but an explicit --schedule
+// dynamic is an error in either order.
+static OptionStatus requireStaticSchedule(RunConfig& config, const char* option, std::string& error) {
+    if (config.schedule_given && config.schedule == Schedule::Dynamic) {
+        error = std::string(option) + " cannot be combined with --schedule dynamic";
+        return OptionStatus::Error;
+    }
+    config.schedule = Schedule::Static;
+    return OptionStatus::Consumed;
+}
+
+OptionStatus parseCommonOption(int argc, char* argv[], int& i, RunConfig& config, std::string& error) {
+    std::string arg = argv[i];
+    std::string value;
+
+    if (arg == "--stats") {
+        if (!optionValue(argc, argv, i, value) || !parseStatsMode(value, config.stats_mode)) {
+            error = "--stats must be 'sharded' or 'mutex'";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--schedule") {
+        if (!optionValue(argc, argv, i, value) || !parseSchedule(value, config.schedule)) {
+            error = "--schedule must be 'static' or 'dynamic'";
+            return OptionStatus::Error;
+        }
+        config.schedule_given = true;
+        if (config.schedule == Schedule::Dynamic && config.seeded) {
+            error = "--seed cannot be combined with --schedule dynamic";
+            return OptionStatus::Error;
+        }
+        if (config.schedule == Schedule::Dynamic && (config.target_rate > 0.0 || config.rate_sweep)) {
+            error = "--rate and --rate-sweep cannot be combined with --schedule dynamic";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--sweep" || arg == "--scaling") {
+        config.sweep = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--sweep-out") {
+        if (!optionValue(argc, argv, i, config.sweep_output)) {
+            error = "--sweep-out needs a file name";
+            return OptionStatus::Error;
+        }
+        config.sweep = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--libctx") {
+        if (optionValue(argc, argv, i, value) && value == "compare") {
+            config.compare_libctx = true;
+            return OptionStatus::Consumed;
+        }
+        if (value.empty() || !parseLibCtxMode(value, config.libctx_mode)) {
+            error = "--libctx must be 'shared', 'isolated' or 'compare'";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--pin") {
+        if (!optionValue(argc, argv, i, value) || !parsePlacement(value, config.placement)) {
+            error = "--pin must be 'none', 'compact', 'scatter', 'physical' or 'l3'";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--duration") {
+        if (!optionValue(argc, argv, i, value) || !parseSeconds(value, config.duration_seconds) ||
+            config.duration_seconds <= 0.0) {
+            error = "--duration must be a positive number of seconds";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--warmup") {
+        if (!optionValue(argc, argv, i, value) || !parseSeconds(value, config.warmup_seconds)) {
+            error = "--warmup must be a number of seconds";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--steady-state") {
+        config.steady_state = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--output") {
+        if (!optionValue(argc, argv, i, config.results_output)) {
+            error = "--output needs a file name";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--seed") {
+        char* end = nullptr;
+        if (optionValue(argc, argv, i, value)) {
+            config.seed = std::strtoull(value.c_str(), &end, 0);
+        }
+        if (value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])) || *end != '\0') {
+            error = "--seed needs a non-negative integer";
+            return OptionStatus::Error;
+        }
+        // Installed right away: tools parse options before drawing any random
+        // bytes, and the replacement must be in place before the first one
+        if (!installSeededRandom(config.seed)) {
+            error = "OpenSSL rejected the seeded random method";
+            return OptionStatus::Error;
+        }
+        config.seeded = true;
+        // Workers repeat the same operations only if each gets a fixed share
+        return requireStaticSchedule(config, "--seed", error);
+    }
+    if (arg == "--rate") {
+        char* end = nullptr;
+        if (optionValue(argc, argv, i, value)) {
+            config.target_rate = std::strtod(value.c_str(), &end);
+        }
+        if (value.empty() || *end != '\0' || !(config.target_rate > 0.0) || config.target_rate > 1e9) {
+            error = "--rate needs a positive number of operations per second";
+            return OptionStatus::Error;
+        }
+        // Each worker follows its own share of the arrival schedule
+        return requireStaticSchedule(config, "--rate", error);
+    }
+    if (arg == "--arrivals") {
+        if (!optionValue(argc, argv, i, value) || !parseArrivals(value, config.arrivals)) {
+            error = "--arrivals must be fixed or poisson";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--rate-sweep") {
+        config.rate_sweep = true;
+        return requireStaticSchedule(config, "--rate-sweep", error);
+    }
+    if (arg == "--async") {
+        uint64_t jobs = 0;
+        if (!optionValue(argc, argv, i, value) || !parseCount(value, 1, 1024, jobs)) {
+            error = "--async must be a number of jobs between 1 and 1024";
+            return OptionStatus::Error;
+        }
+        config.async_jobs = static_cast<int>(jobs);
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--async-sweep") {
+        config.async_sweep = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--per-thread") {
+        config.per_thread_report = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--quiet" || arg == "-q") {
+        config.live_stats = false;
+        return OptionStatus::Consumed;
+    }
+    return OptionStatus::Unrecognized;
+}
+
+void printCommonOptions(std::ostream& out) {
+    out << "  --stats sharded|mutex - Latency collection: per-thread histograms (default)" << std::endl;
+    out << "                          or the original single mutex-protected accumulator" << std::endl;
+    out << "  --schedule static|dynamic - Fixed num_loops per thread, or a shared counter handing" << std::endl;
+    out << "                          out num_threads*num_loops operations to whichever thread is free" << std::endl;
+    out << "  --sweep               - Run at 1, 2, 4, ... num_threads plus the physical and logical core" << std::endl;
+    out << "                          counts; report speedup, efficiency and serial fraction" << std::endl;
+    out << "  --sweep-out FILE      - Also write the sweep as CSV (or JSON if FILE ends in .json)" << std::endl;
+    out << "  --libctx shared|isolated|compare" << std::endl;
+    out << "                        - Workers share the default OSSL_LIB_CTX (default), or each creates its" << std::endl;
+    out << "                          own and uses the _ex APIs against it; 'compare' runs both at" << std::endl;
+    out << "                          1, 2, 4, ... num_threads" << std::endl;
+    out << "  --pin none|compact|scatter|physical|l3" << std::endl;
+    out << "                        - Pin workers: fill SMT siblings first, spread one per core across" << std::endl;
+    out << "                          L3 domains first, one per physical core only, or one L3 domain" << std::endl;
+    out << "                          each; pinned runs also report throughput per CPU and per core" << std::endl;
+    out << "  --duration SECONDS    - Measure for a fixed time instead of num_loops per thread" << std::endl;
+    out << "  --warmup SECONDS      - Unrecorded operations per worker before measuring; the clock" << std::endl;
+    out << "                          starts once every worker has set up and warmed up" << std::endl;
+    out << "  --steady-state        - Stop once throughput over the last 5 windows varies by 2% or" << std::endl;
+    out << "                          less (at most --duration, or 300s)" << std::endl;
+    out << "  --output FILE         - Write every measured run (system info, settings, throughput," << std::endl;
+    out << "                          latency summary and histogram) as JSON if FILE ends in .json," << std::endl;
+    out << "                          otherwise CSV; compare two files with bench_compare" << std::endl;
+    out << "  --seed N              - INSECURE, benchmarking only: replace OpenSSL's randomness with a" << std::endl;
+    out << "                          stream per worker derived from N, so every run tries the same prime" << std::endl;
+    out << "                          candidates and nonces; implies --schedule static, so it cannot be" << std::endl;
+    out << "                          combined with --schedule dynamic" << std::endl;
+    out << "  --rate R              - Open loop: start R operations per second in total, split evenly" << std::endl;
+    out << "                          across the workers, and measure latency from each operation's" << std::endl;
+    out << "                          intended start so queueing delay is counted; implies --schedule static" << std::endl;
+    out << "                          (with --rate-sweep, cannot be combined with --schedule dynamic)" << std::endl;
+    out << "  --arrivals fixed|poisson" << std::endl;
+    out << "                        - Open-loop arrival pattern: evenly spaced (default) or Poisson" << std::endl;
+    out << "  --rate-sweep          - Open-loop latency at 10% to 110% of R (--rate), or of the measured" << std::endl;
+    out << "                          closed-loop throughput; replaces --sweep and --libctx compare" << std::endl;
+    out << "  --async K             - Each worker keeps K operations in flight as ASYNC_JOBs, resuming" << std::endl;
+    out << "                          them round-robin (ASYNC_start_job/ASYNC_pause_job)" << std::endl;
+    out << "  --async-sweep         - Compare direct calls with 1, 2, 4, ... K jobs per worker (K from" << std::endl;
+    out << "                          --async, default 16), with the fiber round-trip cost of each;" << std::endl;
+    out << "                          replaces --sweep and --libctx compare" << std::endl;
+    out << "  --per-thread          - Print operations, busy/idle time and utilisation per thread" << std::endl;
+    out << "  --quiet, -q           - Suppress the once-a-second live statistics line" << std::endl;
+}
+
+} // namespace bench
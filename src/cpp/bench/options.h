@@ -0,0 +1,46 @@
+#ifndef BENCH_OPTIONS_H
+#define BENCH_OPTIONS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+namespace bench {
+
+enum class OptionStatus {
+    Unrecognized, // not a shared option; the tool should try its own
+    Consumed,     // parsed; the index has been advanced past any value
+    Error         // recognised but invalid; see the error message
+};
+
+// Fetch the value following the option at argv[i], advancing i.
+bool optionValue(int argc, char* argv[], int& i, std::string& value);
+
+// Parse a plain decimal count between `min` and `max`; anything else in
+// `text`, such as a sign or a suffix, makes it invalid.
+bool parseCount(const std::string& text, uint64_t min, uint64_t max, uint64_t& count);
+
+// Parse a byte count with an optional binary suffix: "512", "64K", "16M", "1G".
+bool parseByteSize(const std::string& text, size_t& bytes);
+
+// Comma-separated byte counts, e.g. "1K,64K,1M".
+bool parseByteSizeList(const std::string& text, std::vector<size_t>& sizes);
+
+// The inverse for display: "64K", "1M", or plain bytes when not a round multiple.
+std::string formatByteSize(size_t bytes);
+
+// Rounded for display when the exact count doesn't matter: "2.4K", "96.0M".
+std::string approximateBytes(double bytes);
+
+// Parse argv[i] if it is one of the options every tool accepts.
+OptionStatus parseCommonOption(int argc, char* argv[], int& i, RunConfig& config, std::string& error);
+
+// Usage text for the shared options, formatted like the tools' own help.
+void printCommonOptions(std::ostream& out);
+
+} // namespace bench
+
+#endif // BENCH_OPTIONS_H
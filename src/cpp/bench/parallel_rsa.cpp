@@ -0,0 +1,215 @@
+#include "parallel_rsa.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/param_build.h>
+
+namespace bench {
+
+namespace {
+
+const unsigned long kPublicExponent = 65537;
+
+// State shared by the searchers of one key.
+struct PrimeSearch {
+    explicit PrimeSearch(int bits) : prime_bits(bits), done(false), candidates(0), found(0) {
+        primes[0] = nullptr;
+        primes[1] = nullptr;
+    }
+
+    ~PrimeSearch() {
+        BN_clear_free(primes[0]);
+        BN_clear_free(primes[1]);
+    }
+
+    int prime_bits;
+    std::atomic<bool> done;
+    std::atomic<uint64_t> candidates;
+    std::mutex lock;
+    BIGNUM* primes[2];
+    int found;
+};
+
+// BN_GENCB callback, run between candidates and Miller-Rabin rounds:
+// returning 0 makes BN_generate_prime_ex2 give up on the current search
+int keepSearching(int, int, BN_GENCB* cb) {
+    PrimeSearch* search = static_cast<PrimeSearch*>(BN_GENCB_get_arg(cb));
+    return search->done.load(std::memory_order_relaxed) ? 0 : 1;
+}
+
+// gcd(prime - 1, e) == 1, so e is invertible mod lambda(n)
+bool usablePrime(const BIGNUM* prime, const BIGNUM* e, BN_CTX* ctx) {
+    BN_CTX_start(ctx);
+    BIGNUM* minus_one = BN_CTX_get(ctx);
+    BIGNUM* gcd = BN_CTX_get(ctx);
+    bool ok = gcd && BN_sub(minus_one, prime, BN_value_one()) && BN_gcd(gcd, minus_one, e, ctx) && BN_is_one(gcd);
+    BN_CTX_end(ctx);
+    return ok;
+}
+
+// |p - q| > 2^(prime_bits - 100), as FIPS 186-4 B.3.3 asks, so the
+// modulus cannot be factored from its square root
+bool farEnoughApart(const BIGNUM* p, const BIGNUM* q, int prime_bits, BN_CTX* ctx) {
+    BN_CTX_start(ctx);
+    BIGNUM* diff = BN_CTX_get(ctx);
+    bool ok = diff && BN_sub(diff, p, q) && BN_num_bits(diff) > prime_bits - 100;
+    BN_CTX_end(ctx);
+    return ok;
+}
+
+void offerPrime(PrimeSearch& search, const BIGNUM* prime, BN_CTX* ctx) {
+    std::lock_guard<std::mutex> guard(search.lock);
+    if (search.found == 2) {
+        return;
+    }
+    if (search.found == 1 && !farEnoughApart(search.primes[0], prime, search.prime_bits, ctx)) {
+        return;
+    }
+    BIGNUM* copy = BN_secure_new();
+    if (!copy || !BN_copy(copy, prime)) {
+        BN_free(copy);
+        return;
+    }
+    search.primes[search.found++] = copy;
+    if (search.found == 2) {
+        search.done.store(true, std::memory_order_relaxed);
+    }
+}
+
+// One searcher: keep generating primes until two have been accepted
+void searchPrimes(PrimeSearch& search, OSSL_LIB_CTX* libctx) {
+    BN_CTX* ctx = BN_CTX_secure_new_ex(libctx);
+    BN_GENCB* cb = BN_GENCB_new();
+    BIGNUM* prime = BN_secure_new();
+    BIGNUM* e = BN_new();
+    if (ctx && cb && prime && e && BN_set_word(e, kPublicExponent)) {
+        BN_GENCB_set(cb, keepSearching, &search);
+        while (!search.done.load(std::memory_order_relaxed)) {
+            // Fails both on errors and when cancelled; either way this searcher is finished
+            if (!BN_generate_prime_ex2(prime, search.prime_bits, 0, nullptr, nullptr, cb, ctx)) {
+                break;
+            }
+            search.candidates.fetch_add(1, std::memory_order_relaxed);
+            if (usablePrime(prime, e, ctx)) {
+                offerPrime(search, prime, ctx);
+            }
+        }
+    }
+    BN_free(e);
+    BN_clear_free(prime);
+    BN_GENCB_free(cb);
+    BN_CTX_free(ctx);
+}
+
+// n, d = e^-1 mod lcm(p-1, q-1) and the CRT values, imported as a key pair
+EVP_PKEY* assembleKey(const BIGNUM* p, const BIGNUM* q, OSSL_LIB_CTX* libctx) {
+    // OpenSSL keeps p > q so that iqmp = q^-1 mod p
+    if (BN_cmp(p, q) < 0) {
+        const BIGNUM* larger = q;
+        q = p;
+        p = larger;
+    }
+
+    BN_CTX* ctx = BN_CTX_secure_new_ex(libctx);
+    if (!ctx) {
+        return nullptr;
+    }
+    BN_CTX_start(ctx);
+    BIGNUM* n = BN_CTX_get(ctx);
+    BIGNUM* e = BN_CTX_get(ctx);
+    BIGNUM* d = BN_CTX_get(ctx);
+    BIGNUM* p1 = BN_CTX_get(ctx);
+    BIGNUM* q1 = BN_CTX_get(ctx);
+    BIGNUM* gcd = BN_CTX_get(ctx);
+    BIGNUM* lambda = BN_CTX_get(ctx);
+    BIGNUM* dmp1 = BN_CTX_get(ctx);
+    BIGNUM* dmq1 = BN_CTX_get(ctx);
+    BIGNUM* iqmp = BN_CTX_get(ctx);
+
+    EVP_PKEY* pkey = nullptr;
+    OSSL_PARAM_BLD* bld = nullptr;
+    OSSL_PARAM* params = nullptr;
+    EVP_PKEY_CTX* pctx = nullptr;
+    bool ok = iqmp && BN_mul(n, p, q, ctx) && BN_set_word(e, kPublicExponent) &&
+              BN_sub(p1, p, BN_value_one()) && BN_sub(q1, q, BN_value_one()) && BN_gcd(gcd, p1, q1, ctx) &&
+              BN_div(lambda, nullptr, p1, gcd, ctx) && BN_mul(lambda, lambda, q1, ctx) &&
+              BN_mod_inverse(d, e, lambda, ctx) && BN_mod(dmp1, d, p1, ctx) && BN_mod(dmq1, d, q1, ctx) &&
+              BN_mod_inverse(iqmp, q, p, ctx);
+    if (ok) {
+        bld = OSSL_PARAM_BLD_new();
+        ok = bld && OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_N, n) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_E, e) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_D, d) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_FACTOR1, p) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_FACTOR2, q) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_EXPONENT1, dmp1) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_EXPONENT2, dmq1) &&
+             OSSL_PARAM_BLD_push_BN(bld, OSSL_PKEY_PARAM_RSA_COEFFICIENT1, iqmp);
+    }
+    if (ok) {
+        params = OSSL_PARAM_BLD_to_param(bld);
+        pctx = EVP_PKEY_CTX_new_from_name(libctx, "RSA", nullptr);
+        ok = params && pctx && EVP_PKEY_fromdata_init(pctx) > 0 &&
+             EVP_PKEY_fromdata(pctx, &pkey, EVP_PKEY_KEYPAIR, params) > 0;
+    }
+    if (!ok) {
+        EVP_PKEY_free(pkey);
+        pkey = nullptr;
+    }
+
+    EVP_PKEY_CTX_free(pctx);
+    OSSL_PARAM_free(params);
+    OSSL_PARAM_BLD_free(bld);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return pkey;
+}
+
+bool checkKey(EVP_PKEY* pkey, OSSL_LIB_CTX* libctx) {
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_from_pkey(libctx, pkey, nullptr);
+    bool ok = ctx && EVP_PKEY_check(ctx) == 1;
+    EVP_PKEY_CTX_free(ctx);
+    return ok;
+}
+
+} // namespace
+
+EVP_PKEY* ParallelRSAKeygen::generate(SingleKeyTimes* times) const {
+    Clock::time_point start = Clock::now();
+    PrimeSearch search(bits_ / 2);
+    std::vector<std::thread> searchers;
+    for (int i = 1; i < threads_; i++) {
+        searchers.emplace_back([this, &search]() { searchPrimes(search, libctx_); });
+    }
+    searchPrimes(search, libctx_);
+    for (auto& t : searchers) {
+        t.join();
+    }
+    Clock::time_point searched = Clock::now();
+    if (search.found < 2) {
+        return nullptr;
+    }
+
+    EVP_PKEY* pkey = assembleKey(search.primes[0], search.primes[1], libctx_);
+    Clock::time_point assembled = Clock::now();
+    if (pkey && !checkKey(pkey, libctx_)) {
+        EVP_PKEY_free(pkey);
+        pkey = nullptr;
+    }
+    Clock::time_point checked = Clock::now();
+
+    if (pkey && times) {
+        times->keys++;
+        times->search_ns += elapsedNs(start, searched);
+        times->assemble_ns += elapsedNs(searched, assembled);
+        times->check_ns += elapsedNs(assembled, checked);
+        times->candidates += search.candidates.load();
+    }
+    return pkey;
+}
+
+} // namespace bench
@@ -0,0 +1,79 @@
+#ifndef BENCH_PARALLEL_RSA_H
+#define BENCH_PARALLEL_RSA_H
+
+#include <cstdint>
+#include <openssl/evp.h>
+
+#include "engine.h"
+
+namespace bench {
+
+// Where the time of one parallel key generation went, summed over keys.
+struct SingleKeyTimes {
+    uint64_t keys = 0;
+    uint64_t search_ns = 0;   // until the second prime was accepted and the other searchers stopped
+    uint64_t assemble_ns = 0; // n, d and the CRT values, then EVP_PKEY_fromdata
+    uint64_t check_ns = 0;    // EVP_PKEY_check
+    uint64_t candidates = 0;  // primes found, including rejected ones
+
+    void add(const SingleKeyTimes& other) {
+        keys += other.keys;
+        search_ns += other.search_ns;
+        assemble_ns += other.assemble_ns;
+        check_ns += other.check_ns;
+        candidates += other.candidates;
+    }
+};
+
+// Generates one two-prime RSA key with e = 65537 using several threads for
+// the prime search, to cut the latency of a single key rather than raise
+// keys/s.
+//
+// Every searcher runs its own BN_generate_prime_ex2 from its own random
+// start. The first two acceptable primes win (gcd(p-1, e) = 1 and p, q at
+// least 2^(bits/2 - 100) apart), and the remaining searchers abandon their
+// candidates through the BN_GENCB callback. The calling thread is one of
+// the searchers, so with one thread nothing is spawned. The other searchers
+// are started per key; that costs tens of microseconds against keygen times
+// of tens of milliseconds and up.
+//
+// The key is built from its components with EVP_PKEY_fromdata and must pass
+// EVP_PKEY_check, the same validation an imported key would get.
+class ParallelRSAKeygen {
+public:
+    ParallelRSAKeygen(int bits, int threads, OSSL_LIB_CTX* libctx = nullptr)
+        : bits_(bits), threads_(threads), libctx_(libctx) {}
+
+    // A validated key, or nullptr on failure. `times`, if given, gets this
+    // key's breakdown added to it.
+    EVP_PKEY* generate(SingleKeyTimes* times = nullptr) const;
+
+private:
+    int bits_;
+    int threads_;
+    OSSL_LIB_CTX* libctx_;
+};
+
+// One parallel key generation per call; the engine measures its latency.
+class ParallelKeygenOperation : public Operation {
+public:
+    ParallelKeygenOperation(int bits, int threads, OSSL_LIB_CTX* libctx, SingleKeyTimes* times)
+        : keygen_(bits, threads, libctx), times_(times) {}
+
+    bool operator()() {
+        EVP_PKEY* pkey = keygen_.generate(times_);
+        if (!pkey) {
+            return false;
+        }
+        EVP_PKEY_free(pkey);
+        return true;
+    }
+
+private:
+    ParallelRSAKeygen keygen_;
+    SingleKeyTimes* times_;
+};
+
+} // namespace bench
+
+#endif // BENCH_PARALLEL_RSA_H
@@ -0,0 +1,64 @@
+#include "rank_test.h"
+
+#include <cmath>
+
+namespace bench {
+
+RankTestResult mannWhitneyU(const CountedSamples& baseline, const CountedSamples& candidate) {
+    RankTestResult result;
+    for (const auto& s : baseline) {
+        result.n_baseline += s.second;
+    }
+    for (const auto& s : candidate) {
+        result.n_candidate += s.second;
+    }
+    double n1 = static_cast<double>(result.n_baseline);
+    double n2 = static_cast<double>(result.n_candidate);
+    if (result.n_baseline < 2 || result.n_candidate < 2) {
+        return result;
+    }
+
+    // Walk both sorted lists together. Each candidate sample beats every
+    // baseline sample below its value and ties with those at it.
+    double u = 0.0;
+    double tie_term = 0.0; // sum of t^3 - t over groups of tied values
+    double baseline_below = 0.0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < baseline.size() || j < candidate.size()) {
+        uint64_t value;
+        if (j == candidate.size() || (i < baseline.size() && baseline[i].first < candidate[j].first)) {
+            value = baseline[i].first;
+        } else {
+            value = candidate[j].first;
+        }
+        double a = 0.0;
+        double b = 0.0;
+        while (i < baseline.size() && baseline[i].first == value) {
+            a += static_cast<double>(baseline[i++].second);
+        }
+        while (j < candidate.size() && candidate[j].first == value) {
+            b += static_cast<double>(candidate[j++].second);
+        }
+        u += b * (baseline_below + a / 2.0);
+        double t = a + b;
+        tie_term += t * t * t - t;
+        baseline_below += a;
+    }
+
+    double n = n1 + n2;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+    result.u = u;
+    result.prob_greater = u / (n1 * n2);
+    if (variance <= 0.0) {
+        return result; // every sample tied
+    }
+    double diff = u - mean;
+    double corrected = std::fabs(diff) > 0.5 ? std::fabs(diff) - 0.5 : 0.0;
+    result.z = (diff < 0.0 ? -corrected : corrected) / std::sqrt(variance);
+    result.p_value = std::erfc(std::fabs(result.z) / std::sqrt(2.0));
+    return result;
+}
+
+} // namespace bench
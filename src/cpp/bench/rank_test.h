@@ -0,0 +1,31 @@
+#ifndef BENCH_RANK_TEST_H
+#define BENCH_RANK_TEST_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Samples as (value, count) pairs sorted by value; histogram buckets are
+// exactly this, with every sample in a bucket tied at its low value.
+typedef std::vector<std::pair<uint64_t, uint64_t>> CountedSamples;
+
+struct RankTestResult {
+    uint64_t n_baseline = 0;
+    uint64_t n_candidate = 0;
+    double u = 0.0;              // Mann-Whitney U of the candidate sample
+    double z = 0.0;              // normal approximation, tie- and continuity-corrected
+    double p_value = 1.0;        // two-sided
+    double prob_greater = 0.5;   // P(candidate > baseline) + P(tie) / 2, the common-language effect size
+};
+
+// Mann-Whitney U (Wilcoxon rank-sum) test of whether the candidate's values
+// tend to be larger or smaller than the baseline's. It assumes nothing about
+// the shape of either distribution, which for latency is usually skewed and
+// multi-modal. With fewer than two samples on either side p_value stays 1.
+RankTestResult mannWhitneyU(const CountedSamples& baseline, const CountedSamples& candidate);
+
+} // namespace bench
+
+#endif // BENCH_RANK_TEST_H
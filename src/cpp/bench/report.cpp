@@ -0,0 +1,283 @@
+#include "report.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace bench {
+
+void printStatsLine(std::ostream& out, const RunConfig& config, const LatencyHistogram& hist,
+                    double elapsed_seconds) {
+    uint64_t total = hist.count();
+    double throughput = (elapsed_seconds > 0.0) ? static_cast<double>(total) / elapsed_seconds : 0.0;
+
+    out << "\r" << config.unit_label << ": " << std::setw(6) << total
+        << ", Throughput: " << std::fixed << std::setprecision(2) << std::setw(8) << throughput << " "
+        << config.rate_label
+        << ", Avg: " << std::setw(7) << hist.mean() / 1000000.0 << "ms"
+        << ", Min: " << std::setw(7) << nsToMs(hist.min()) << "ms"
+        << ", Max: " << std::setw(7) << nsToMs(hist.max()) << "ms"
+        << ", p99: " << std::setw(7) << nsToMs(hist.valueAtPercentile(99.0)) << "ms"
+        << std::flush;
+}
+
+void printRunLength(std::ostream& out, const RunConfig& config) {
+    if (config.duration_seconds > 0.0) {
+        out << "Duration: " << config.duration_seconds << "s"
+            << (config.steady_state ? ", or until throughput is steady" : "") << " (num_loops ignored)" << std::endl;
+    } else if (config.steady_state) {
+        out << "Duration: until throughput is steady, at most 300s (num_loops ignored)" << std::endl;
+    }
+    if (config.warmup_seconds > 0.0) {
+        out << "Warmup: " << config.warmup_seconds << "s per worker, not recorded" << std::endl;
+    }
+    if (config.rate_sweep) {
+        out << "Load: open-loop rate sweep, " << arrivalsName(config.arrivals)
+            << " arrivals; latency from each operation's intended start" << std::endl;
+    } else if (config.openLoop()) {
+        out << "Load: open loop at " << config.target_rate << " " << config.rate_label << ", "
+            << arrivalsName(config.arrivals) << " arrivals; latency from each operation's intended start"
+            << std::endl;
+    }
+    if (config.async_sweep) {
+        out << "Async jobs: direct, then 1 to " << (config.async_jobs > 0 ? config.async_jobs : 16)
+            << " ASYNC_JOBs per worker" << std::endl;
+    } else if (config.async_jobs > 0) {
+        out << "Async jobs: " << config.async_jobs << " ASYNC_JOBs per worker, resumed round-robin" << std::endl;
+    }
+    if (config.seeded) {
+        out << "Randomness: DETERMINISTIC from seed " << config.seed
+            << " -- INSECURE, keys and nonces are predictable; benchmarking only" << std::endl;
+        if (config.timeBounded() || config.warmup_seconds > 0.0) {
+            out << "  (with --duration, --warmup or --steady-state the operations measured still depend on timing)"
+                << std::endl;
+        }
+    }
+}
+
+void printLatencyPercentiles(std::ostream& out, const LatencyHistogram& hist, const char* label) {
+    static const double kPercentiles[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+    static const char* kLabels[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+
+    out << label << ":";
+    for (size_t i = 0; i < sizeof(kPercentiles) / sizeof(kPercentiles[0]); i++) {
+        out << (i == 0 ? " " : ", ") << kLabels[i] << ": " << std::fixed << std::setprecision(3)
+            << nsToMs(hist.valueAtPercentile(kPercentiles[i])) << "ms";
+    }
+    out << std::endl;
+}
+
+void printMeasurementWindow(std::ostream& out, const RunConfig& config, const RunResult& result) {
+    out << "Measured: " << std::fixed << std::setprecision(3) << result.elapsed_seconds << "s, starting "
+        << result.setup_seconds << "s after launch";
+    if (config.warmup_seconds > 0.0) {
+        out << " (setup plus " << config.warmup_seconds << "s warmup per worker)";
+    }
+    out << std::endl;
+    if (!config.timeBounded()) {
+        return;
+    }
+
+    const std::vector<double>& windows = result.window_throughput;
+    if (windows.empty()) {
+        out << "Throughput windows: none complete" << std::endl;
+        return;
+    }
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (double w : windows) {
+        sum += w;
+        sum_sq += w * w;
+    }
+    double mean = sum / windows.size();
+    double cv = mean > 0.0 ? std::sqrt(std::max(0.0, sum_sq / windows.size() - mean * mean)) / mean : 0.0;
+    out << "Throughput windows: " << windows.size() << " x " << std::setprecision(2) << result.window_seconds
+        << "s, min " << std::setprecision(1) << *std::min_element(windows.begin(), windows.end()) << ", max "
+        << *std::max_element(windows.begin(), windows.end()) << " " << config.rate_label << ", CV "
+        << 100.0 * cv << "%";
+    if (config.steady_state) {
+        out << (result.steady_state_reached ? "; stopped at steady state" : "; steady state not reached");
+    }
+    out << std::endl;
+}
+
+void printUtilisation(std::ostream& out, const RunConfig& config, const RunResult& result) {
+    if (result.threads.empty() || result.elapsed_seconds <= 0.0) {
+        return;
+    }
+
+    double wall = result.elapsed_seconds;
+    double total_busy = 0.0;
+    double max_tail_idle = 0.0;
+    double min_util = 1.0;
+    size_t min_util_thread = 0;
+    for (size_t i = 0; i < result.threads.size(); i++) {
+        const ThreadResult& t = result.threads[i];
+        double busy = static_cast<double>(t.busy_ns) / 1e9;
+        double util = busy / wall;
+        total_busy += busy;
+        max_tail_idle = std::max(max_tail_idle, wall - t.finish_seconds);
+        if (util < min_util) {
+            min_util = util;
+            min_util_thread = i;
+        }
+    }
+    double capacity = wall * result.threads.size();
+
+    out << "Schedule: " << scheduleName(config.schedule) << std::endl;
+    out << "Thread utilisation: " << std::fixed << std::setprecision(1) << 100.0 * total_busy / capacity
+        << "% of " << result.threads.size() << " threads x " << std::setprecision(3) << wall << "s"
+        << " (lowest " << std::setprecision(1) << 100.0 * min_util << "% on thread " << min_util_thread << ")"
+        << ", longest tail idle: " << std::setprecision(3) << max_tail_idle << "s" << std::endl;
+
+    if (!config.per_thread_report) {
+        return;
+    }
+    out << std::endl;
+    out << "Thread      Ops    Busy(s)    Idle(s)  TailIdle(s)    Util" << std::endl;
+    for (size_t i = 0; i < result.threads.size(); i++) {
+        const ThreadResult& t = result.threads[i];
+        double busy = static_cast<double>(t.busy_ns) / 1e9;
+        out << std::setw(6) << i << std::setw(9) << t.operations << std::fixed << std::setprecision(3)
+            << std::setw(11) << busy << std::setw(11) << (wall - busy) << std::setw(13) << (wall - t.finish_seconds)
+            << std::setw(7) << std::setprecision(1) << 100.0 * busy / wall << "%" << std::endl;
+    }
+}
+
+void printCpuBreakdown(std::ostream& out, const RunConfig& config, const RunResult& result) {
+    if (result.threads.empty() || result.elapsed_seconds <= 0.0) {
+        return;
+    }
+    const CpuTopology& topology = cpuTopology();
+    double wall = result.elapsed_seconds;
+
+    struct CpuRow {
+        int workers = 0;
+        uint64_t operations = 0;
+        uint64_t busy_ns = 0;
+    };
+    std::map<int, CpuRow> rows;
+    for (const auto& t : result.threads) {
+        if (t.cpu < 0) {
+            continue;
+        }
+        CpuRow& row = rows[t.cpu];
+        row.workers++;
+        row.operations += t.operations;
+        row.busy_ns += t.busy_ns;
+    }
+
+    out << std::endl;
+    out << "Placement: " << placementName(config.placement) << " on ";
+    printTopologySummary(out, topology);
+    out << std::endl;
+    if (config.placement == Placement::L3) {
+        out << "Workers float within their L3 domain; each is listed under the CPU it finished on." << std::endl;
+    }
+    out << "   CPU  Pkg  Core    L3  Workers        Ops" << std::setw(14) << config.rate_label << "    Util"
+        << std::endl;
+    for (const auto& r : rows) {
+        const LogicalCpu* cpu = topology.find(r.first);
+        out << std::setw(6) << r.first;
+        if (cpu) {
+            out << std::setw(5) << cpu->package << std::setw(6) << cpu->core << std::setw(6) << cpu->l3;
+        } else {
+            out << std::setw(5) << "-" << std::setw(6) << "-" << std::setw(6) << "-";
+        }
+        out << std::setw(9) << r.second.workers << std::setw(11) << r.second.operations << std::fixed
+            << std::setprecision(1) << std::setw(14) << r.second.operations / wall << std::setw(7)
+            << 100.0 * static_cast<double>(r.second.busy_ns) / 1e9 / wall << "%" << std::endl;
+    }
+
+    // Throughput per physical core, grouped by how many of its hardware
+    // threads had work: comparing the groups shows what SMT adds
+    std::map<std::pair<int, int>, std::pair<std::set<int>, uint64_t>> cores;
+    for (const auto& r : rows) {
+        const LogicalCpu* cpu = topology.find(r.first);
+        if (cpu) {
+            auto& core = cores[std::make_pair(cpu->package, cpu->core)];
+            core.first.insert(r.first);
+            core.second += r.second.operations;
+        }
+    }
+    std::map<size_t, std::pair<int, uint64_t>> by_siblings;
+    for (const auto& c : cores) {
+        auto& group = by_siblings[c.second.first.size()];
+        group.first++;
+        group.second += c.second.second;
+    }
+    if (by_siblings.empty()) {
+        return;
+    }
+    out << "Per physical core:";
+    double single = 0.0;
+    for (const auto& g : by_siblings) {
+        double per_core = g.second.second / wall / g.second.first;
+        if (g.first == 1) {
+            single = per_core;
+        }
+        out << (g.first == by_siblings.begin()->first ? " " : "; ") << g.first << " busy hardware thread"
+            << (g.first == 1 ? "" : "s") << " " << std::setprecision(1) << per_core << " " << config.rate_label
+            << " (" << g.second.first << " core" << (g.second.first == 1 ? "" : "s");
+        if (g.first > 1 && single > 0.0) {
+            out << ", " << std::setprecision(2) << per_core / single << "x one thread";
+        }
+        out << ")";
+    }
+    out << std::endl;
+}
+
+void printRunReport(std::ostream& out, const RunConfig& config, const RunResult& result) {
+    out << std::endl << std::endl;
+    out << "Final Statistics:" << std::endl;
+    printStatsLine(out, config, *result.latency, result.elapsed_seconds);
+    out << std::endl;
+    printLatencyPercentiles(out, *result.latency);
+    if (result.service) {
+        printLatencyPercentiles(out, *result.service, "Service time percentiles");
+        double achieved = result.achievedRate();
+        out << "Open loop: offered " << std::fixed << std::setprecision(1) << result.offeredRate() << " "
+            << config.rate_label << ", achieved " << achieved;
+        if (achieved < 0.95 * result.offeredRate()) {
+            out << " -- SATURATED, latency grows with the length of the run";
+        }
+        out << std::endl;
+    }
+    out << "Harness overhead: " << std::fixed << std::setprecision(1) << result.overhead.loop_ns_per_iteration
+        << " ns/iteration, empty-op timing floor (p50): " << result.overhead.timer_floor_ns << " ns" << std::endl;
+
+    printMeasurementWindow(out, config, result);
+    printUtilisation(out, config, result);
+    if (config.placement != Placement::None) {
+        printCpuBreakdown(out, config, result);
+    }
+
+    int setup_failures = 0;
+    int pin_failures = 0;
+    int stopped_threads = 0;
+    for (const auto& t : result.threads) {
+        if (t.pin_failed) {
+            pin_failures++;
+        }
+        if (t.setup_failed) {
+            setup_failures++;
+        } else if (t.failures > 0) {
+            stopped_threads++;
+        }
+    }
+    if (pin_failures > 0) {
+        out << "Warning: " << pin_failures << " worker thread(s) could not be pinned and ran unpinned" << std::endl;
+    }
+    if (setup_failures > 0) {
+        out << "Warning: " << setup_failures << " worker thread(s) failed during setup" << std::endl;
+    }
+    if (stopped_threads > 0) {
+        out << "Warning: " << stopped_threads << " worker thread(s) stopped early after a failed operation"
+            << std::endl;
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,52 @@
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <ostream>
+
+#include "engine.h"
+#include "latency_histogram.h"
+
+namespace bench {
+
+inline double nsToMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1000000.0;
+}
+
+// Average of `total_ns` over `operations`, in microseconds; 0 with no operations.
+inline double meanUs(uint64_t total_ns, uint64_t operations) {
+    return operations > 0 ? static_cast<double>(total_ns) / operations / 1000.0 : 0.0;
+}
+
+// The single-line "\rKeys: N, Throughput: ..." display, overwritten in place.
+void printStatsLine(std::ostream& out, const RunConfig& config, const LatencyHistogram& hist,
+                    double elapsed_seconds);
+
+// "Duration:" and "Warmup:" lines for a tool's settings banner; prints
+// nothing for a plain fixed-count run.
+void printRunLength(std::ostream& out, const RunConfig& config);
+
+// The tail percentiles we plan capacity on, in milliseconds.
+void printLatencyPercentiles(std::ostream& out, const LatencyHistogram& hist,
+                             const char* label = "Latency percentiles");
+
+// How long the measured run lasted and how long setup and warmup took
+// before it; for time-bounded runs also the spread of windowed throughput
+// and whether steady state was reached.
+void printMeasurementWindow(std::ostream& out, const RunConfig& config, const RunResult& result);
+
+// Busy/idle time per worker: the share of the wall clock each thread spent
+// inside operations, and how long it sat idle after running out of work.
+void printUtilisation(std::ostream& out, const RunConfig& config, const RunResult& result);
+
+// Pinned runs: operations, throughput and utilisation per CPU, then
+// throughput per physical core split by how many of its SMT siblings were
+// busy.
+void printCpuBreakdown(std::ostream& out, const RunConfig& config, const RunResult& result);
+
+// Final statistics block printed after every run: totals, percentiles,
+// harness overhead and any worker failures.
+void printRunReport(std::ostream& out, const RunConfig& config, const RunResult& result);
+
+} // namespace bench
+
+#endif // BENCH_REPORT_H
@@ -0,0 +1,287 @@
+#include "results.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <openssl/crypto.h>
+#include <sys/utsname.h>
+
+#include "cpu_info.h"
+#include "json.h"
+#include "topology.h"
+
+namespace bench {
+
+namespace {
+
+const double kRecordedPercentiles[] = {50.0, 90.0, 99.0, 99.9, 99.99};
+
+// Records already written to each path by this process
+std::map<std::string, std::vector<ResultRecord>>& writtenRecords() {
+    static std::map<std::string, std::vector<ResultRecord>> records;
+    return records;
+}
+
+std::string percentileName(double percentile) {
+    std::ostringstream name;
+    name << "p" << percentile;
+    return name.str();
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::char_traits<char>::length(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+void writeJson(std::ostream& out, const SystemInfo& system, const std::vector<ResultRecord>& records) {
+    out << "{" << std::endl;
+    out << "  \"format\": \"crypto-bench-results\"," << std::endl;
+    out << "  \"version\": 1," << std::endl;
+    out << "  \"system\": {\"os\": " << jsonString(system.os) << ", \"arch\": " << jsonString(system.arch)
+        << ", \"cpu_model\": " << jsonString(system.cpu_model) << ", \"cpu_flags\": " << jsonString(system.cpu_flags)
+        << ", \"openssl_version\": " << jsonString(system.openssl_version)
+        << ", \"logical_cpus\": " << system.logical_cpus << ", \"physical_cores\": " << system.physical_cores
+        << ", \"usable_cpus\": " << system.usable_cpus
+        << ", \"cgroup_cpu_limit\": " << jsonNumber(system.cgroup_cpu_limit) << "}," << std::endl;
+    out << "  \"results\": [" << std::endl;
+    for (size_t r = 0; r < records.size(); r++) {
+        const ResultRecord& rec = records[r];
+        out << "    {\"workload\": " << jsonString(rec.workload) << ", \"rate_unit\": " << jsonString(rec.rate_unit)
+            << ", \"threads\": " << rec.threads << "," << std::endl;
+        out << "     \"settings\": {";
+        for (size_t i = 0; i < rec.settings.size(); i++) {
+            out << (i ? ", " : "") << jsonString(rec.settings[i].first) << ": " << jsonString(rec.settings[i].second);
+        }
+        out << "}," << std::endl;
+        out << "     \"operations\": " << rec.operations << ", \"failures\": " << rec.failures
+            << ", \"elapsed_seconds\": " << jsonNumber(rec.elapsed_seconds)
+            << ", \"throughput\": " << jsonNumber(rec.throughput) << "," << std::endl;
+        out << "     \"latency_ns\": {\"min\": " << rec.min_ns << ", \"mean\": " << jsonNumber(rec.mean_ns)
+            << ", \"max\": " << rec.max_ns;
+        for (const auto& p : rec.percentiles) {
+            out << ", " << jsonString(percentileName(p.first)) << ": " << p.second;
+        }
+        out << "}," << std::endl;
+        out << "     \"histogram\": [";
+        for (size_t i = 0; i < rec.buckets.size(); i++) {
+            out << (i ? ", " : "") << "[" << rec.buckets[i].first << ", " << rec.buckets[i].second << "]";
+        }
+        out << "]}" << (r + 1 < records.size() ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+void writeCsv(std::ostream& out, const SystemInfo& system, const std::vector<ResultRecord>& records) {
+    out << "workload,rate_unit,threads,settings,operations,failures,elapsed_seconds,throughput,min_ns,mean_ns,max_ns";
+    for (double p : kRecordedPercentiles) {
+        out << "," << percentileName(p) << "_ns";
+    }
+    out << ",histogram,os,arch,cpu_model,cpu_flags,openssl_version,logical_cpus,physical_cores,usable_cpus" << std::endl;
+    for (const auto& rec : records) {
+        std::string settings;
+        for (const auto& s : rec.settings) {
+            settings += (settings.empty() ? "" : ";") + s.first + "=" + s.second;
+        }
+        // "low:count" pairs, lowest bucket first
+        std::string buckets;
+        for (const auto& b : rec.buckets) {
+            buckets += (buckets.empty() ? "" : ";") + std::to_string(b.first) + ":" + std::to_string(b.second);
+        }
+        out << csvField(rec.workload) << "," << csvField(rec.rate_unit) << "," << rec.threads << ","
+            << csvField(settings) << "," << rec.operations << "," << rec.failures << ","
+            << jsonNumber(rec.elapsed_seconds) << "," << jsonNumber(rec.throughput) << "," << rec.min_ns << ","
+            << jsonNumber(rec.mean_ns) << "," << rec.max_ns;
+        for (const auto& p : rec.percentiles) {
+            out << "," << p.second;
+        }
+        out << "," << buckets << "," << csvField(system.os) << "," << csvField(system.arch) << ","
+            << csvField(system.cpu_model) << "," << csvField(system.cpu_flags) << ","
+            << csvField(system.openssl_version) << "," << system.logical_cpus << "," << system.physical_cores << ","
+            << system.usable_cpus << std::endl;
+    }
+}
+
+ResultRecord recordFromJson(const JsonValue& json) {
+    ResultRecord rec;
+    rec.workload = json["workload"].string();
+    rec.rate_unit = json["rate_unit"].string();
+    rec.threads = static_cast<int>(json["threads"].number(1.0));
+    for (const auto& s : json["settings"].members()) {
+        rec.settings.push_back(std::make_pair(s.first, s.second.string()));
+    }
+    rec.operations = static_cast<uint64_t>(json["operations"].number());
+    rec.failures = static_cast<uint64_t>(json["failures"].number());
+    rec.elapsed_seconds = json["elapsed_seconds"].number();
+    rec.throughput = json["throughput"].number();
+    const JsonValue& latency = json["latency_ns"];
+    rec.min_ns = static_cast<uint64_t>(latency["min"].number());
+    rec.mean_ns = latency["mean"].number();
+    rec.max_ns = static_cast<uint64_t>(latency["max"].number());
+    for (double p : kRecordedPercentiles) {
+        const JsonValue& value = latency[percentileName(p)];
+        if (value.type() == JsonValue::Number) {
+            rec.percentiles.push_back(std::make_pair(p, static_cast<uint64_t>(value.number())));
+        }
+    }
+    for (const auto& bucket : json["histogram"].items()) {
+        if (bucket.items().size() == 2) {
+            rec.buckets.push_back(std::make_pair(static_cast<uint64_t>(bucket.items()[0].number()),
+                                                 static_cast<uint64_t>(bucket.items()[1].number())));
+        }
+    }
+    return rec;
+}
+
+} // namespace
+
+SystemInfo systemInfo() {
+    SystemInfo info;
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        info.os = std::string(uts.sysname) + " " + uts.release;
+        info.arch = uts.machine;
+    }
+    info.cpu_model = cpuModelName();
+    info.cpu_flags = cpuCryptoFlags();
+    info.openssl_version = OpenSSL_version(OPENSSL_VERSION);
+    const CpuTopology& topology = cpuTopology();
+    info.logical_cpus = topology.online_cpus;
+    info.physical_cores = topology.physical_cores;
+    info.usable_cpus = topology.usableCpus();
+    info.cgroup_cpu_limit = topology.cgroup_cpu_limit;
+    return info;
+}
+
+ResultRecord resultRecord(const std::string& workload, const char* rate_unit, const LatencyHistogram& hist) {
+    ResultRecord record;
+    record.workload = workload;
+    record.rate_unit = rate_unit;
+    record.min_ns = hist.min();
+    record.mean_ns = hist.mean();
+    record.max_ns = hist.max();
+    for (double p : kRecordedPercentiles) {
+        record.percentiles.push_back(std::make_pair(p, hist.valueAtPercentile(p)));
+    }
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        uint64_t count = hist.bucketCount(i);
+        if (count > 0) {
+            record.buckets.push_back(std::make_pair(LatencyHistogram::bucketLowValue(i), count));
+        }
+    }
+    return record;
+}
+
+ResultRecord resultRecord(const std::string& workload, const RunConfig& config, const RunResult& result,
+                          const Settings& extra) {
+    ResultRecord record = resultRecord(workload, config.rate_label, *result.latency);
+    record.threads = config.num_threads;
+    record.operations = result.operations;
+    record.failures = result.failures;
+    record.elapsed_seconds = result.elapsed_seconds;
+    record.throughput = result.throughput();
+
+    Settings& s = record.settings;
+    if (config.timeBounded()) {
+        std::ostringstream duration;
+        duration << config.duration_seconds;
+        s.push_back(std::make_pair("duration_seconds", duration.str()));
+        s.push_back(std::make_pair("steady_state", config.steady_state ? "yes" : "no"));
+    } else {
+        s.push_back(std::make_pair("loops_per_thread", std::to_string(config.loops_per_thread)));
+    }
+    std::ostringstream warmup;
+    warmup << config.warmup_seconds;
+    s.push_back(std::make_pair("warmup_seconds", warmup.str()));
+    s.push_back(std::make_pair("schedule", config.schedule == Schedule::Dynamic ? "dynamic" : "static"));
+    s.push_back(std::make_pair("stats", config.stats_mode == StatsMode::Mutex ? "mutex" : "sharded"));
+    s.push_back(std::make_pair("libctx", config.libctx_mode == LibCtxMode::Isolated ? "isolated" : "shared"));
+    s.push_back(std::make_pair("pin", placementName(config.placement)));
+    if (config.openLoop()) {
+        std::ostringstream rate;
+        rate << config.target_rate;
+        s.push_back(std::make_pair("target_rate", rate.str()));
+        s.push_back(std::make_pair("arrivals", config.arrivals == Arrivals::Poisson ? "poisson" : "fixed"));
+    }
+    if (config.async_jobs > 0) {
+        s.push_back(std::make_pair("async_jobs", std::to_string(config.async_jobs)));
+    }
+    if (config.seeded) {
+        s.push_back(std::make_pair("seed", std::to_string(config.seed)));
+    }
+    s.insert(s.end(), extra.begin(), extra.end());
+    return record;
+}
+
+bool appendResult(const std::string& path, const ResultRecord& record, std::string& error) {
+    std::vector<ResultRecord>& records = writtenRecords()[path];
+    records.push_back(record);
+
+    std::ofstream out(path);
+    if (!out) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+    SystemInfo system = systemInfo();
+    if (endsWith(path, ".json")) {
+        writeJson(out, system, records);
+    } else {
+        writeCsv(out, system, records);
+    }
+    if (!out) {
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+bool loadResults(const std::string& path, SystemInfo& system, std::vector<ResultRecord>& records,
+                 std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    JsonValue doc;
+    if (!JsonValue::parse(text.str(), doc, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    if (doc["format"].string() != "crypto-bench-results") {
+        error = path + " is not a results file written with --output FILE.json";
+        return false;
+    }
+
+    const JsonValue& sys = doc["system"];
+    system.os = sys["os"].string();
+    system.arch = sys["arch"].string();
+    system.cpu_model = sys["cpu_model"].string();
+    system.cpu_flags = sys["cpu_flags"].string();
+    system.openssl_version = sys["openssl_version"].string();
+    system.logical_cpus = static_cast<int>(sys["logical_cpus"].number());
+    system.physical_cores = static_cast<int>(sys["physical_cores"].number());
+    system.usable_cpus = static_cast<int>(sys["usable_cpus"].number());
+    system.cgroup_cpu_limit = sys["cgroup_cpu_limit"].number();
+
+    records.clear();
+    for (const auto& r : doc["results"].items()) {
+        records.push_back(recordFromJson(r));
+    }
+    return true;
+}
+
+void saveResult(const RunConfig& config, const std::string& workload, const RunResult& result,
+                const Settings& extra) {
+    if (config.results_output.empty()) {
+        return;
+    }
+    std::string error;
+    if (!appendResult(config.results_output, resultRecord(workload, config, result, extra), error)) {
+        std::cerr << "Error: " << error << std::endl;
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,78 @@
+#ifndef BENCH_RESULTS_H
+#define BENCH_RESULTS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engine.h"
+#include "latency_histogram.h"
+
+namespace bench {
+
+// The host a result was measured on; what crypto_benchmark prints as
+// "System Information", plus the topology the process could use.
+struct SystemInfo {
+    std::string os;
+    std::string arch;
+    std::string cpu_model;
+    std::string cpu_flags;
+    std::string openssl_version;
+    int logical_cpus = 0;
+    int physical_cores = 0;
+    int usable_cpus = 0;
+    double cgroup_cpu_limit = 0.0;
+};
+
+SystemInfo systemInfo();
+
+typedef std::vector<std::pair<std::string, std::string>> Settings;
+
+// One measured run in the form written to --output files.
+struct ResultRecord {
+    std::string workload;  // e.g. "ecdsa_signer sign P256"; with threads, the key records are matched on
+    std::string rate_unit;
+    int threads = 1;
+    Settings settings;     // everything else that shaped the run, as name/value pairs
+    uint64_t operations = 0;
+    uint64_t failures = 0;
+    double elapsed_seconds = 0.0;
+    double throughput = 0.0;
+    // Latency summary in nanoseconds
+    uint64_t min_ns = 0;
+    double mean_ns = 0.0;
+    uint64_t max_ns = 0;
+    std::vector<std::pair<double, uint64_t>> percentiles; // (percentile, value)
+    // Non-empty histogram buckets as (lowest value in the bucket, count):
+    // the per-operation samples at the histogram's ~0.8% resolution
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;
+};
+
+// Summary and buckets of `hist`; the caller fills in the rest.
+ResultRecord resultRecord(const std::string& workload, const char* rate_unit, const LatencyHistogram& hist);
+
+// A whole engine run, with the shared RunConfig settings followed by the
+// tool's own `extra` settings.
+ResultRecord resultRecord(const std::string& workload, const RunConfig& config, const RunResult& result,
+                          const Settings& extra = Settings());
+
+// Add `record` to the results file at `path` and rewrite it, so the file
+// always holds every record this process has produced for it: JSON (if
+// `path` ends in ".json") with the system info once and an array of
+// records, or CSV with one row per record and the system info repeated.
+bool appendResult(const std::string& path, const ResultRecord& record, std::string& error);
+
+// Read a JSON results file back. CSV files are for spreadsheets and are
+// not read.
+bool loadResults(const std::string& path, SystemInfo& system, std::vector<ResultRecord>& records,
+                 std::string& error);
+
+// For tools: append the run to config.results_output if one was given,
+// reporting any error on stderr.
+void saveResult(const RunConfig& config, const std::string& workload, const RunResult& result,
+                const Settings& extra = Settings());
+
+} // namespace bench
+
+#endif // BENCH_RESULTS_H
@@ -0,0 +1,284 @@
+#include "rsa_ops.h"
+
+#include <iomanip>
+#include <sstream>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+
+#include "report.h"
+
+namespace bench {
+
+const std::vector<RsaOpInfo>& rsaOps() {
+    static const std::vector<RsaOpInfo> ops = {
+        {RsaOp::SignPkcs1, "sign-pkcs1", "PKCS#1 v1.5 signature, SHA-256", true},
+        {RsaOp::VerifyPkcs1, "verify-pkcs1", "PKCS#1 v1.5 verification, SHA-256", false},
+        {RsaOp::SignPssDigest, "sign-pss", "PSS signature, SHA-256, salt = digest length", true},
+        {RsaOp::VerifyPssDigest, "verify-pss", "PSS verification, SHA-256, salt = digest length", false},
+        {RsaOp::SignPssMax, "sign-pss-max", "PSS signature, SHA-256, maximum salt length", true},
+        {RsaOp::VerifyPssMax, "verify-pss-max", "PSS verification, SHA-256, maximum salt length", false},
+        {RsaOp::EncryptOaepSha1, "encrypt-oaep-sha1", "OAEP encryption, SHA-1/MGF1-SHA1", false},
+        {RsaOp::DecryptOaepSha1, "decrypt-oaep-sha1", "OAEP decryption, SHA-1/MGF1-SHA1", true},
+        {RsaOp::EncryptOaepSha256, "encrypt-oaep-sha256", "OAEP encryption, SHA-256/MGF1-SHA256", false},
+        {RsaOp::DecryptOaepSha256, "decrypt-oaep-sha256", "OAEP decryption, SHA-256/MGF1-SHA256", true},
+        {RsaOp::RawPrivate, "raw-private", "Unpadded private-key operation", true},
+        {RsaOp::RawPublic, "raw-public", "Unpadded public-key operation", false},
+    };
+    return ops;
+}
+
+const RsaOpInfo& rsaOpInfo(RsaOp op) {
+    for (const auto& info : rsaOps()) {
+        if (info.op == op) {
+            return info;
+        }
+    }
+    return rsaOps().front();
+}
+
+bool parseRsaOps(const std::string& list, std::vector<RsaOp>& ops) {
+    ops.clear();
+    if (list == "all") {
+        for (const auto& info : rsaOps()) {
+            ops.push_back(info.op);
+        }
+        return true;
+    }
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        bool found = false;
+        for (const auto& info : rsaOps()) {
+            if (item == info.name) {
+                ops.push_back(info.op);
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return !ops.empty();
+}
+
+bool rsaOpFits(RsaOp op, int bits) {
+    const int sha256_len = 32;
+    const int sha1_len = 20;
+    int modulus_len = (bits + 7) / 8;
+    int encoded_len = (bits - 1 + 7) / 8; // PSS encodes into emBits = bits - 1
+    switch (op) {
+    case RsaOp::SignPkcs1:
+    case RsaOp::VerifyPkcs1:
+        return modulus_len >= 19 + sha256_len + 11; // DigestInfo prefix, digest, minimum padding
+    case RsaOp::SignPssDigest:
+    case RsaOp::VerifyPssDigest:
+        return encoded_len >= sha256_len + sha256_len + 2;
+    case RsaOp::SignPssMax:
+    case RsaOp::VerifyPssMax:
+        return encoded_len >= sha256_len + 2;
+    case RsaOp::EncryptOaepSha1:
+    case RsaOp::DecryptOaepSha1:
+        return modulus_len > 2 * sha1_len + 2;
+    case RsaOp::EncryptOaepSha256:
+    case RsaOp::DecryptOaepSha256:
+        return modulus_len > 2 * sha256_len + 2;
+    case RsaOp::RawPrivate:
+    case RsaOp::RawPublic:
+    default:
+        return true;
+    }
+}
+
+// Padding and digests for `op` on a freshly initialised context.
+static bool applyPadding(EVP_PKEY_CTX* ctx, RsaOp op) {
+    switch (op) {
+    case RsaOp::SignPkcs1:
+    case RsaOp::VerifyPkcs1:
+        return EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_PADDING) > 0 &&
+               EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()) > 0;
+    case RsaOp::SignPssDigest:
+    case RsaOp::VerifyPssDigest:
+    case RsaOp::SignPssMax:
+    case RsaOp::VerifyPssMax: {
+        bool max_salt = op == RsaOp::SignPssMax || op == RsaOp::VerifyPssMax;
+        return EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_PSS_PADDING) > 0 &&
+               EVP_PKEY_CTX_set_signature_md(ctx, EVP_sha256()) > 0 &&
+               EVP_PKEY_CTX_set_rsa_mgf1_md(ctx, EVP_sha256()) > 0 &&
+               EVP_PKEY_CTX_set_rsa_pss_saltlen(ctx, max_salt ? RSA_PSS_SALTLEN_MAX : RSA_PSS_SALTLEN_DIGEST) > 0;
+    }
+    case RsaOp::EncryptOaepSha1:
+    case RsaOp::DecryptOaepSha1:
+    case RsaOp::EncryptOaepSha256:
+    case RsaOp::DecryptOaepSha256: {
+        bool sha1 = op == RsaOp::EncryptOaepSha1 || op == RsaOp::DecryptOaepSha1;
+        const EVP_MD* md = sha1 ? EVP_sha1() : EVP_sha256();
+        return EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_OAEP_PADDING) > 0 &&
+               EVP_PKEY_CTX_set_rsa_oaep_md(ctx, md) > 0 && EVP_PKEY_CTX_set_rsa_mgf1_md(ctx, md) > 0;
+    }
+    case RsaOp::RawPrivate:
+    case RsaOp::RawPublic:
+    default:
+        return EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_NO_PADDING) > 0;
+    }
+}
+
+static bool randomBytes(std::vector<unsigned char>& buffer, size_t size) {
+    buffer.resize(size);
+    return size == 0 || RAND_bytes(buffer.data(), static_cast<int>(size)) == 1;
+}
+
+RsaOperation::RsaOperation(EVP_PKEY* key, RsaOp op, OSSL_LIB_CTX* libctx)
+    : key_(key), ctx_(EVP_PKEY_CTX_new_from_pkey(libctx, key, nullptr)), kind_(Sign), ready_(false) {
+    ready_ = ctx_ != nullptr && setUp(op, libctx);
+}
+
+RsaOperation::~RsaOperation() {
+    EVP_PKEY_CTX_free(ctx_);
+    EVP_PKEY_free(key_);
+}
+
+bool RsaOperation::setUp(RsaOp op, OSSL_LIB_CTX*) {
+    size_t modulus_len = static_cast<size_t>(EVP_PKEY_get_size(key_));
+    output_.resize(modulus_len);
+    switch (op) {
+    case RsaOp::SignPkcs1:
+    case RsaOp::SignPssDigest:
+    case RsaOp::SignPssMax:
+        kind_ = Sign;
+        return randomBytes(input_, 32) && EVP_PKEY_sign_init(ctx_) > 0 && applyPadding(ctx_, op);
+    case RsaOp::VerifyPkcs1:
+    case RsaOp::VerifyPssDigest:
+    case RsaOp::VerifyPssMax: {
+        // Sign the digest once with the same parameters, then switch the context to verifying
+        kind_ = Verify;
+        size_t signature_len = modulus_len;
+        expected_.resize(modulus_len);
+        if (!randomBytes(input_, 32) || EVP_PKEY_sign_init(ctx_) <= 0 || !applyPadding(ctx_, op) ||
+            EVP_PKEY_sign(ctx_, expected_.data(), &signature_len, input_.data(), input_.size()) <= 0) {
+            return false;
+        }
+        expected_.resize(signature_len);
+        return EVP_PKEY_verify_init(ctx_) > 0 && applyPadding(ctx_, op);
+    }
+    case RsaOp::EncryptOaepSha1:
+    case RsaOp::EncryptOaepSha256: {
+        kind_ = Encrypt;
+        size_t hash_len = op == RsaOp::EncryptOaepSha1 ? 20 : 32;
+        size_t room = modulus_len - 2 * hash_len - 2;
+        return randomBytes(input_, room < 32 ? room : 32) && EVP_PKEY_encrypt_init(ctx_) > 0 &&
+               applyPadding(ctx_, op);
+    }
+    case RsaOp::DecryptOaepSha1:
+    case RsaOp::DecryptOaepSha256: {
+        // Encrypt a 32-byte key once, then decrypt it on every call
+        kind_ = Decrypt;
+        size_t hash_len = op == RsaOp::DecryptOaepSha1 ? 20 : 32;
+        size_t room = modulus_len - 2 * hash_len - 2;
+        size_t ciphertext_len = modulus_len;
+        expected_.resize(modulus_len);
+        if (!randomBytes(input_, room < 32 ? room : 32) || EVP_PKEY_encrypt_init(ctx_) <= 0 ||
+            !applyPadding(ctx_, op) ||
+            EVP_PKEY_encrypt(ctx_, expected_.data(), &ciphertext_len, input_.data(), input_.size()) <= 0) {
+            return false;
+        }
+        expected_.resize(ciphertext_len);
+        return EVP_PKEY_decrypt_init(ctx_) > 0 && applyPadding(ctx_, op);
+    }
+    case RsaOp::RawPrivate:
+        // A random value below the modulus (top byte clear), raised to d
+        kind_ = Decrypt;
+        if (!randomBytes(expected_, modulus_len)) {
+            return false;
+        }
+        expected_[0] = 0;
+        return EVP_PKEY_decrypt_init(ctx_) > 0 && applyPadding(ctx_, op);
+    case RsaOp::RawPublic:
+    default:
+        kind_ = Encrypt;
+        if (!randomBytes(input_, modulus_len)) {
+            return false;
+        }
+        input_[0] = 0;
+        return EVP_PKEY_encrypt_init(ctx_) > 0 && applyPadding(ctx_, op);
+    }
+}
+
+static const RsaOpResult* findResult(const std::vector<RsaOpResult>& results, RsaOp op, int bits) {
+    for (const auto& r : results) {
+        if (r.op == op && r.bits == bits && r.measured) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+void printRsaOpMatrix(std::ostream& out, const RunConfig& config, const std::vector<int>& keysizes,
+                      const std::vector<RsaOp>& ops, const std::vector<RsaOpResult>& results) {
+    const int name_width = 21;
+    const int column_width = 13;
+
+    out << std::endl;
+    out << "Throughput (ops/s, " << config.num_threads << " thread" << (config.num_threads == 1 ? "" : "s") << "):"
+        << std::endl;
+    out << std::left << std::setw(name_width) << "Operation" << std::right;
+    for (int bits : keysizes) {
+        out << std::setw(column_width) << ("RSA-" + std::to_string(bits));
+    }
+    out << std::endl;
+    for (RsaOp op : ops) {
+        out << std::left << std::setw(name_width) << rsaOpInfo(op).name << std::right << std::fixed
+            << std::setprecision(1);
+        for (int bits : keysizes) {
+            const RsaOpResult* r = findResult(results, op, bits);
+            if (r) {
+                out << std::setw(column_width) << r->throughput;
+            } else {
+                out << std::setw(column_width) << "n/a";
+            }
+        }
+        out << std::endl;
+    }
+    out << "n/a: the padding does not fit the modulus." << std::endl;
+
+    bool have_raw = false;
+    for (RsaOp op : ops) {
+        have_raw = have_raw || op == RsaOp::RawPrivate || op == RsaOp::RawPublic;
+    }
+    if (!have_raw) {
+        return;
+    }
+
+    // Each padded operation against the bare exponentiation it wraps
+    out << std::endl;
+    out << "Padding cost over the raw operation (mean us added per op, share of the op):" << std::endl;
+    out << std::left << std::setw(name_width) << "Operation" << std::right;
+    for (int bits : keysizes) {
+        out << std::setw(column_width + 4) << ("RSA-" + std::to_string(bits));
+    }
+    out << std::endl;
+    for (RsaOp op : ops) {
+        if (op == RsaOp::RawPrivate || op == RsaOp::RawPublic) {
+            continue;
+        }
+        RsaOp raw = rsaOpInfo(op).private_key ? RsaOp::RawPrivate : RsaOp::RawPublic;
+        out << std::left << std::setw(name_width) << rsaOpInfo(op).name << std::right;
+        for (int bits : keysizes) {
+            const RsaOpResult* r = findResult(results, op, bits);
+            const RsaOpResult* base = findResult(results, raw, bits);
+            std::ostringstream cell;
+            if (r && base && r->mean_ns > 0.0) {
+                double added = r->mean_ns - base->mean_ns;
+                cell << std::fixed << std::showpos << std::setprecision(1) << added / 1000.0 << std::noshowpos
+                     << " (" << std::setprecision(0) << 100.0 * added / r->mean_ns << "%)";
+            } else {
+                cell << "-";
+            }
+            out << std::setw(column_width + 4) << cell.str();
+        }
+        out << std::endl;
+    }
+    out << "Compared on mean latency: signing and decryption against raw-private, the rest against raw-public."
+        << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,112 @@
+#ifndef BENCH_RSA_OPS_H
+#define BENCH_RSA_OPS_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "engine.h"
+
+namespace bench {
+
+// The RSA primitives and paddings rsa_ops measures. Signatures are over a
+// SHA-256 digest computed up front, so every operation is one EVP_PKEY_*
+// call: padding plus modular exponentiation, no hashing.
+enum class RsaOp {
+    SignPkcs1,
+    VerifyPkcs1,
+    SignPssDigest,     // PSS, salt length = digest length
+    VerifyPssDigest,
+    SignPssMax,        // PSS, maximum salt length
+    VerifyPssMax,
+    EncryptOaepSha1,
+    DecryptOaepSha1,
+    EncryptOaepSha256,
+    DecryptOaepSha256,
+    RawPrivate,        // m^d mod n with no padding (CRT and blinding included)
+    RawPublic          // m^e mod n with no padding
+};
+
+struct RsaOpInfo {
+    RsaOp op;
+    const char* name;        // as given to --ops
+    const char* description;
+    bool private_key;        // uses the private exponent (sign, decrypt, raw-private)
+};
+
+// Every operation, in table order.
+const std::vector<RsaOpInfo>& rsaOps();
+
+const RsaOpInfo& rsaOpInfo(RsaOp op);
+
+// Comma-separated operation names, or "all".
+bool parseRsaOps(const std::string& list, std::vector<RsaOp>& ops);
+
+// Whether the padding fits a `bits`-bit modulus at all (PSS with a
+// digest-length salt and OAEP-SHA256 need more room than RSA-512 has).
+bool rsaOpFits(RsaOp op, int bits);
+
+// One operation per call on a worker's own copy of the key, with the
+// EVP_PKEY_CTX initialised and padded once. Verify and decrypt work on a
+// signature or ciphertext the operation made for itself at setup.
+class RsaOperation : public Operation {
+public:
+    // Takes ownership of `key`.
+    RsaOperation(EVP_PKEY* key, RsaOp op, OSSL_LIB_CTX* libctx);
+    ~RsaOperation();
+
+    RsaOperation(const RsaOperation&) = delete;
+    RsaOperation& operator=(const RsaOperation&) = delete;
+
+    bool valid() const { return ready_; }
+
+    bool operator()() {
+        size_t out_len = output_.size();
+        switch (kind_) {
+        case Sign:
+            return EVP_PKEY_sign(ctx_, output_.data(), &out_len, input_.data(), input_.size()) > 0;
+        case Verify:
+            return EVP_PKEY_verify(ctx_, expected_.data(), expected_.size(), input_.data(), input_.size()) == 1;
+        case Encrypt:
+            return EVP_PKEY_encrypt(ctx_, output_.data(), &out_len, input_.data(), input_.size()) > 0;
+        case Decrypt:
+        default:
+            return EVP_PKEY_decrypt(ctx_, output_.data(), &out_len, expected_.data(), expected_.size()) > 0;
+        }
+    }
+
+private:
+    enum Kind { Sign, Verify, Encrypt, Decrypt };
+
+    bool setUp(RsaOp op, OSSL_LIB_CTX* libctx);
+
+    EVP_PKEY* key_;
+    EVP_PKEY_CTX* ctx_;
+    Kind kind_;
+    bool ready_;
+    std::vector<unsigned char> input_;    // digest to sign, or plaintext to encrypt
+    std::vector<unsigned char> expected_; // signature to verify, or ciphertext to decrypt
+    std::vector<unsigned char> output_;
+};
+
+struct RsaOpResult {
+    RsaOp op = RsaOp::SignPkcs1;
+    int bits = 0;
+    bool measured = false; // false if the padding does not fit the key
+    double throughput = 0.0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+};
+
+// Throughput of every operation at every key size, then the mean time each
+// padded operation adds over the raw private or public operation.
+void printRsaOpMatrix(std::ostream& out, const RunConfig& config, const std::vector<int>& keysizes,
+                      const std::vector<RsaOp>& ops, const std::vector<RsaOpResult>& results);
+
+} // namespace bench
+
+#endif // BENCH_RSA_OPS_H
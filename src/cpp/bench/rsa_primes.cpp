@@ -0,0 +1,78 @@
+#include "rsa_primes.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "report.h"
+
+namespace bench {
+
+int maxRSAPrimes(int bits) {
+    // Mirrors ossl_rsa_multip_cap(); keygen fails above it
+    if (bits < 1024) {
+        return 2;
+    }
+    if (bits < 4096) {
+        return 3;
+    }
+    if (bits < 8192) {
+        return 4;
+    }
+    return 5;
+}
+
+bool parseRSAPrimes(const std::string& list, std::vector<int>& primes) {
+    primes.clear();
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        int count = std::atoi(item.c_str());
+        if (count < 2 || count > 5) {
+            return false;
+        }
+        primes.push_back(count);
+    }
+    return !primes.empty();
+}
+
+std::string rsaPrimesSuffix(int primes) {
+    return primes == 2 ? "" : " " + std::to_string(primes) + "-prime";
+}
+
+void printPrimeCountTable(std::ostream& out, const char* rate_label, const std::vector<PrimeCountResult>& results) {
+    if (results.empty()) {
+        return;
+    }
+
+    out << std::endl;
+    out << std::left << std::setw(10) << "Key" << std::right << std::setw(7) << "Primes" << std::setw(14) << rate_label
+        << std::setw(11) << "mean(ms)" << std::setw(11) << "p50(ms)" << std::setw(11) << "p99(ms)" << std::setw(12)
+        << "vs 2-prime" << std::endl;
+    for (const auto& r : results) {
+        const PrimeCountResult* base = nullptr;
+        for (const auto& b : results) {
+            if (b.bits == r.bits && b.primes == 2) {
+                base = &b;
+            }
+        }
+        out << std::left << std::setw(10) << ("RSA-" + std::to_string(r.bits)) << std::right << std::setw(7)
+            << r.primes << std::fixed << std::setprecision(1) << std::setw(14) << r.throughput << std::setprecision(3)
+            << std::setw(11) << r.mean_ns / 1e6 << std::setw(11) << nsToMs(r.p50_ns) << std::setw(11)
+            << nsToMs(r.p99_ns);
+        if (base && base->throughput > 0.0) {
+            std::ostringstream ratio;
+            ratio << std::fixed << std::setprecision(2) << r.throughput / base->throughput << "x";
+            out << std::setw(12) << ratio.str();
+        } else {
+            out << std::setw(12) << "-";
+        }
+        if (r.failures > 0) {
+            out << "  (" << r.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "vs 2-prime: throughput relative to the ordinary two-prime key of the same size" << std::endl;
+}
+
+} // namespace bench
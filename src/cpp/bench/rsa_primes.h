@@ -0,0 +1,42 @@
+#ifndef BENCH_RSA_PRIMES_H
+#define BENCH_RSA_PRIMES_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Multi-prime RSA (RFC 8017): the modulus is the product of 3 to 5 primes
+// instead of 2. CRT private operations then work on smaller residues, so
+// signing and decryption get faster while public operations are unchanged.
+
+// The most primes OpenSSL allows for a modulus of `bits`: 2 below 1024
+// bits, 3 below 4096, 4 below 8192 and 5 from there.
+int maxRSAPrimes(int bits);
+
+// Comma-separated prime counts, each between 2 and 5.
+bool parseRSAPrimes(const std::string& list, std::vector<int>& primes);
+
+// Suffix naming the prime count in workloads: empty for ordinary 2-prime
+// keys, so their records still match files written before --primes.
+std::string rsaPrimesSuffix(int primes);
+
+struct PrimeCountResult {
+    int bits = 0;
+    int primes = 2;
+    double throughput = 0.0;
+    double mean_ns = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+};
+
+// One row per key size and prime count, with throughput relative to the
+// 2-prime key of the same size when that was measured too.
+void printPrimeCountTable(std::ostream& out, const char* rate_label, const std::vector<PrimeCountResult>& results);
+
+} // namespace bench
+
+#endif // BENCH_RSA_PRIMES_H
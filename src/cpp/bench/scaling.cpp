@@ -0,0 +1,271 @@
+#include "scaling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "json.h"
+#include "report.h"
+
+namespace bench {
+
+std::vector<int> scalingSteps(int max_threads) {
+    std::set<int> steps;
+    for (int n = 1; n < max_threads; n *= 2) {
+        steps.insert(n);
+    }
+    steps.insert(max_threads);
+    // Counted within the affinity mask and cgroup quota, which is what the
+    // workers can actually occupy
+    const CpuTopology& topology = cpuTopology();
+    int physical = std::min(topology.physical_cores, topology.usableCpus());
+    int logical = topology.usableCpus();
+    if (physical < max_threads) {
+        steps.insert(physical);
+    }
+    if (logical < max_threads) {
+        steps.insert(logical);
+    }
+    return std::vector<int>(steps.begin(), steps.end());
+}
+
+ScalingPoint scalingPoint(int threads, const RunResult& result) {
+    ScalingPoint point;
+    point.threads = threads;
+    point.throughput = result.throughput();
+    point.p50_ns = result.latency->valueAtPercentile(50.0);
+    point.p99_ns = result.latency->valueAtPercentile(99.0);
+    point.failures = result.failures;
+    return point;
+}
+
+double analyseScaling(std::vector<ScalingPoint>& points) {
+    if (points.empty()) {
+        return 0.0;
+    }
+    double base = points.front().throughput / points.front().threads;
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (auto& p : points) {
+        p.speedup = base > 0.0 ? p.throughput / base : 0.0;
+        p.efficiency = p.speedup / p.threads;
+        if (p.threads < 2 || p.speedup <= 0.0) {
+            p.serial_fraction = std::nan("");
+            continue;
+        }
+        // Amdahl: 1/S - 1/n = s * (1 - 1/n), a line through the origin in s
+        double x = 1.0 - 1.0 / p.threads;
+        double y = 1.0 / p.speedup - 1.0 / p.threads;
+        p.serial_fraction = y / x;
+        numerator += x * y;
+        denominator += x * x;
+    }
+    return denominator > 0.0 ? numerator / denominator : std::nan("");
+}
+
+void printScalingTable(std::ostream& out, const RunConfig& config, const std::vector<ScalingPoint>& points,
+                       double fitted_serial_fraction) {
+    if (points.empty()) {
+        return;
+    }
+
+    out << std::endl;
+    out << "Threads" << std::setw(16) << config.rate_label << std::setw(14) << "per thread" << std::setw(10)
+        << "speedup" << std::setw(12) << "efficiency" << std::setw(9) << "serial" << std::setw(11) << "p50(ms)"
+        << std::setw(11) << "p99(ms)" << std::endl;
+    for (const auto& p : points) {
+        out << std::setw(7) << p.threads << std::fixed << std::setprecision(1) << std::setw(16) << p.throughput
+            << std::setw(14) << p.throughput / p.threads << std::setprecision(2) << std::setw(9) << p.speedup << "x"
+            << std::setprecision(1) << std::setw(11) << 100.0 * p.efficiency << "%" << std::setprecision(3);
+        if (std::isnan(p.serial_fraction)) {
+            out << std::setw(9) << "-";
+        } else {
+            out << std::setw(9) << p.serial_fraction;
+        }
+        out << std::setw(11) << nsToMs(p.p50_ns) << std::setw(11) << nsToMs(p.p99_ns);
+        if (p.failures > 0) {
+            out << "  (" << p.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "Serial fraction per step is the Karp-Flatt metric. ";
+    if (std::isnan(fitted_serial_fraction)) {
+        out << "A fitted serial fraction needs at least two thread counts." << std::endl;
+        return;
+    }
+    out << "Fitted serial fraction (Amdahl, least squares): " << std::setprecision(4) << fitted_serial_fraction;
+    if (fitted_serial_fraction > 0.0) {
+        out << ", speedup limit " << std::setprecision(1) << 1.0 / fitted_serial_fraction << "x";
+    }
+    out << std::endl;
+}
+
+bool writeSweepResults(const std::string& path, const std::string& workload, const RunConfig& config,
+                       const std::vector<ScalingPoint>& points, double fitted_serial_fraction, std::string& error) {
+    std::ofstream out(path);
+    if (!out) {
+        error = "cannot open " + path + " for writing";
+        return false;
+    }
+    std::string cpu = cpuModelName();
+    int physical = physicalCoreCount();
+    int logical = logicalCpuCount();
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+
+    if (json) {
+        out << "{" << std::endl;
+        out << "  \"workload\": " << jsonString(workload) << "," << std::endl;
+        out << "  \"rate_unit\": " << jsonString(config.rate_label) << "," << std::endl;
+        out << "  \"cpu_model\": " << jsonString(cpu) << "," << std::endl;
+        out << "  \"physical_cores\": " << physical << "," << std::endl;
+        out << "  \"logical_cpus\": " << logical << "," << std::endl;
+        out << "  \"fitted_serial_fraction\": " << jsonNumber(fitted_serial_fraction) << "," << std::endl;
+        out << "  \"points\": [" << std::endl;
+        for (size_t i = 0; i < points.size(); i++) {
+            const ScalingPoint& p = points[i];
+            out << "    {\"threads\": " << p.threads << ", \"throughput\": " << jsonNumber(p.throughput)
+                << ", \"speedup\": " << jsonNumber(p.speedup) << ", \"efficiency\": " << jsonNumber(p.efficiency)
+                << ", \"serial_fraction\": " << jsonNumber(p.serial_fraction) << ", \"p50_ns\": " << p.p50_ns
+                << ", \"p99_ns\": " << p.p99_ns << ", \"failures\": " << p.failures << "}"
+                << (i + 1 < points.size() ? "," : "") << std::endl;
+        }
+        out << "  ]" << std::endl;
+        out << "}" << std::endl;
+    } else {
+        out << "workload,rate_unit,cpu_model,physical_cores,logical_cpus,threads,throughput,speedup,efficiency,"
+               "serial_fraction,fitted_serial_fraction,p50_ns,p99_ns,failures"
+            << std::endl;
+        for (const auto& p : points) {
+            out << csvField(workload) << "," << csvField(config.rate_label) << "," << csvField(cpu) << ","
+                << physical << "," << logical << "," << p.threads << "," << jsonNumber(p.throughput) << ","
+                << jsonNumber(p.speedup) << "," << jsonNumber(p.efficiency) << ","
+                << (std::isnan(p.serial_fraction) ? "" : jsonNumber(p.serial_fraction)) << ","
+                << (std::isnan(fitted_serial_fraction) ? "" : jsonNumber(fitted_serial_fraction)) << ","
+                << p.p50_ns << "," << p.p99_ns << "," << p.failures << std::endl;
+        }
+    }
+    if (!out) {
+        error = "failed writing " + path;
+        return false;
+    }
+    return true;
+}
+
+void printPairedScalingTable(std::ostream& out, const RunConfig& config, const char* baseline_label,
+                             const char* variant_label, const std::vector<PairedScalingPoint>& points) {
+    if (points.empty()) {
+        return;
+    }
+    const ScalingPoint& first_baseline = points.front().baseline;
+    const ScalingPoint& first_variant = points.front().variant;
+    double baseline_base = first_baseline.throughput / first_baseline.threads;
+    double variant_base = first_variant.throughput / first_variant.threads;
+    std::string baseline_x = std::string(baseline_label) + "-x";
+    std::string variant_x = std::string(variant_label) + "-x";
+    std::string baseline_p99 = std::string("p99 ") + baseline_label;
+    std::string variant_p99 = std::string("p99 ") + variant_label;
+
+    out << std::endl;
+    out << "Threads" << std::setw(14) << baseline_label << std::setw(14) << variant_label << std::setw(9) << "gain"
+        << std::setw(13) << baseline_x << std::setw(13) << variant_x << std::setw(15) << baseline_p99 << std::setw(15)
+        << variant_p99 << std::endl;
+    for (const auto& p : points) {
+        double gain = p.baseline.throughput > 0.0 ? 100.0 * (p.variant.throughput / p.baseline.throughput - 1.0)
+                                                  : 0.0;
+        out << std::setw(7) << p.baseline.threads << std::fixed << std::setprecision(1) << std::setw(14)
+            << p.baseline.throughput << std::setw(14) << p.variant.throughput << std::showpos << std::setw(8)
+            << gain << "%" << std::noshowpos << std::setprecision(2) << std::setw(12)
+            << (baseline_base > 0.0 ? p.baseline.throughput / baseline_base : 0.0) << "x" << std::setw(12)
+            << (variant_base > 0.0 ? p.variant.throughput / variant_base : 0.0) << "x" << std::setprecision(3)
+            << std::setw(15) << nsToMs(p.baseline.p99_ns) << std::setw(15) << nsToMs(p.variant.p99_ns);
+        uint64_t failures = p.baseline.failures + p.variant.failures;
+        if (failures > 0) {
+            out << "  (" << failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "Throughput in " << config.rate_label << " (" << baseline_label << ", then " << variant_label
+        << "), p99 in ms; -x columns are speedup over the same" << std::endl
+        << "configuration's single-thread rate." << std::endl;
+}
+
+double emptyOperationMeanNs(const RunConfig& base) {
+    RunConfig config;
+    config.num_threads = 1;
+    config.loops_per_thread = 100000;
+    config.stats_mode = base.stats_mode;
+    config.async_jobs = base.async_jobs;
+    config.live_stats = false;
+    RunResult result = run(config, [](int) { return std::unique_ptr<NullOperation>(new NullOperation()); });
+    return result.latency->mean();
+}
+
+void printAsyncTable(std::ostream& out, const RunConfig& config, const std::vector<AsyncPoint>& points) {
+    if (points.empty()) {
+        return;
+    }
+    const AsyncPoint& direct = points.front();
+
+    out << std::endl;
+    out << "   Jobs" << std::setw(14) << "rate" << std::setw(11) << "vs direct" << std::setw(12) << "mean ms"
+        << std::setw(12) << "p50 ms" << std::setw(12) << "p99 ms" << std::setw(14) << "switch ns" << std::endl;
+    for (const auto& p : points) {
+        double change = direct.point.throughput > 0.0
+                            ? 100.0 * (p.point.throughput / direct.point.throughput - 1.0)
+                            : 0.0;
+        out << std::setw(7) << (p.jobs == 0 ? std::string("direct") : std::to_string(p.jobs)) << std::fixed
+            << std::setprecision(1) << std::setw(14) << p.point.throughput << std::showpos << std::setw(10) << change
+            << "%" << std::noshowpos << std::setprecision(3) << std::setw(12) << nsToMs(static_cast<uint64_t>(p.mean_ns)) << std::setw(12)
+            << nsToMs(p.point.p50_ns) << std::setw(12) << nsToMs(p.point.p99_ns) << std::setprecision(1)
+            << std::setw(14);
+        if (p.jobs == 0) {
+            out << "-";
+        } else {
+            out << p.round_trip_ns - direct.round_trip_ns;
+        }
+        if (p.point.failures > 0) {
+            out << "  (" << p.point.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "Throughput in " << config.rate_label << " at " << config.num_threads
+        << " worker(s); latency is one resume of one job. switch ns: extra" << std::endl
+        << "mean time of an empty operation run through the jobs, i.e. one fiber switch in and back out." << std::endl;
+}
+
+std::vector<double> rateSweepFractions() {
+    return {0.1, 0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1};
+}
+
+void printRateTable(std::ostream& out, const RunConfig& config, const std::vector<RatePoint>& points) {
+    if (points.empty()) {
+        return;
+    }
+    out << std::endl;
+    out << "  Load" << std::setw(14) << "offered" << std::setw(14) << "achieved" << std::setw(12) << "p50 ms"
+        << std::setw(12) << "p99 ms" << std::setw(12) << "p99.9 ms" << std::setw(14) << "service p50" << std::endl;
+    for (const auto& p : points) {
+        out << std::setw(5) << static_cast<int>(p.fraction * 100.0 + 0.5) << "%" << std::fixed
+            << std::setprecision(1) << std::setw(14) << p.offered_rate << std::setw(14) << p.achieved_rate
+            << std::setprecision(3) << std::setw(12) << nsToMs(p.p50_ns) << std::setw(12) << nsToMs(p.p99_ns)
+            << std::setw(12) << nsToMs(p.p999_ns) << std::setw(14) << nsToMs(p.service_p50_ns);
+        if (p.achieved_rate < 0.95 * p.offered_rate) {
+            out << "  saturated";
+        }
+        if (p.failures > 0) {
+            out << "  (" << p.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "Rates in " << config.rate_label << "; latency in ms from each operation's intended start, so time"
+        << std::endl
+        << "spent queued behind a slow operation counts. service p50 is the time inside the operation." << std::endl
+        << "Saturated steps could not keep up (achieved < 95% of offered); their latency grows with run length."
+        << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,273 @@
+#ifndef BENCH_SCALING_H
+#define BENCH_SCALING_H
+
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "cpu_info.h"
+#include "engine.h"
+#include "results.h"
+
+namespace bench {
+
+struct ScalingPoint {
+    int threads = 0;
+    double throughput = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+    // Filled in by analyseScaling()
+    double speedup = 0.0;         // throughput over the single-thread rate
+    double efficiency = 0.0;      // speedup / threads
+    double serial_fraction = 0.0; // Karp-Flatt metric; NaN at one thread
+};
+
+// 1, 2, 4, ... up to and including max_threads, plus the physical core and
+// logical CPU counts the process may use (affinity mask and cgroup quota
+// applied) where they fall below max_threads, so the sweep lands exactly on
+// the points where SMT and oversubscription start.
+std::vector<int> scalingSteps(int max_threads);
+
+ScalingPoint scalingPoint(int threads, const RunResult& result);
+
+// Repeat the same run at each thread count in `steps` (loops per thread
+// stay fixed), printing one progress line per step. Given a `workload`
+// name, each step is also saved to base.results_output.
+template <typename OpFactory>
+std::vector<ScalingPoint> runScaling(const RunConfig& base, const std::vector<int>& steps, OpFactory make_op,
+                                     const std::string& workload = std::string()) {
+    std::vector<ScalingPoint> points;
+    for (int threads : steps) {
+        RunConfig config = base;
+        config.num_threads = threads;
+        config.live_stats = false;
+        std::cout << "  " << threads << " thread(s)..." << std::flush;
+        RunResult result = run(config, make_op);
+        ScalingPoint point = scalingPoint(threads, result);
+        points.push_back(point);
+        if (!workload.empty()) {
+            saveResult(config, workload, result);
+        }
+        std::cout << " " << static_cast<uint64_t>(point.throughput) << " " << config.rate_label << std::endl;
+    }
+    return points;
+}
+
+// Fill in speedup, efficiency and the per-step Karp-Flatt serial fraction,
+// relative to the first (single-thread) point, and return the serial
+// fraction s of Amdahl's law, speedup(n) = 1 / (s + (1 - s) / n), fitted to
+// all points by least squares.
+double analyseScaling(std::vector<ScalingPoint>& points);
+
+// Throughput, per-thread throughput, speedup, efficiency and serial fraction
+// per step, followed by the fitted serial fraction.
+void printScalingTable(std::ostream& out, const RunConfig& config, const std::vector<ScalingPoint>& points,
+                       double fitted_serial_fraction);
+
+// Write the sweep as CSV, or as JSON if `path` ends in ".json", with the
+// CPU model and core counts so results from different machines can be
+// charted together.
+bool writeSweepResults(const std::string& path, const std::string& workload, const RunConfig& config,
+                       const std::vector<ScalingPoint>& points, double fitted_serial_fraction, std::string& error);
+
+// --sweep: run `make_op` at every step up to config.num_threads, print the
+// scaling table and write config.sweep_output if set. `workload` names the
+// benchmark in the machine-readable output, e.g. "ecdsa_signer sign P256".
+template <typename OpFactory>
+std::vector<ScalingPoint> runSweep(std::ostream& out, const RunConfig& config, const std::string& workload,
+                                   OpFactory make_op) {
+    out << "Thread sweep (";
+    printTopologySummary(out, cpuTopology());
+    if (config.placement != Placement::None) {
+        out << "; pinned " << placementName(config.placement);
+    }
+    out << "):" << std::endl;
+    std::vector<ScalingPoint> points = runScaling(config, scalingSteps(config.num_threads), make_op, workload);
+    double fitted = analyseScaling(points);
+    printScalingTable(out, config, points, fitted);
+    if (!config.sweep_output.empty()) {
+        std::string error;
+        if (writeSweepResults(config.sweep_output, workload, config, points, fitted, error)) {
+            out << "Sweep results written to " << config.sweep_output << std::endl;
+        } else {
+            std::cerr << "Error: " << error << std::endl;
+        }
+    }
+    return points;
+}
+
+// The same benchmark in a baseline and a variant configuration at one thread count.
+struct PairedScalingPoint {
+    ScalingPoint baseline;
+    ScalingPoint variant;
+};
+
+// At each thread count in `steps`, run the baseline and then the variant.
+// The two may differ in their RunConfig (e.g. libctx_mode), their op
+// factory, or both.
+template <typename BaselineFactory, typename VariantFactory>
+std::vector<PairedScalingPoint> runPairedScaling(const RunConfig& baseline, const RunConfig& variant,
+                                                 const std::vector<int>& steps, BaselineFactory make_baseline,
+                                                 VariantFactory make_variant) {
+    std::vector<PairedScalingPoint> points;
+    for (int threads : steps) {
+        RunConfig baseline_config = baseline;
+        RunConfig variant_config = variant;
+        baseline_config.num_threads = variant_config.num_threads = threads;
+        baseline_config.live_stats = variant_config.live_stats = false;
+        std::cout << "  " << threads << " thread(s)..." << std::flush;
+
+        PairedScalingPoint point;
+        point.baseline = scalingPoint(threads, run(baseline_config, make_baseline));
+        point.variant = scalingPoint(threads, run(variant_config, make_variant));
+        points.push_back(point);
+        std::cout << " " << static_cast<uint64_t>(point.baseline.throughput) << " vs "
+                  << static_cast<uint64_t>(point.variant.throughput) << " " << baseline.rate_label << std::endl;
+    }
+    return points;
+}
+
+// Throughput in both configurations, the variant's gain, and each one's
+// speedup over its own single-thread rate.
+void printPairedScalingTable(std::ostream& out, const RunConfig& config, const char* baseline_label,
+                             const char* variant_label, const std::vector<PairedScalingPoint>& points);
+
+// --libctx compare: the same workload with a shared and with per-worker
+// library contexts at 1, 2, 4, ... num_threads.
+template <typename OpFactory>
+void compareLibraryContexts(std::ostream& out, const RunConfig& base, OpFactory make_op) {
+    RunConfig shared = base;
+    RunConfig isolated = base;
+    shared.libctx_mode = LibCtxMode::Shared;
+    isolated.libctx_mode = LibCtxMode::Isolated;
+    out << "Library context, shared vs isolated:" << std::endl;
+    std::vector<PairedScalingPoint> points =
+        runPairedScaling(shared, isolated, scalingSteps(base.num_threads), make_op, make_op);
+    printPairedScalingTable(out, base, "shared", "isolated", points);
+}
+
+// One step of an --async-sweep.
+struct AsyncPoint {
+    int jobs = 0;                  // 0: operations called directly
+    ScalingPoint point;
+    double mean_ns = 0.0;          // mean latency of one operation (one resume)
+    double round_trip_ns = 0.0;    // mean latency of an empty operation at the same setting
+};
+
+// An empty operation through the same path as `config` (direct or async),
+// with enough iterations for a stable mean; the difference between the
+// async and direct values is the fiber round trip.
+double emptyOperationMeanNs(const RunConfig& config);
+
+// Throughput, latency and per-operation overhead against direct calls for
+// each number of jobs, with the fiber round trip measured on an empty
+// operation.
+void printAsyncTable(std::ostream& out, const RunConfig& config, const std::vector<AsyncPoint>& points);
+
+// --async-sweep: the workload called directly and then through 1, 2, 4,
+// ... K ASYNC_JOBs per worker, at base.num_threads workers.
+template <typename OpFactory>
+std::vector<AsyncPoint> compareAsyncJobs(std::ostream& out, const RunConfig& base, const std::string& workload,
+                                         OpFactory make_op) {
+    int max_jobs = base.async_jobs > 0 ? base.async_jobs : 16;
+    std::vector<int> steps = {0};
+    for (int jobs = 1; jobs < max_jobs; jobs *= 2) {
+        steps.push_back(jobs);
+    }
+    steps.push_back(max_jobs);
+
+    out << "Async jobs per worker (" << base.num_threads << " worker" << (base.num_threads == 1 ? "" : "s")
+        << "):" << std::endl;
+    std::vector<AsyncPoint> points;
+    for (int jobs : steps) {
+        RunConfig config = base;
+        config.async_jobs = jobs;
+        config.live_stats = false;
+        out << "  " << (jobs == 0 ? std::string("direct") : std::to_string(jobs) + " job(s)") << "..." << std::flush;
+        RunResult result = run(config, make_op);
+        AsyncPoint point;
+        point.jobs = jobs;
+        point.point = scalingPoint(config.num_threads, result);
+        point.mean_ns = result.latency->mean();
+        point.round_trip_ns = emptyOperationMeanNs(config);
+        points.push_back(point);
+        saveResult(config, jobs == 0 ? workload : workload + " async-" + std::to_string(jobs), result);
+        out << " " << static_cast<uint64_t>(point.point.throughput) << " " << config.rate_label << std::endl;
+    }
+    printAsyncTable(out, base, points);
+    return points;
+}
+
+// One offered rate of a --rate-sweep.
+struct RatePoint {
+    double fraction = 0.0;        // of the sweep's top rate
+    double target_rate = 0.0;
+    double offered_rate = 0.0;    // as generated; differs from the target with short Poisson runs
+    double achieved_rate = 0.0;
+    uint64_t p50_ns = 0;          // from the intended start time
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t service_p50_ns = 0;  // inside the operation
+    uint64_t failures = 0;
+};
+
+// Fractions of the top rate a --rate-sweep offers, past saturation.
+std::vector<double> rateSweepFractions();
+
+// Offered against achieved rate, corrected latency and service time at each
+// step, with saturated steps marked.
+void printRateTable(std::ostream& out, const RunConfig& config, const std::vector<RatePoint>& points);
+
+// --rate-sweep: open-loop runs at each of rateSweepFractions() of
+// base.target_rate or, without --rate, of the closed-loop throughput
+// measured first, giving latency against throughput up to saturation. Each
+// step is saved as `workload` + " open-loop NN%".
+template <typename OpFactory>
+std::vector<RatePoint> runRateSweep(std::ostream& out, const RunConfig& base, const std::string& workload,
+                                    OpFactory make_op) {
+    RunConfig config = base;
+    config.live_stats = false;
+    double top_rate = base.target_rate;
+    out << "Open-loop rate sweep (" << base.num_threads << " worker" << (base.num_threads == 1 ? "" : "s") << ", "
+        << arrivalsName(base.arrivals) << " arrivals):" << std::endl;
+    if (top_rate <= 0.0) {
+        config.target_rate = 0.0;
+        out << "  closed loop..." << std::flush;
+        top_rate = run(config, make_op).throughput();
+        out << " " << static_cast<uint64_t>(top_rate) << " " << config.rate_label << std::endl;
+        if (top_rate <= 0.0) {
+            std::cerr << "Error: the closed-loop run completed no operations" << std::endl;
+            return std::vector<RatePoint>();
+        }
+    }
+
+    std::vector<RatePoint> points;
+    for (double fraction : rateSweepFractions()) {
+        config.target_rate = top_rate * fraction;
+        out << "  " << static_cast<uint64_t>(config.target_rate) << " " << config.rate_label << " offered..."
+            << std::flush;
+        RunResult result = run(config, make_op);
+        RatePoint point;
+        point.fraction = fraction;
+        point.target_rate = config.target_rate;
+        point.offered_rate = result.offeredRate();
+        point.achieved_rate = result.achievedRate();
+        point.p50_ns = result.latency->valueAtPercentile(50.0);
+        point.p99_ns = result.latency->valueAtPercentile(99.0);
+        point.p999_ns = result.latency->valueAtPercentile(99.9);
+        point.service_p50_ns = result.service ? result.service->valueAtPercentile(50.0) : 0;
+        point.failures = result.failures;
+        points.push_back(point);
+        saveResult(config, workload + " open-loop " + std::to_string(static_cast<int>(fraction * 100.0 + 0.5)) + "%",
+                   result);
+        out << " " << static_cast<uint64_t>(point.achieved_rate) << " achieved" << std::endl;
+    }
+    printRateTable(out, base, points);
+    return points;
+}
+
+} // namespace bench
+
+#endif // BENCH_SCALING_H
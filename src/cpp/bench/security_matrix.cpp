@@ -0,0 +1,273 @@
+#include "security_matrix.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <openssl/ec.h>
+
+#include "keys.h"
+#include "library_context.h"
+#include "operations.h"
+#include "report.h"
+#include "results.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+namespace {
+
+const size_t kMessageSize = 32;
+// Signatures made up front for the verify runs; kept small because
+// RSA-15360 takes a large fraction of a second per signature
+const size_t kVerifyCorpus = 8;
+
+SignatureParams matrixParams(const MatrixAlgorithm& algorithm) {
+    if (algorithm.rsa_bits > 0) {
+        return SignatureParams::rsaPSS();
+    }
+    SignatureParams params;
+    params.one_shot = isEdDSA(*algorithm.curve);
+    return params;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+bool anySetupFailed(const RunResult& result) {
+    for (const auto& t : result.threads) {
+        if (t.setup_failed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// One engine run for one cell of the matrix, saved and summarised
+template <typename OpFactory>
+RunResult runCell(std::ostream& out, const RunConfig& base, const std::string& op, const MatrixAlgorithm& algorithm,
+                  uint64_t loops, const char* rate_label, OpFactory make_op) {
+    RunConfig config = base;
+    config.loops_per_thread = loops;
+    config.rate_label = rate_label;
+    out << "  " << algorithm.name << " " << op << "..." << std::flush;
+    RunResult result = run(config, make_op);
+    out << " " << std::fixed << std::setprecision(1) << result.throughput() << " " << rate_label << std::endl;
+    Settings settings;
+    settings.push_back(std::make_pair("security_bits", std::to_string(algorithm.security_bits)));
+    saveResult(config, "crypto_benchmark " + op + " " + algorithm.name, result, settings);
+    return result;
+}
+
+} // namespace
+
+int rsaSecurityBits(int bits) {
+    if (bits >= 15360) {
+        return 256;
+    }
+    if (bits >= 7680) {
+        return 192;
+    }
+    if (bits >= 3072) {
+        return 128;
+    }
+    if (bits >= 2048) {
+        return 112;
+    }
+    return bits >= 1024 ? 80 : 0;
+}
+
+int curveSecurityBits(const CurveInfo& curve) {
+    switch (curve.pkey_id) {
+    case EVP_PKEY_ED25519:
+        return 128;
+    case EVP_PKEY_ED448:
+        return 224;
+    default:
+        break;
+    }
+    switch (curve.nid) {
+    case NID_X9_62_prime256v1:
+        return 128;
+    case NID_secp384r1:
+        return 192;
+    case NID_secp521r1:
+        return 256;
+    default:
+        return 0;
+    }
+}
+
+bool parseMatrixAlgorithms(const std::string& rsa_sizes, const std::string& curves,
+                           std::vector<MatrixAlgorithm>& algorithms, std::string& error) {
+    algorithms.clear();
+    for (const std::string& size : splitList(rsa_sizes)) {
+        int bits = std::atoi(size.c_str());
+        if (size.find_first_not_of("0123456789") != std::string::npos || bits < 1024 || bits > 16384) {
+            error = "RSA size '" + size + "' must be between 1024 and 16384";
+            return false;
+        }
+        MatrixAlgorithm algorithm;
+        algorithm.name = "RSA-" + std::to_string(bits);
+        algorithm.rsa_bits = bits;
+        algorithm.security_bits = rsaSecurityBits(bits);
+        algorithms.push_back(algorithm);
+    }
+    for (const std::string& name : splitList(curves)) {
+        const CurveInfo* curve = findCurve(signatureCurves(), name);
+        if (!curve) {
+            error = "unknown curve '" + name + "' (P256, P384, P521, Ed25519, Ed448)";
+            return false;
+        }
+        MatrixAlgorithm algorithm;
+        algorithm.name = isEdDSA(*curve) ? std::string(curve->name) : std::string("ECDSA ") + curve->name;
+        algorithm.curve = curve;
+        algorithm.security_bits = curveSecurityBits(*curve);
+        algorithms.push_back(algorithm);
+    }
+    if (algorithms.empty()) {
+        error = "no RSA sizes or curves to measure";
+        return false;
+    }
+    return true;
+}
+
+std::vector<MatrixRow> runSecurityMatrix(std::ostream& out, const RunConfig& base,
+                                         const std::vector<MatrixAlgorithm>& algorithms, uint64_t loops,
+                                         uint64_t keygen_loops) {
+    RunConfig config = base;
+    config.live_stats = false;
+    std::vector<MatrixRow> rows;
+    for (const MatrixAlgorithm& algorithm : algorithms) {
+        MatrixRow row;
+        row.algorithm = algorithm;
+        SignatureParams params = matrixParams(algorithm);
+
+        RunResult keygen = runCell(out, config, "keygen", algorithm, keygen_loops, "keys/s",
+                                   [&algorithm](int) {
+            LibraryContext* ctx = threadLibraryContext();
+            OSSL_LIB_CTX* libctx = ctx ? ctx->get() : nullptr;
+            EVP_PKEY_CTX* pctx = algorithm.rsa_bits > 0 ? newRSAKeygenContext(algorithm.rsa_bits, libctx)
+                                                        : newCurveKeygenContext(*algorithm.curve, libctx);
+            if (!pctx) {
+                return std::unique_ptr<KeygenOperation>();
+            }
+            return std::unique_ptr<KeygenOperation>(new KeygenOperation(pctx, algorithm.name));
+        });
+        row.keygen_rate = keygen.throughput();
+        row.keygen_p50_ns = keygen.latency->valueAtPercentile(50.0);
+        row.failures += keygen.failures;
+        row.setup_failed = anySetupFailed(keygen);
+
+        EVP_PKEY* key = algorithm.rsa_bits > 0 ? generateRSAKey(algorithm.rsa_bits)
+                                               : generateCurveKey(*algorithm.curve);
+        SignatureCorpus corpus;
+        if (!key || !corpus.build(key, params, kVerifyCorpus, kMessageSize)) {
+            out << "  " << algorithm.name << ": failed to make the signing key" << std::endl;
+            EVP_PKEY_free(key);
+            row.setup_failed = true;
+            rows.push_back(row);
+            continue;
+        }
+
+        RunResult sign = runCell(out, config, "sign", algorithm, loops, "sigs/s",
+                                 [key, &params](int) {
+            EVP_PKEY* copy = copyKeyForThread(key);
+            std::unique_ptr<SignOperation> op;
+            if (copy) {
+                op.reset(new SignOperation(copy, params, kMessageSize));
+            }
+            if (op && !op->valid()) {
+                op.reset();
+            }
+            return op;
+        });
+        row.sign_rate = sign.throughput();
+        row.sign_p50_ns = sign.latency->valueAtPercentile(50.0);
+        row.failures += sign.failures;
+        row.setup_failed = row.setup_failed || anySetupFailed(sign);
+
+        RunResult verify = runCell(out, config, "verify", algorithm, loops, "verifies/s",
+                                   [key, &params, &corpus](int thread_index) {
+            EVP_PKEY* copy = copyKeyForThread(key);
+            std::unique_ptr<VerifyOperation> op;
+            if (copy) {
+                op.reset(new VerifyOperation(copy, params, corpus, static_cast<size_t>(thread_index) % corpus.size()));
+            }
+            if (op && !op->valid()) {
+                op.reset();
+            }
+            return op;
+        });
+        row.verify_rate = verify.throughput();
+        row.verify_p50_ns = verify.latency->valueAtPercentile(50.0);
+        row.failures += verify.failures;
+        row.setup_failed = row.setup_failed || anySetupFailed(verify);
+
+        EVP_PKEY_free(key);
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+void printSecurityMatrix(std::ostream& out, const RunConfig& config, const std::vector<MatrixRow>& rows) {
+    // Fastest sign and verify at each strength, for the relative columns
+    std::map<int, std::pair<double, double>> best;
+    size_t name_width = 9;
+    for (const auto& row : rows) {
+        std::pair<double, double>& b = best[row.algorithm.security_bits];
+        b.first = std::max(b.first, row.sign_rate);
+        b.second = std::max(b.second, row.verify_rate);
+        name_width = std::max(name_width, row.algorithm.name.size());
+    }
+    name_width += 2;
+
+    out << std::endl;
+    out << "Throughput by security strength (" << config.num_threads << " thread"
+        << (config.num_threads == 1 ? "" : "s") << ", totals across threads; p50 per operation):" << std::endl;
+    out << std::left << std::setw(10) << "Strength" << std::setw(name_width) << "Algorithm" << std::right
+        << std::setw(11) << "keys/s" << std::setw(12) << "keygen ms" << std::setw(12) << "sigs/s"
+        << std::setw(10) << "sign ms" << std::setw(8) << "rel" << std::setw(13) << "verifies/s"
+        << std::setw(11) << "verify ms" << std::setw(8) << "rel" << std::endl;
+    for (const auto& level : best) {
+        bool first = true;
+        for (const auto& row : rows) {
+            if (row.algorithm.security_bits != level.first) {
+                continue;
+            }
+            std::string strength = first ? std::to_string(level.first) + "-bit" : std::string();
+            first = false;
+            out << std::left << std::setw(10) << strength << std::setw(name_width) << row.algorithm.name
+                << std::right << std::fixed << std::setprecision(1) << std::setw(11) << row.keygen_rate
+                << std::setprecision(3) << std::setw(12) << nsToMs(row.keygen_p50_ns) << std::setprecision(1)
+                << std::setw(12) << row.sign_rate << std::setprecision(3) << std::setw(10) << nsToMs(row.sign_p50_ns)
+                << std::setprecision(2) << std::setw(8)
+                << (level.second.first > 0.0 ? row.sign_rate / level.second.first : 0.0) << std::setprecision(1)
+                << std::setw(13) << row.verify_rate << std::setprecision(3) << std::setw(11)
+                << nsToMs(row.verify_p50_ns) << std::setprecision(2) << std::setw(8)
+                << (level.second.second > 0.0 ? row.verify_rate / level.second.second : 0.0);
+            if (row.setup_failed) {
+                out << "  (setup failed)";
+            } else if (row.failures > 0) {
+                out << "  (" << row.failures << " failures)";
+            }
+            out << std::endl;
+        }
+    }
+    out << "rel: sign or verify rate relative to the fastest algorithm at the same strength." << std::endl;
+    out << "Strengths per NIST SP 800-57 Part 1; RSA sizes between the listed ones count at the level below."
+        << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,69 @@
+#ifndef BENCH_SECURITY_MATRIX_H
+#define BENCH_SECURITY_MATRIX_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "curves.h"
+#include "engine.h"
+
+namespace bench {
+
+// crypto_benchmark --matrix: keygen, sign and verify for several RSA sizes
+// and curves on the same number of threads, tabulated by the security
+// strength each one provides, so algorithms that protect equally well are
+// compared with each other.
+
+// Comparable strength in bits per NIST SP 800-57 Part 1, Table 2: RSA-2048
+// 112, RSA-3072 128, RSA-7680 192, RSA-15360 256; sizes in between count
+// at the level below. 0 below RSA-1024.
+int rsaSecurityBits(int bits);
+
+// P-256 128, P-384 192, P-521 256, Ed25519 128, Ed448 224.
+int curveSecurityBits(const CurveInfo& curve);
+
+// One algorithm in the matrix: RSA-PSS with SHA-256 at `rsa_bits`, or
+// ECDSA with SHA-256 / EdDSA on `curve`.
+struct MatrixAlgorithm {
+    std::string name;
+    int rsa_bits = 0;
+    const CurveInfo* curve = nullptr;
+    int security_bits = 0;
+};
+
+// Comma-separated RSA sizes and curve names. False with `error` set on an
+// unknown curve or a size outside 1024..16384.
+bool parseMatrixAlgorithms(const std::string& rsa_sizes, const std::string& curves,
+                           std::vector<MatrixAlgorithm>& algorithms, std::string& error);
+
+struct MatrixRow {
+    MatrixAlgorithm algorithm;
+    double keygen_rate = 0.0; // keys/s across all threads
+    double sign_rate = 0.0;
+    double verify_rate = 0.0;
+    uint64_t keygen_p50_ns = 0;
+    uint64_t sign_p50_ns = 0;
+    uint64_t verify_p50_ns = 0;
+    uint64_t failures = 0;
+    bool setup_failed = false;
+};
+
+// Measure every algorithm in turn on config.num_threads workers:
+// `keygen_loops` keys and `loops` signatures and verifications per
+// thread, each its own engine run. Signing and verification use one key
+// made up front, copied per worker; verification cycles through a small
+// set of pre-made signatures. Progress goes to `out`, and each run is
+// saved through saveResult() under "crypto_benchmark <op> <algorithm>".
+std::vector<MatrixRow> runSecurityMatrix(std::ostream& out, const RunConfig& config,
+                                         const std::vector<MatrixAlgorithm>& algorithms, uint64_t loops,
+                                         uint64_t keygen_loops);
+
+// Rows grouped by security strength, weakest first, with each row's sign
+// and verify rate relative to the fastest algorithm at its strength.
+void printSecurityMatrix(std::ostream& out, const RunConfig& config, const std::vector<MatrixRow>& rows);
+
+} // namespace bench
+
+#endif // BENCH_SECURITY_MATRIX_H
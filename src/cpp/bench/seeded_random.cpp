@@ -0,0 +1,114 @@
+// RAND_METHOD is deprecated in 3.0, but it is the only way to replace the
+// randomness of every library context at once
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include "seeded_random.h"
+
+#include <atomic>
+#include <cstring>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+namespace bench {
+
+namespace {
+
+// Threads that were never reset get streams numbered from here up
+const int kUnassignedStreamBase = 1 << 20;
+
+std::atomic<bool> installed(false);
+uint64_t master_seed = 0;
+std::atomic<int> next_unassigned(0);
+
+class SeededStream {
+public:
+    SeededStream() : ctx_(nullptr) {}
+
+    ~SeededStream() {
+        EVP_CIPHER_CTX_free(ctx_);
+    }
+
+    SeededStream(const SeededStream&) = delete;
+    SeededStream& operator=(const SeededStream&) = delete;
+
+    bool ready() const { return ctx_ != nullptr; }
+
+    bool reset(uint64_t seed, int stream) {
+        static const char kLabel[] = "crypto-bench seeded random";
+        unsigned char material[sizeof(kLabel) + 12];
+        std::memcpy(material, kLabel, sizeof(kLabel));
+        for (int i = 0; i < 8; i++) {
+            material[sizeof(kLabel) + i] = static_cast<unsigned char>(seed >> (56 - 8 * i));
+        }
+        for (int i = 0; i < 4; i++) {
+            material[sizeof(kLabel) + 8 + i] = static_cast<unsigned char>(static_cast<uint32_t>(stream) >> (24 - 8 * i));
+        }
+        unsigned char key[32];
+        unsigned char iv[16] = {0};
+        if (!ctx_) {
+            ctx_ = EVP_CIPHER_CTX_new();
+        }
+        return ctx_ && EVP_Digest(material, sizeof(material), key, nullptr, EVP_sha256(), nullptr) &&
+               EVP_EncryptInit_ex(ctx_, EVP_aes_256_ctr(), nullptr, key, iv);
+    }
+
+    // The keystream: the encryption of zeros
+    bool bytes(unsigned char* out, int num) {
+        int written = 0;
+        std::memset(out, 0, static_cast<size_t>(num));
+        return EVP_EncryptUpdate(ctx_, out, &written, out, num) && written == num;
+    }
+
+private:
+    EVP_CIPHER_CTX* ctx_;
+};
+
+thread_local SeededStream thread_stream;
+
+int seededBytes(unsigned char* buf, int num) {
+    if (num <= 0) {
+        return 1;
+    }
+    if (!thread_stream.ready() && !thread_stream.reset(master_seed, kUnassignedStreamBase + next_unassigned++)) {
+        return 0;
+    }
+    return thread_stream.bytes(buf, num) ? 1 : 0;
+}
+
+// Seeding input is ignored: the stream depends on the seed alone
+int seededSeed(const void*, int) {
+    return 1;
+}
+
+int seededAdd(const void*, int, double) {
+    return 1;
+}
+
+int seededStatus() {
+    return 1;
+}
+
+const RAND_METHOD seeded_method = {seededSeed, seededBytes, nullptr, seededAdd, seededBytes, seededStatus};
+
+} // namespace
+
+bool installSeededRandom(uint64_t seed) {
+    master_seed = seed;
+    if (RAND_set_rand_method(&seeded_method) != 1) {
+        return false;
+    }
+    installed.store(true);
+    return true;
+}
+
+bool seededRandomInstalled() {
+    return installed.load();
+}
+
+void seedThreadRandom(int stream) {
+    if (installed.load(std::memory_order_relaxed)) {
+        thread_stream.reset(master_seed, stream);
+    }
+}
+
+} // namespace bench
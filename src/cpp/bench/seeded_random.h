@@ -0,0 +1,42 @@
+#ifndef BENCH_SEEDED_RANDOM_H
+#define BENCH_SEEDED_RANDOM_H
+
+#include <cstdint>
+
+namespace bench {
+
+// Deterministic randomness for reproducible timings. INSECURE: every key,
+// nonce and blinding value becomes predictable from the seed. Benchmarking
+// only.
+//
+// RSA keygen time depends on how many candidates the prime search tries,
+// so two runs can differ by 2x at small key counts. With a fixed seed every
+// run tries the same candidates, and a difference between two OpenSSL
+// builds reflects the implementation rather than luck.
+//
+// installSeededRandom() replaces OpenSSL's randomness process-wide with a
+// RAND_METHOD. That is the one hook in OpenSSL 3.0 that covers RAND_bytes
+// and RAND_priv_bytes in every library context, including the calls the
+// providers make for prime candidates, Miller-Rabin witnesses, ECDSA nonces
+// and RSA blinding. Each thread draws from its own stream: AES-256-CTR
+// keyed with SHA-256(seed, stream number). Engine workers are reset to
+// stream = thread index when a run starts, so every run in a process starts
+// from the same point. Other threads, such as the main thread, get a stream
+// numbered by the order in which they first ask for random bytes, which is
+// only reproducible when they start one at a time. Modes that run their own
+// concurrent threads outside the engine, such as rsa_generator --single-key
+// and --pool, reject --seed for that reason.
+
+// Install once, before any random bytes are drawn. Returns false if
+// OpenSSL refused the method.
+bool installSeededRandom(uint64_t seed);
+
+bool seededRandomInstalled();
+
+// Restart the calling thread's stream as stream number `stream`; does
+// nothing unless installSeededRandom() succeeded.
+void seedThreadRandom(int stream);
+
+} // namespace bench
+
+#endif // BENCH_SEEDED_RANDOM_H
@@ -0,0 +1,623 @@
+#include "sign_service.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "library_context.h"
+#include "report.h"
+
+namespace bench {
+
+namespace {
+
+const size_t kRequestHeader = 8;
+const size_t kResponseHeader = 12;
+const size_t kReadChunk = 64 * 1024;
+const int kMaxEvents = 64;
+
+// epoll tags for the two non-connection descriptors; connections are
+// tagged with their id, which starts above these
+const uint64_t kListenTag = 0;
+const uint64_t kWakeTag = 1;
+
+void putU32(unsigned char* p, uint32_t value) {
+    p[0] = static_cast<unsigned char>(value);
+    p[1] = static_cast<unsigned char>(value >> 8);
+    p[2] = static_cast<unsigned char>(value >> 16);
+    p[3] = static_cast<unsigned char>(value >> 24);
+}
+
+uint32_t getU32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+bool socketAddress(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+bool writeAll(int fd, const unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAll(int fd, unsigned char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// State of one client connection. The epoll thread alone reads the socket
+// and writes it; workers only append responses to `out`.
+struct Connection {
+    Connection(uint64_t tag, int socket) : id(tag), fd(socket), wants_write(false) {}
+
+    uint64_t id;
+    int fd;           // -1 once closed
+    std::string in;   // bytes of requests not yet complete
+    bool wants_write; // registered for EPOLLOUT
+    std::mutex out_mutex;
+    std::string out;  // encoded responses not yet written
+};
+
+struct Request {
+    std::shared_ptr<Connection> connection;
+    uint32_t id = 0;
+    std::string message;
+    Clock::time_point queued;
+};
+
+// Requests waiting for a worker, handed out in micro-batches.
+class BatchQueue {
+public:
+    BatchQueue(int max_batch, uint64_t max_wait_us)
+        : max_batch_(static_cast<size_t>(std::max(1, max_batch))),
+          max_wait_(std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(max_wait_us))),
+          stopped_(false) {}
+
+    // Queue `requests`, leaving the vector empty.
+    void push(std::vector<Request>& requests) {
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // An idle worker is either asleep with nothing queued, or already
+            // timing the oldest request's wait; it needs a nudge only in the
+            // first case or once a full batch is ready
+            wake = queue_.empty();
+            for (auto& request : requests) {
+                queue_.push_back(std::move(request));
+            }
+            wake = wake || queue_.size() >= max_batch_;
+        }
+        requests.clear();
+        if (wake) {
+            ready_.notify_one();
+        }
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        ready_.notify_all();
+    }
+
+    // Wait until max_batch requests are queued or the oldest has waited
+    // max_wait, then move up to max_batch of them into `batch`. False once
+    // stopped.
+    bool pop(std::vector<Request>& batch) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            if (stopped_) {
+                return false;
+            }
+            if (queue_.size() >= max_batch_) {
+                break;
+            }
+            if (queue_.empty()) {
+                ready_.wait(lock);
+                continue;
+            }
+            Clock::time_point deadline = queue_.front().queued + max_wait_;
+            if (Clock::now() >= deadline) {
+                break;
+            }
+            ready_.wait_until(lock, deadline);
+        }
+        size_t count = std::min(max_batch_, queue_.size());
+        for (size_t i = 0; i < count; i++) {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        bool more = !queue_.empty();
+        lock.unlock();
+        // Let another idle worker start timing what is left
+        if (more) {
+            ready_.notify_one();
+        }
+        return true;
+    }
+
+private:
+    size_t max_batch_;
+    Clock::duration max_wait_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Request> queue_;
+    bool stopped_;
+};
+
+} // namespace
+
+struct SignServer::Impl {
+    Impl(const ServiceConfig& service_config, EVP_PKEY* server_key, const SignatureParams& signature_params)
+        : config(service_config), key(server_key), params(signature_params),
+          queue(service_config.max_batch, service_config.max_wait_us), listen_fd(-1), epoll_fd(-1), wake_fd(-1),
+          next_id(kWakeTag + 1), started(false), stopping(false), requests(0), failures(0), batches(0),
+          queue_ns(0), sign_ns(0) {}
+
+    ServiceConfig config;
+    EVP_PKEY* key;
+    SignatureParams params;
+    BatchQueue queue;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;
+    uint64_t next_id;
+    std::map<uint64_t, std::shared_ptr<Connection>> connections; // epoll thread only
+    std::thread io_thread;
+    std::vector<std::thread> workers;
+    bool started;
+    std::atomic<bool> stopping;
+
+    // Connections with responses to write, handed from workers to the epoll thread
+    std::mutex pending_mutex;
+    std::vector<std::shared_ptr<Connection>> pending;
+
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> failures;
+    std::atomic<uint64_t> batches;
+    std::atomic<uint64_t> queue_ns;
+    std::atomic<uint64_t> sign_ns;
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void watch(Connection& connection, bool want_write) {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = want_write ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        ev.data.u64 = connection.id;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &ev);
+        connection.wants_write = want_write;
+    }
+
+    void close(Connection& connection) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        connection.fd = -1;
+        connections.erase(connection.id);
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            std::shared_ptr<Connection> connection(new Connection(next_id++, fd));
+            epoll_event ev;
+            std::memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.u64 = connection->id;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                ::close(fd);
+                continue;
+            }
+            connections[connection->id] = connection;
+        }
+    }
+
+    // Read what the socket has and queue every complete request. False if
+    // the peer closed the connection or broke the protocol.
+    bool readRequests(const std::shared_ptr<Connection>& connection) {
+        char buffer[kReadChunk];
+        bool open = true;
+        for (;;) {
+            ssize_t n = read(connection->fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection->in.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            open = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            break;
+        }
+
+        std::vector<Request> parsed;
+        Clock::time_point now = Clock::now();
+        const std::string& in = connection->in;
+        size_t pos = 0;
+        while (in.size() - pos >= kRequestHeader) {
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(in.data() + pos);
+            uint32_t length = getU32(header + 4);
+            if (length > kServiceMaxMessage) {
+                return false;
+            }
+            if (in.size() - pos < kRequestHeader + length) {
+                break;
+            }
+            Request request;
+            request.connection = connection;
+            request.id = getU32(header);
+            request.message.assign(in, pos + kRequestHeader, length);
+            request.queued = now;
+            parsed.push_back(std::move(request));
+            pos += kRequestHeader + length;
+        }
+        connection->in.erase(0, pos);
+        if (!parsed.empty()) {
+            queue.push(parsed);
+        }
+        return open;
+    }
+
+    // Write as much of the connection's responses as the socket takes, and
+    // ask for EPOLLOUT only while some are left over.
+    void flush(Connection& connection) {
+        bool left_over = false;
+        {
+            std::lock_guard<std::mutex> lock(connection.out_mutex);
+            size_t written = 0;
+            while (written < connection.out.size()) {
+                ssize_t n = send(connection.fd, connection.out.data() + written, connection.out.size() - written,
+                                 MSG_NOSIGNAL);
+                if (n > 0) {
+                    written += static_cast<size_t>(n);
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else {
+                    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                        // The peer is gone; EPOLLHUP/EPOLLIN will close the connection
+                        written = connection.out.size();
+                    }
+                    break;
+                }
+            }
+            connection.out.erase(0, written);
+            left_over = !connection.out.empty();
+        }
+        if (left_over != connection.wants_write) {
+            watch(connection, left_over);
+        }
+    }
+
+    void ioLoop() {
+        epoll_event events[kMaxEvents];
+        while (!stopping.load()) {
+            int count = epoll_wait(epoll_fd, events, kMaxEvents, -1);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                break;
+            }
+            for (int i = 0; i < count; i++) {
+                uint64_t tag = events[i].data.u64;
+                if (tag == kListenTag) {
+                    acceptAll();
+                    continue;
+                }
+                if (tag == kWakeTag) {
+                    uint64_t value = 0;
+                    ssize_t ignored = read(wake_fd, &value, sizeof(value));
+                    (void)ignored;
+                    std::vector<std::shared_ptr<Connection>> ready;
+                    {
+                        std::lock_guard<std::mutex> lock(pending_mutex);
+                        ready.swap(pending);
+                    }
+                    for (const auto& connection : ready) {
+                        if (connection->fd >= 0) {
+                            flush(*connection);
+                        }
+                    }
+                    continue;
+                }
+                auto it = connections.find(tag);
+                if (it == connections.end()) {
+                    continue;
+                }
+                std::shared_ptr<Connection> connection = it->second;
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readRequests(connection)) {
+                    close(*connection);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    flush(*connection);
+                }
+            }
+        }
+        while (!connections.empty()) {
+            close(*connections.begin()->second);
+        }
+    }
+
+    void workerLoop() {
+        EVP_PKEY* worker_key = copyKeyForThread(key);
+        EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+        std::vector<unsigned char> signature(worker_key ? EVP_PKEY_get_size(worker_key) : 0);
+        std::vector<Request> batch;
+        std::vector<Connection*> touched;
+        std::vector<std::shared_ptr<Connection>> touched_refs;
+        while (queue.pop(batch)) {
+            Clock::time_point taken = Clock::now();
+            uint64_t batch_failures = 0;
+            uint64_t batch_queue_ns = 0;
+            uint64_t batch_sign_ns = 0;
+            for (const auto& request : batch) {
+                batch_queue_ns += elapsedNs(request.queued, taken);
+                size_t signature_len = signature.size();
+                Clock::time_point start = Clock::now();
+                bool ok = worker_key && md_ctx &&
+                          digestSign(md_ctx, worker_key, params,
+                                     reinterpret_cast<const unsigned char*>(request.message.data()),
+                                     request.message.size(), signature.data(), &signature_len);
+                batch_sign_ns += elapsedNs(start, Clock::now());
+                if (!ok) {
+                    batch_failures++;
+                    signature_len = 0;
+                }
+
+                unsigned char header[kResponseHeader];
+                putU32(header, request.id);
+                putU32(header + 4, ok ? kServiceStatusOk : kServiceStatusFailed);
+                putU32(header + 8, static_cast<uint32_t>(signature_len));
+                Connection* connection = request.connection.get();
+                {
+                    std::lock_guard<std::mutex> lock(connection->out_mutex);
+                    connection->out.append(reinterpret_cast<const char*>(header), sizeof(header));
+                    connection->out.append(reinterpret_cast<const char*>(signature.data()), signature_len);
+                }
+                if (std::find(touched.begin(), touched.end(), connection) == touched.end()) {
+                    touched.push_back(connection);
+                    touched_refs.push_back(request.connection);
+                }
+            }
+
+            // One handoff and one wakeup for the whole batch
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                pending.insert(pending.end(), touched_refs.begin(), touched_refs.end());
+            }
+            wake();
+            requests.fetch_add(batch.size(), std::memory_order_relaxed);
+            failures.fetch_add(batch_failures, std::memory_order_relaxed);
+            batches.fetch_add(1, std::memory_order_relaxed);
+            queue_ns.fetch_add(batch_queue_ns, std::memory_order_relaxed);
+            sign_ns.fetch_add(batch_sign_ns, std::memory_order_relaxed);
+            batch.clear();
+            touched.clear();
+            touched_refs.clear();
+        }
+        EVP_MD_CTX_free(md_ctx);
+        EVP_PKEY_free(worker_key);
+    }
+};
+
+SignServer::SignServer(const ServiceConfig& config, EVP_PKEY* key, const SignatureParams& params)
+    : impl_(new Impl(config, key, params)) {}
+
+SignServer::~SignServer() {
+    stop();
+    EVP_PKEY_free(impl_->key);
+}
+
+bool SignServer::start(std::string& error) {
+    Impl& s = *impl_;
+    sockaddr_un addr;
+    if (!socketAddress(s.config.socket_path, addr)) {
+        error = "socket path '" + s.config.socket_path + "' is empty or too long";
+        return false;
+    }
+    // Replace a socket left behind by an earlier run, but nothing else
+    struct stat st;
+    if (lstat(s.config.socket_path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            error = s.config.socket_path + " exists and is not a socket";
+            return false;
+        }
+        unlink(s.config.socket_path.c_str());
+    }
+
+    s.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s.listen_fd < 0) {
+        error = systemError("socket");
+        return false;
+    }
+    if (bind(s.listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = systemError("bind " + s.config.socket_path);
+        return false;
+    }
+    if (listen(s.listen_fd, SOMAXCONN) != 0) {
+        error = systemError("listen");
+        return false;
+    }
+    s.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    s.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (s.epoll_fd < 0 || s.wake_fd < 0) {
+        error = systemError("epoll/eventfd");
+        return false;
+    }
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenTag;
+    epoll_ctl(s.epoll_fd, EPOLL_CTL_ADD, s.listen_fd, &ev);
+    ev.data.u64 = kWakeTag;
+    epoll_ctl(s.epoll_fd, EPOLL_CTL_ADD, s.wake_fd, &ev);
+
+    s.started = true;
+    s.io_thread = std::thread([&s]() { s.ioLoop(); });
+    for (int i = 0; i < s.config.workers; i++) {
+        s.workers.emplace_back([&s]() { s.workerLoop(); });
+    }
+    return true;
+}
+
+void SignServer::stop() {
+    Impl& s = *impl_;
+    if (s.started) {
+        s.stopping.store(true);
+        s.wake();
+        s.io_thread.join();
+        s.queue.stop();
+        for (auto& worker : s.workers) {
+            worker.join();
+        }
+        s.workers.clear();
+        s.started = false;
+        unlink(s.config.socket_path.c_str());
+    }
+    for (int* fd : {&s.listen_fd, &s.epoll_fd, &s.wake_fd}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+ServiceStats SignServer::stats() const {
+    ServiceStats stats;
+    stats.requests = impl_->requests.load();
+    stats.failures = impl_->failures.load();
+    stats.batches = impl_->batches.load();
+    stats.queue_ns = impl_->queue_ns.load();
+    stats.sign_ns = impl_->sign_ns.load();
+    return stats;
+}
+
+int connectService(const std::string& socket_path, std::string& error) {
+    sockaddr_un addr;
+    if (!socketAddress(socket_path, addr)) {
+        error = "socket path '" + socket_path + "' is empty or too long";
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = systemError("socket");
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = systemError("connect " + socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+ServiceRequestOperation::ServiceRequestOperation(int fd, size_t message_size)
+    : fd_(fd), next_id_(0), request_(kRequestHeader + message_size), response_(kResponseHeader),
+      gen_(std::random_device()()), dis_(0, 255) {
+    putU32(request_.data() + 4, static_cast<uint32_t>(message_size));
+}
+
+ServiceRequestOperation::~ServiceRequestOperation() {
+    close(fd_);
+}
+
+void ServiceRequestOperation::prepare() {
+    putU32(request_.data(), ++next_id_);
+    for (size_t i = kRequestHeader; i < request_.size(); i++) {
+        request_[i] = static_cast<unsigned char>(dis_(gen_));
+    }
+}
+
+bool ServiceRequestOperation::operator()() {
+    if (!writeAll(fd_, request_.data(), request_.size()) || !readAll(fd_, response_.data(), kResponseHeader)) {
+        return false;
+    }
+    uint32_t id = getU32(response_.data());
+    uint32_t status = getU32(response_.data() + 4);
+    uint32_t length = getU32(response_.data() + 8);
+    if (length > kServiceMaxMessage) {
+        return false;
+    }
+    response_.resize(kResponseHeader + length);
+    return readAll(fd_, response_.data() + kResponseHeader, length) && id == next_id_ &&
+           status == kServiceStatusOk && length > 0;
+}
+
+void printServiceTable(std::ostream& out, const RunConfig& config, const std::vector<ServicePoint>& points) {
+    out << std::endl;
+    out << " Batch" << std::setw(9) << "wait us" << std::setw(13) << "rate" << std::setw(10) << "p50 ms"
+        << std::setw(10) << "p99 ms" << std::setw(11) << "p99.9 ms" << std::setw(12) << "mean batch"
+        << std::setw(11) << "queue ms" << std::setw(10) << "sign ms" << std::endl;
+    for (const auto& p : points) {
+        out << std::setw(6) << p.max_batch << std::setw(9) << p.max_wait_us << std::fixed << std::setprecision(1)
+            << std::setw(13) << p.throughput << std::setprecision(3) << std::setw(10) << nsToMs(p.p50_ns)
+            << std::setw(10) << nsToMs(p.p99_ns) << std::setw(11) << nsToMs(p.p999_ns) << std::setprecision(2)
+            << std::setw(12) << p.server.meanBatch() << std::setprecision(3) << std::setw(11)
+            << nsToMs(static_cast<uint64_t>(p.server.meanQueueNs())) << std::setw(10)
+            << nsToMs(static_cast<uint64_t>(p.server.meanSignNs()));
+        uint64_t failures = p.client_failures + p.server.failures;
+        if (failures > 0) {
+            out << "  (" << failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "rate in " << config.rate_label << " and p50-p99.9 end to end at the clients; mean batch, queue and"
+        << std::endl
+        << "sign (mean per request) on the server side. What the clients saw beyond queue + sign is" << std::endl
+        << "the socket round trip and the epoll thread's handoffs." << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,126 @@
+#ifndef BENCH_SIGN_SERVICE_H
+#define BENCH_SIGN_SERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "engine.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+// A stand-in for a local signing daemon: a Unix domain socket server that
+// signs with the same EVP_DigestSign path as ecdsa_signer, so the cost of
+// IPC, queueing and batching can be measured against the bare signature.
+//
+// Wire format, all integers 32-bit little-endian:
+//   request:  id, message length, message bytes
+//   response: id, status (0 = signed), signature length, signature bytes
+// A connection may pipeline requests; responses carry the request id and
+// may come back in any order.
+const uint32_t kServiceMaxMessage = 1 << 20;
+const uint32_t kServiceStatusOk = 0;
+const uint32_t kServiceStatusFailed = 1;
+
+struct ServiceConfig {
+    std::string socket_path;
+    int workers = 1;          // signing threads
+    int max_batch = 1;        // requests a worker takes from the queue at once
+    uint64_t max_wait_us = 0; // how long the oldest queued request may wait for a batch to fill
+};
+
+// Counters since the server started.
+struct ServiceStats {
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t batches = 0;
+    uint64_t queue_ns = 0; // summed time from a request being parsed to a worker taking it
+    uint64_t sign_ns = 0;  // summed time inside the signature
+
+    double meanBatch() const { return batches ? static_cast<double>(requests) / batches : 0.0; }
+    double meanQueueNs() const { return requests ? static_cast<double>(queue_ns) / requests : 0.0; }
+    double meanSignNs() const { return requests ? static_cast<double>(sign_ns) / requests : 0.0; }
+};
+
+// One epoll thread accepts connections, reads and parses requests and
+// writes responses back; a pool of workers takes requests off a shared
+// queue in micro-batches and signs them. A worker takes a batch as soon as
+// max_batch requests are queued or the oldest has waited max_wait_us,
+// whichever comes first. Each worker hands its batch's responses back to
+// the epoll thread with one wakeup, which is where batching saves work.
+class SignServer {
+public:
+    // Takes ownership of `key`; every worker signs with its own copy.
+    SignServer(const ServiceConfig& config, EVP_PKEY* key, const SignatureParams& params);
+    ~SignServer();
+
+    SignServer(const SignServer&) = delete;
+    SignServer& operator=(const SignServer&) = delete;
+
+    // Bind the socket (replacing a stale one at the same path) and start the
+    // threads. False with `error` set on failure.
+    bool start(std::string& error);
+
+    // Stop accepting, close every connection and join the threads. Called by
+    // the destructor if needed.
+    void stop();
+
+    ServiceStats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Connect to a server's socket; -1 with `error` set on failure.
+int connectService(const std::string& socket_path, std::string& error);
+
+// Client side for the engine: one connection per worker, one request at a
+// time, timed from writing the request to reading the whole response. The
+// message is refilled with random bytes in prepare().
+class ServiceRequestOperation : public Operation {
+public:
+    // Takes ownership of `fd`.
+    ServiceRequestOperation(int fd, size_t message_size);
+    ~ServiceRequestOperation();
+
+    ServiceRequestOperation(const ServiceRequestOperation&) = delete;
+    ServiceRequestOperation& operator=(const ServiceRequestOperation&) = delete;
+
+    void prepare();
+    bool operator()();
+
+private:
+    int fd_;
+    uint32_t next_id_;
+    std::vector<unsigned char> request_;  // header followed by the message
+    std::vector<unsigned char> response_;
+    std::mt19937 gen_;
+    std::uniform_int_distribution<unsigned int> dis_;
+};
+
+// One server setting measured by sign_service --batch-sweep.
+struct ServicePoint {
+    int max_batch = 1;
+    uint64_t max_wait_us = 0;
+    double throughput = 0.0; // end to end, as the clients saw it
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t client_failures = 0;
+    ServiceStats server;
+};
+
+// Client throughput and latency next to the batches the server formed and
+// where its time went, one row per setting.
+void printServiceTable(std::ostream& out, const RunConfig& config, const std::vector<ServicePoint>& points);
+
+} // namespace bench
+
+#endif // BENCH_SIGN_SERVICE_H
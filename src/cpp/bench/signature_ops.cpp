@@ -0,0 +1,178 @@
+#include "signature_ops.h"
+
+#include <iomanip>
+
+#include "report.h"
+
+namespace bench {
+
+bool parseContextStrategy(const std::string& name, ContextStrategy& strategy) {
+    if (name == "reinit") {
+        strategy = ContextStrategy::Reinit;
+    } else if (name == "template") {
+        strategy = ContextStrategy::Template;
+    } else if (name == "prehash") {
+        strategy = ContextStrategy::Prehash;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* contextStrategyName(ContextStrategy strategy) {
+    switch (strategy) {
+    case ContextStrategy::Template:
+        return "template";
+    case ContextStrategy::Prehash:
+        return "prehash";
+    case ContextStrategy::Reinit:
+    default:
+        return "reinit";
+    }
+}
+
+std::vector<ContextStrategy> allContextStrategies() {
+    return {ContextStrategy::Reinit, ContextStrategy::Template, ContextStrategy::Prehash};
+}
+
+std::string SignatureParams::describe() const {
+    if (one_shot) {
+        return "EdDSA (one-shot EVP_DigestSign, no separate digest)";
+    }
+    if (padding != RSAPSS) {
+        return "SHA-256";
+    }
+    std::string salt;
+    switch (pss_saltlen) {
+    case RSA_PSS_SALTLEN_DIGEST:
+        salt = "digest length";
+        break;
+    case RSA_PSS_SALTLEN_MAX:
+        salt = "maximum";
+        break;
+    default:
+        salt = std::to_string(pss_saltlen) + " bytes";
+        break;
+    }
+    return "RSA-PSS with SHA-256, MGF1-SHA256, salt length = " + salt;
+}
+
+SignOperation::SignOperation(EVP_PKEY* key, const SignatureParams& params, size_t message_size,
+                             ContextStrategy strategy, PhaseTimes* phases)
+    : key_(key), md_ctx_(EVP_MD_CTX_new()), template_ctx_(nullptr), sign_ctx_(nullptr), params_(params),
+      strategy_(strategy), ready_(true), message_(message_size), signature_(EVP_PKEY_get_size(key)),
+      gen_(std::random_device()()), dis_(0, 255), timer_(phases != nullptr), phases_(phases) {
+    switch (strategy_) {
+    case ContextStrategy::Template:
+        // Everything up to the first update is done once; each signature
+        // starts from a copy of this context.
+        template_ctx_ = EVP_MD_CTX_new();
+        ready_ = template_ctx_ != nullptr && digestSignInit(template_ctx_, key_, params_);
+        break;
+    case ContextStrategy::Prehash:
+        if (params_.one_shot) {
+            // EdDSA has no digest to compute separately
+            ready_ = false;
+            break;
+        }
+        // The signature context keeps its padding and digest settings across
+        // EVP_PKEY_sign calls, so it is initialised exactly once.
+        sign_ctx_ = EVP_PKEY_CTX_new_from_pkey(params_.libctx, key_, nullptr);
+        ready_ = sign_ctx_ != nullptr && EVP_PKEY_sign_init(sign_ctx_) > 0 &&
+                 applySignatureParams(sign_ctx_, params_) &&
+                 EVP_PKEY_CTX_set_signature_md(sign_ctx_, params_.digest()) > 0;
+        break;
+    case ContextStrategy::Reinit:
+        break;
+    }
+}
+
+SignOperation::~SignOperation() {
+    if (phases_) {
+        phases_->add(totals_);
+    }
+    EVP_PKEY_CTX_free(sign_ctx_);
+    EVP_MD_CTX_free(template_ctx_);
+    EVP_MD_CTX_free(md_ctx_);
+    EVP_PKEY_free(key_);
+}
+
+bool SignatureCorpus::build(EVP_PKEY* key, const SignatureParams& params, size_t count, size_t message_size) {
+    EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+    if (!md_ctx) {
+        return false;
+    }
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<unsigned int> dis(0, 255);
+    entries_.assign(count, Entry());
+    bool ok = true;
+    for (auto& entry : entries_) {
+        entry.message.resize(message_size);
+        for (auto& byte : entry.message) {
+            byte = static_cast<unsigned char>(dis(gen));
+        }
+        entry.signature.resize(EVP_PKEY_get_size(key));
+        size_t signature_len = entry.signature.size();
+        if (!digestSign(md_ctx, key, params, entry.message.data(), entry.message.size(),
+                        entry.signature.data(), &signature_len)) {
+            ok = false;
+            break;
+        }
+        entry.signature.resize(signature_len);
+    }
+
+    EVP_MD_CTX_free(md_ctx);
+    if (!ok) {
+        entries_.clear();
+    }
+    return ok;
+}
+
+VerifyOperation::VerifyOperation(EVP_PKEY* key, const SignatureParams& params, const SignatureCorpus& corpus,
+                                 size_t start)
+    : key_(key), md_ctx_(EVP_MD_CTX_new()), params_(params), corpus_(corpus),
+      next_(corpus.size() > 0 ? start % corpus.size() : 0), current_(nullptr) {}
+
+VerifyOperation::~VerifyOperation() {
+    EVP_MD_CTX_free(md_ctx_);
+    EVP_PKEY_free(key_);
+}
+
+void printPhaseBreakdown(std::ostream& out, const PhaseTimes& phases) {
+    uint64_t total_ns = phases.init_ns + phases.update_ns + phases.final_ns;
+    out << std::fixed << std::setprecision(2) << "Phase breakdown (mean per signature): init "
+        << meanUs(phases.init_ns, phases.operations) << "us, update " << meanUs(phases.update_ns, phases.operations)
+        << "us, final " << meanUs(phases.final_ns, phases.operations) << "us; context setup is "
+        << std::setprecision(1) << (total_ns > 0 ? 100.0 * phases.init_ns / total_ns : 0.0) << "% of the total"
+        << std::endl;
+}
+
+void printContextStrategyTable(std::ostream& out, const RunConfig& config, const std::vector<StrategyResult>& results) {
+    if (results.empty()) {
+        return;
+    }
+    double base = results.front().throughput;
+
+    out << std::endl;
+    out << "Strategy" << std::setw(14) << config.rate_label << std::setw(10) << "speedup" << std::setw(11)
+        << "init(us)" << std::setw(11) << "update(us)" << std::setw(11) << "final(us)" << std::setw(8) << "init%"
+        << std::setw(11) << "p50(ms)" << std::setw(11) << "p99(ms)" << std::endl;
+    for (const auto& r : results) {
+        const PhaseTimes& p = r.phases;
+        uint64_t total_ns = p.init_ns + p.update_ns + p.final_ns;
+        out << std::left << std::setw(8) << contextStrategyName(r.strategy) << std::right << std::fixed
+            << std::setprecision(1) << std::setw(14) << r.throughput << std::setprecision(2) << std::setw(9)
+            << (base > 0.0 ? r.throughput / base : 0.0) << "x" << std::setw(11) << meanUs(p.init_ns, p.operations)
+            << std::setw(11) << meanUs(p.update_ns, p.operations) << std::setw(11) << meanUs(p.final_ns, p.operations)
+            << std::setprecision(1) << std::setw(7) << (total_ns > 0 ? 100.0 * p.init_ns / total_ns : 0.0) << "%"
+            << std::setprecision(3) << std::setw(11) << nsToMs(r.p50_ns) << std::setw(11) << nsToMs(r.p99_ns);
+        if (r.failures > 0) {
+            out << "  (" << r.failures << " failures)";
+        }
+        out << std::endl;
+    }
+    out << "Phase times include one clock read per phase; throughput is for the whole signature." << std::endl;
+}
+
+} // namespace bench
@@ -0,0 +1,343 @@
+#ifndef BENCH_SIGNATURE_OPS_H
+#define BENCH_SIGNATURE_OPS_H
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+#include "engine.h"
+
+namespace bench {
+
+// Digest and padding applied to the signing/verification context. ECDSA
+// ignores the padding.
+struct SignatureParams {
+    enum Padding { Default, RSAPSS };
+
+    Padding padding = Default;
+    // EdDSA: no digest, and the message can only be signed whole with the
+    // one-shot EVP_DigestSign/EVP_DigestVerify, never through update/final
+    bool one_shot = false;
+    int pss_saltlen = RSA_PSS_SALTLEN_DIGEST;
+    // A pre-fetched SHA-256 (see FetchedAlgorithms), or nullptr for EVP_sha256()
+    const EVP_MD* md = nullptr;
+    // The worker's private library context in isolated mode; contexts are
+    // then created with the _ex APIs against it
+    OSSL_LIB_CTX* libctx = nullptr;
+
+    const EVP_MD* digest() const { return md ? md : EVP_sha256(); }
+
+    // The digest to pass to init: none for EdDSA
+    const EVP_MD* initDigest() const { return one_shot ? nullptr : digest(); }
+
+    static SignatureParams rsaPSS() {
+        SignatureParams params;
+        params.padding = RSAPSS;
+        return params;
+    }
+
+    std::string describe() const;
+};
+
+// How the signing context is brought into a ready state for each signature.
+enum class ContextStrategy {
+    Reinit,   // EVP_DigestSignInit and padding setup on every signature (what the tools always did)
+    Template, // EVP_MD_CTX_copy_ex from a context initialised once up front
+    Prehash   // hash separately, then EVP_PKEY_sign on one EVP_PKEY_CTX initialised once
+};
+
+bool parseContextStrategy(const std::string& name, ContextStrategy& strategy);
+const char* contextStrategyName(ContextStrategy strategy);
+std::vector<ContextStrategy> allContextStrategies();
+
+// Time spent in each phase of a signature, summed over a worker's operations.
+// For Prehash, "init" and "update" are the digest's and "final" covers the
+// digest final plus EVP_PKEY_sign.
+struct PhaseTimes {
+    uint64_t operations = 0;
+    uint64_t init_ns = 0;
+    uint64_t update_ns = 0;
+    uint64_t final_ns = 0;
+
+    void add(const PhaseTimes& other) {
+        operations += other.operations;
+        init_ns += other.init_ns;
+        update_ns += other.update_ns;
+        final_ns += other.final_ns;
+    }
+};
+
+// Splits one operation into consecutive phases. Disabled, it reads no clocks,
+// so the plain benchmark pays nothing for the breakdown.
+class PhaseTimer {
+public:
+    explicit PhaseTimer(bool enabled) : enabled_(enabled) {}
+
+    void start() {
+        if (enabled_) {
+            last_ = Clock::now();
+        }
+    }
+
+    // Charge the time since the previous mark to `total`.
+    void lap(uint64_t& total) {
+        if (enabled_) {
+            Clock::time_point now = Clock::now();
+            total += elapsedNs(last_, now);
+            last_ = now;
+        }
+    }
+
+private:
+    bool enabled_;
+    Clock::time_point last_;
+};
+
+// Configure padding, salt length and MGF1 on a freshly initialised context.
+inline bool applySignatureParams(EVP_PKEY_CTX* pctx, const SignatureParams& params) {
+    if (params.padding != SignatureParams::RSAPSS) {
+        return true;
+    }
+    return EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) > 0 &&
+           EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, params.pss_saltlen) > 0 &&
+           EVP_PKEY_CTX_set_rsa_mgf1_md(pctx, params.digest()) > 0;
+}
+
+inline bool digestSignInit(EVP_MD_CTX* md_ctx, EVP_PKEY* key, const SignatureParams& params) {
+    EVP_PKEY_CTX* pctx = nullptr;
+    const EVP_MD* md = params.initDigest();
+    int ok = params.libctx
+        ? EVP_DigestSignInit_ex(md_ctx, &pctx, md ? EVP_MD_get0_name(md) : nullptr, params.libctx, nullptr, key, nullptr)
+        : EVP_DigestSignInit(md_ctx, &pctx, md, nullptr, key);
+    return ok > 0 && applySignatureParams(pctx, params);
+}
+
+inline bool digestVerifyInit(EVP_MD_CTX* md_ctx, EVP_PKEY* key, const SignatureParams& params) {
+    EVP_PKEY_CTX* pctx = nullptr;
+    const EVP_MD* md = params.initDigest();
+    int ok = params.libctx
+        ? EVP_DigestVerifyInit_ex(md_ctx, &pctx, md ? EVP_MD_get0_name(md) : nullptr, params.libctx, nullptr, key, nullptr)
+        : EVP_DigestVerifyInit(md_ctx, &pctx, md, nullptr, key);
+    return ok > 0 && applySignatureParams(pctx, params);
+}
+
+// Sign or verify an initialised context's whole message: update and final,
+// or the one-shot call EdDSA requires.
+inline bool signMessage(EVP_MD_CTX* md_ctx, const SignatureParams& params, const unsigned char* message,
+                        size_t message_len, unsigned char* signature, size_t* signature_len) {
+    if (params.one_shot) {
+        return EVP_DigestSign(md_ctx, signature, signature_len, message, message_len) > 0;
+    }
+    return EVP_DigestSignUpdate(md_ctx, message, message_len) > 0 &&
+           EVP_DigestSignFinal(md_ctx, signature, signature_len) > 0;
+}
+
+inline bool verifyMessage(EVP_MD_CTX* md_ctx, const SignatureParams& params, const unsigned char* message,
+                          size_t message_len, const unsigned char* signature, size_t signature_len) {
+    if (params.one_shot) {
+        return EVP_DigestVerify(md_ctx, signature, signature_len, message, message_len) == 1;
+    }
+    return EVP_DigestVerifyUpdate(md_ctx, message, message_len) > 0 &&
+           EVP_DigestVerifyFinal(md_ctx, signature, signature_len) == 1;
+}
+
+// One hash-and-sign, re-initialising the context as the tools always have.
+inline bool digestSign(EVP_MD_CTX* md_ctx, EVP_PKEY* key, const SignatureParams& params,
+                       const unsigned char* message, size_t message_len,
+                       unsigned char* signature, size_t* signature_len) {
+    return digestSignInit(md_ctx, key, params) &&
+           signMessage(md_ctx, params, message, message_len, signature, signature_len);
+}
+
+inline bool digestVerify(EVP_MD_CTX* md_ctx, EVP_PKEY* key, const SignatureParams& params,
+                         const unsigned char* message, size_t message_len,
+                         const unsigned char* signature, size_t signature_len) {
+    return digestVerifyInit(md_ctx, key, params) &&
+           verifyMessage(md_ctx, params, message, message_len, signature, signature_len);
+}
+
+// Signs a fresh random message with one per-thread key. The message is
+// refilled in prepare(), outside the timed region; the signature buffer is
+// sized once from the key. The context strategy decides how much setup each
+// signature repeats; with a PhaseTimes sink the op also times its init,
+// update and final phases and adds them to the sink when destroyed.
+class SignOperation : public Operation {
+public:
+    // Takes ownership of `key`.
+    SignOperation(EVP_PKEY* key, const SignatureParams& params, size_t message_size,
+                  ContextStrategy strategy = ContextStrategy::Reinit, PhaseTimes* phases = nullptr);
+    ~SignOperation();
+
+    SignOperation(const SignOperation&) = delete;
+    SignOperation& operator=(const SignOperation&) = delete;
+
+    bool valid() const { return md_ctx_ != nullptr && ready_; }
+
+    void prepare() {
+        for (auto& byte : message_) {
+            byte = static_cast<unsigned char>(dis_(gen_));
+        }
+    }
+
+    bool operator()() {
+        size_t signature_len = signature_.size();
+        bool ok = false;
+        timer_.start();
+        switch (strategy_) {
+        case ContextStrategy::Reinit:
+        case ContextStrategy::Template:
+            ok = strategy_ == ContextStrategy::Template ? EVP_MD_CTX_copy_ex(md_ctx_, template_ctx_) > 0
+                                                       : digestSignInit(md_ctx_, key_, params_);
+            timer_.lap(totals_.init_ns);
+            if (params_.one_shot) {
+                // EdDSA hashes and signs in one call, all of it counted as final
+                ok = ok && EVP_DigestSign(md_ctx_, signature_.data(), &signature_len, message_.data(),
+                                          message_.size()) > 0;
+                timer_.lap(totals_.final_ns);
+                break;
+            }
+            ok = ok && EVP_DigestSignUpdate(md_ctx_, message_.data(), message_.size()) > 0;
+            timer_.lap(totals_.update_ns);
+            ok = ok && EVP_DigestSignFinal(md_ctx_, signature_.data(), &signature_len) > 0;
+            timer_.lap(totals_.final_ns);
+            break;
+        case ContextStrategy::Prehash: {
+            unsigned int digest_len = 0;
+            ok = EVP_DigestInit_ex(md_ctx_, params_.digest(), nullptr) > 0;
+            timer_.lap(totals_.init_ns);
+            ok = ok && EVP_DigestUpdate(md_ctx_, message_.data(), message_.size()) > 0;
+            timer_.lap(totals_.update_ns);
+            ok = ok && EVP_DigestFinal_ex(md_ctx_, digest_, &digest_len) > 0 &&
+                 EVP_PKEY_sign(sign_ctx_, signature_.data(), &signature_len, digest_, digest_len) > 0;
+            timer_.lap(totals_.final_ns);
+            break;
+        }
+        }
+        totals_.operations++;
+        return ok;
+    }
+
+private:
+    EVP_PKEY* key_;
+    EVP_MD_CTX* md_ctx_;
+    EVP_MD_CTX* template_ctx_;  // Template strategy only
+    EVP_PKEY_CTX* sign_ctx_;    // Prehash strategy only
+    SignatureParams params_;
+    ContextStrategy strategy_;
+    bool ready_;
+    std::vector<unsigned char> message_;
+    std::vector<unsigned char> signature_;
+    unsigned char digest_[EVP_MAX_MD_SIZE];
+    std::mt19937 gen_;
+    std::uniform_int_distribution<unsigned int> dis_;
+    PhaseTimer timer_;
+    PhaseTimes totals_;
+    PhaseTimes* phases_;
+};
+
+// Distinct random messages and their signatures, built once before a verify
+// run and shared read-only by all workers.
+class SignatureCorpus {
+public:
+    struct Entry {
+        std::vector<unsigned char> message;
+        std::vector<unsigned char> signature;
+    };
+
+    bool build(EVP_PKEY* key, const SignatureParams& params, size_t count, size_t message_size);
+
+    size_t size() const { return entries_.size(); }
+    const Entry& operator[](size_t i) const { return entries_[i]; }
+
+private:
+    std::vector<Entry> entries_;
+};
+
+// Verifies corpus entries in turn, starting at a per-thread offset so
+// workers don't walk the corpus in lockstep. A signature that fails to
+// verify counts as a failed operation.
+class VerifyOperation : public Operation {
+public:
+    // Takes ownership of `key`.
+    VerifyOperation(EVP_PKEY* key, const SignatureParams& params, const SignatureCorpus& corpus, size_t start);
+    ~VerifyOperation();
+
+    VerifyOperation(const VerifyOperation&) = delete;
+    VerifyOperation& operator=(const VerifyOperation&) = delete;
+
+    bool valid() const { return md_ctx_ != nullptr && corpus_.size() > 0; }
+
+    void prepare() {
+        current_ = &corpus_[next_];
+        if (++next_ == corpus_.size()) {
+            next_ = 0;
+        }
+    }
+
+    bool operator()() {
+        return digestVerify(md_ctx_, key_, params_, current_->message.data(), current_->message.size(),
+                            current_->signature.data(), current_->signature.size());
+    }
+
+private:
+    EVP_PKEY* key_;
+    EVP_MD_CTX* md_ctx_;
+    SignatureParams params_;
+    const SignatureCorpus& corpus_;
+    size_t next_;
+    const SignatureCorpus::Entry* current_;
+};
+
+struct StrategyResult {
+    ContextStrategy strategy = ContextStrategy::Reinit;
+    double throughput = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+    PhaseTimes phases;
+};
+
+// Run the same signing benchmark once per context strategy.
+// `make_op(strategy, thread_index, phases)` builds one worker's SignOperation
+// reporting into `phases`, which has one slot per worker thread.
+template <typename OpFactory>
+std::vector<StrategyResult> compareContextStrategies(const RunConfig& base, OpFactory make_op) {
+    std::vector<StrategyResult> results;
+    for (ContextStrategy strategy : allContextStrategies()) {
+        RunConfig config = base;
+        config.live_stats = false;
+        std::vector<PhaseTimes> phases(config.num_threads);
+        std::cout << "  " << contextStrategyName(strategy) << "..." << std::flush;
+        RunResult result = run(config, [&make_op, &phases, strategy](int thread_index) {
+            return make_op(strategy, thread_index, &phases[thread_index]);
+        });
+
+        StrategyResult row;
+        row.strategy = strategy;
+        row.throughput = result.throughput();
+        row.p50_ns = result.latency->valueAtPercentile(50.0);
+        row.p99_ns = result.latency->valueAtPercentile(99.0);
+        row.failures = result.failures;
+        for (const auto& p : phases) {
+            row.phases.add(p);
+        }
+        results.push_back(row);
+        std::cout << " " << static_cast<uint64_t>(row.throughput) << " " << config.rate_label << std::endl;
+    }
+    return results;
+}
+
+// Mean init/update/final time per signature, and the share spent in init.
+void printPhaseBreakdown(std::ostream& out, const PhaseTimes& phases);
+
+// One row per strategy: throughput, speedup over re-init, phase split and percentiles.
+void printContextStrategyTable(std::ostream& out, const RunConfig& config, const std::vector<StrategyResult>& results);
+
+} // namespace bench
+
+#endif // BENCH_SIGNATURE_OPS_H
@@ -0,0 +1,142 @@
+#include "signer.h"
+
+#include <cstdlib>
+
+#include "library_context.h"
+
+namespace bench {
+
+OptionStatus parseSignerOption(int argc, char* argv[], int& i, SignerOptions& options, std::string& error) {
+    OptionStatus status = parseStreamingOption(argc, argv, i, options.streaming, error);
+    if (status != OptionStatus::Unrecognized) {
+        return status;
+    }
+
+    std::string arg = argv[i];
+    std::string value;
+    if (arg == "--verify") {
+        options.verify = true;
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--corpus" && optionValue(argc, argv, i, value)) {
+        options.corpus_size = std::strtoull(value.c_str(), nullptr, 10);
+        if (options.corpus_size < 1) {
+            error = "Corpus size must be at least 1";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--fetch" && optionValue(argc, argv, i, value)) {
+        if (value == "compare") {
+            options.compare_fetch = true;
+        } else if (!parseFetchMode(value, options.fetch_mode)) {
+            error = "--fetch must be implicit, explicit or compare";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    if (arg == "--ctx" && optionValue(argc, argv, i, value)) {
+        options.phase_timing = true;
+        if (value == "all") {
+            options.compare_strategies = true;
+        } else if (!parseContextStrategy(value, options.strategy)) {
+            error = "--ctx must be reinit, template, prehash or all";
+            return OptionStatus::Error;
+        }
+        return OptionStatus::Consumed;
+    }
+    return OptionStatus::Unrecognized;
+}
+
+bool checkSignerOptions(const RunConfig& config, const SignerOptions& options, std::string& error) {
+    if (options.phase_timing && options.verify) {
+        error = "--ctx applies to signing, not --verify";
+        return false;
+    }
+    if ((options.compare_strategies ? 1 : 0) + (options.compare_fetch ? 1 : 0) + (config.compare_libctx ? 1 : 0) +
+            (config.async_sweep ? 1 : 0) + (config.rate_sweep ? 1 : 0) > 1) {
+        error = "only one of --ctx all, --fetch compare, --libctx compare, --async-sweep and --rate-sweep"
+                " can be used at a time";
+        return false;
+    }
+    if (options.compare_fetch && config.libctx_mode == LibCtxMode::Isolated) {
+        error = "isolated workers always fetch from their own context; --fetch compare needs --libctx shared";
+        return false;
+    }
+    if (options.compare_strategies && config.sweep) {
+        error = "--ctx all and --sweep cannot be combined";
+        return false;
+    }
+
+    if (options.streaming.enabled()) {
+        if (!options.streaming.file.empty() && !options.streaming.message_sizes.empty()) {
+            error = "--file and --message-size cannot be combined";
+            return false;
+        }
+        if (options.phase_timing || options.compare_fetch || config.compare_libctx || config.sweep ||
+            config.async_sweep || config.rate_sweep) {
+            error = "--message-size and --file cannot be combined with --ctx, --fetch compare,"
+                    " --libctx compare, --sweep, --async-sweep or --rate-sweep";
+            return false;
+        }
+    }
+    return true;
+}
+
+void printSignerOptions(std::ostream& out) {
+    out << "  --verify              - Verify a corpus of pre-built signatures instead of signing" << std::endl;
+    out << "  --corpus N            - Distinct messages/signatures in the verify corpus (default 1024)" << std::endl;
+    out << "  --ctx reinit|template|prehash|all" << std::endl;
+    out << "                        - Signing context lifecycle: re-init per signature (default), copy a" << std::endl;
+    out << "                          pre-initialised template, or hash then EVP_PKEY_sign on a reused" << std::endl;
+    out << "                          context; 'all' compares them. Reports init/update/final time" << std::endl;
+    out << "  --fetch implicit|explicit|compare" << std::endl;
+    out << "                        - Pass EVP_sha256() on every init (default), or EVP_MD_fetch SHA-256 once" << std::endl;
+    out << "                          and reuse it; 'compare' runs both at 1, 2, 4, ... num_threads" << std::endl;
+    printStreamingOptions(out);
+}
+
+SignerBench::SignerBench(const RunConfig& run_config, const SignerOptions& signer_options,
+                         const SignatureParams& signature_params)
+    : config(run_config), options(signer_options), params(signature_params) {
+    config.unit_label = options.verify ? "Verifies" : "Sigs";
+    config.rate_label = options.verify ? "verifies/s" : "sigs/s";
+}
+
+bool SignerBench::loadMessages(std::string& error) {
+    return !options.streaming.enabled() || messages.load(options.streaming, error);
+}
+
+SignatureParams SignerBench::paramsFor(FetchMode mode) const {
+    SignatureParams op_params = params;
+    LibraryContext* libctx = threadLibraryContext();
+    if (libctx) {
+        op_params.libctx = libctx->get();
+        op_params.md = libctx->sha256();
+    } else {
+        op_params.md = mode == FetchMode::Explicit ? fetched.sha256() : nullptr;
+    }
+    return op_params;
+}
+
+bool SignerBench::fetchAlgorithms(const char* signature_name) {
+    if (options.fetch_mode != FetchMode::Explicit && !options.compare_fetch) {
+        return true;
+    }
+    return fetched.fetch(signature_name);
+}
+
+PhaseTimes* SignerBench::phaseSink(int thread_index) {
+    return options.phase_timing && !config.sweep ? &phases[thread_index] : nullptr;
+}
+
+Settings SignerBench::runSettings() const {
+    Settings settings;
+    settings.push_back(std::make_pair("fetch", options.fetch_mode == FetchMode::Explicit ? "explicit" : "implicit"));
+    if (!options.verify) {
+        settings.push_back(std::make_pair("strategy", contextStrategyName(options.strategy)));
+    }
+    return settings;
+}
+
+} // namespace bench
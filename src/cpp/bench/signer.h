@@ -0,0 +1,142 @@
+#ifndef BENCH_SIGNER_H
+#define BENCH_SIGNER_H
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "algorithms.h"
+#include "engine.h"
+#include "options.h"
+#include "report.h"
+#include "results.h"
+#include "scaling.h"
+#include "signature_ops.h"
+#include "stream_ops.h"
+
+namespace bench {
+
+// What ecdsa_signer and rsa_signer have in common: the options that choose
+// between signing and verifying, the context strategy and the fetch mode,
+// and the run paths those options lead to. Each tool supplies the keys and
+// the operation factories.
+
+struct SignerOptions {
+    bool verify = false;             // verify a pre-built corpus instead of signing
+    size_t corpus_size = 1024;       // distinct message/signature pairs in verify mode
+    ContextStrategy strategy = ContextStrategy::Reinit;
+    bool phase_timing = false;       // --ctx given: split each signature into init/update/final
+    bool compare_strategies = false; // --ctx all: run every strategy and tabulate
+    FetchMode fetch_mode = FetchMode::Implicit;
+    bool compare_fetch = false;      // --fetch compare: both modes at 1, 2, 4, ... num_threads
+    StreamingOptions streaming;      // --message-size/--file: whole messages hashed in chunks
+};
+
+// Parse argv[i] if it is --verify, --corpus, --ctx, --fetch or one of the
+// streaming options.
+OptionStatus parseSignerOption(int argc, char* argv[], int& i, SignerOptions& options, std::string& error);
+
+// The combinations of signer and common options a signer can't run; false
+// with `error` set on the first one found.
+bool checkSignerOptions(const RunConfig& config, const SignerOptions& options, std::string& error);
+
+// Usage lines for the options parseSignerOption() accepts.
+void printSignerOptions(std::ostream& out);
+
+// Base of the two signer tools. Holds the run configuration, the shared
+// options and the state their runs need, and dispatches each run to a
+// sweep, a comparison or a single measured run.
+class SignerBench {
+public:
+    SignerBench(const RunConfig& config, const SignerOptions& options, const SignatureParams& params);
+
+    // Map the file or build the synthetic messages for streaming mode
+    bool loadMessages(std::string& error);
+
+protected:
+    // Called on the worker thread. Isolated workers always use the digest
+    // fetched in their own context, never one from the shared default context.
+    SignatureParams paramsFor(FetchMode mode) const;
+
+    // Fetch SHA-256 and `signature_name` when the fetch mode needs them
+    bool fetchAlgorithms(const char* signature_name);
+
+    // Phase timing is per run; sweeps only report throughput and latency.
+    PhaseTimes* phaseSink(int thread_index);
+
+    // The fetch mode, and for signing the context strategy, as result settings
+    Settings runSettings() const;
+
+    template <typename OpFactory>
+    void compareFetch(OpFactory make_op) {
+        std::cout << "Algorithm fetch, implicit vs explicit:" << std::endl;
+        std::vector<PairedScalingPoint> points = runPairedScaling(
+            config, config, scalingSteps(config.num_threads),
+            [&make_op](int thread_index) { return make_op(FetchMode::Implicit, thread_index); },
+            [&make_op](int thread_index) { return make_op(FetchMode::Explicit, thread_index); });
+        printPairedScalingTable(std::cout, config, "implicit", "explicit", points);
+    }
+
+    template <typename OpFactory>
+    void compareStrategies(OpFactory make_op) {
+        std::cout << "Context strategies:" << std::endl;
+        std::vector<StrategyResult> results = compareContextStrategies(config, make_op);
+        printContextStrategyTable(std::cout, config, results);
+    }
+
+    // The rate, async, library context or thread sweep the options ask
+    // for, or else one run that is reported, saved with `settings` and
+    // handed to `on_result`.
+    template <typename OpFactory, typename OnResult>
+    void execute(OpFactory make_op, const Settings& settings, OnResult on_result) {
+        phases.assign(config.num_threads, PhaseTimes());
+        if (config.rate_sweep) {
+            runRateSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.async_sweep) {
+            compareAsyncJobs(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.compare_libctx) {
+            compareLibraryContexts(std::cout, config, make_op);
+            return;
+        }
+        if (config.sweep) {
+            runSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        RunResult result = run(config, make_op);
+        printRunReport(std::cout, config, result);
+        saveResult(config, workload, result, settings);
+        on_result(result);
+        if (phaseSink(0)) {
+            PhaseTimes total;
+            for (const auto& p : phases) {
+                total.add(p);
+            }
+            printPhaseBreakdown(std::cout, total);
+        }
+    }
+
+    template <typename OpFactory>
+    void execute(OpFactory make_op) {
+        execute(make_op, runSettings(), [](const RunResult&) {});
+    }
+
+    RunConfig config;
+    SignerOptions options;
+    SignatureParams params;
+    std::string workload;           // names the run in --sweep-out and --output files
+    FetchedAlgorithms fetched;      // filled for --fetch explicit/compare
+    StreamingInputs messages;       // streaming mode only
+
+private:
+    std::vector<PhaseTimes> phases; // one slot per worker when phase timing
+};
+
+} // namespace bench
+
+#endif // BENCH_SIGNER_H
@@ -0,0 +1,172 @@
+#include "stream_ops.h"
+
+#include <iomanip>
+#include <openssl/rand.h>
+
+#include "report.h"
+
+namespace bench {
+
+OptionStatus parseStreamingOption(int argc, char* argv[], int& i, StreamingOptions& options, std::string& error) {
+    std::string arg = argv[i];
+    std::string value;
+    if (arg != "--message-size" && arg != "--file" && arg != "--chunk") {
+        return OptionStatus::Unrecognized;
+    }
+    if (!optionValue(argc, argv, i, value)) {
+        error = arg + " needs a value";
+        return OptionStatus::Error;
+    }
+    if (arg == "--message-size") {
+        if (!parseByteSizeList(value, options.message_sizes)) {
+            error = "--message-size takes sizes such as 1K,64K,1M";
+            return OptionStatus::Error;
+        }
+    } else if (arg == "--file") {
+        options.file = value;
+    } else if (!parseByteSize(value, options.chunk) || options.chunk < 1) {
+        error = "--chunk takes a size of at least 1 byte, e.g. 4K or 1M";
+        return OptionStatus::Error;
+    }
+    return OptionStatus::Consumed;
+}
+
+void printStreamingOptions(std::ostream& out) {
+    out << "  --message-size LIST   - Sign whole messages of each size (e.g. 1K,64K,1M,1G) instead of 32 bytes," << std::endl;
+    out << "                          reporting hash bandwidth and the fixed asymmetric cost per size" << std::endl;
+    out << "  --file PATH           - The same for one memory-mapped file, hashed in place" << std::endl;
+    out << "  --chunk SIZE          - Bytes per EVP_DigestSign/VerifyUpdate call (default 64K)" << std::endl;
+}
+
+bool StreamingInputs::load(const StreamingOptions& options, std::string& error) {
+    messages_.clear();
+    if (!options.file.empty()) {
+        if (!file_.open(options.file, error)) {
+            return false;
+        }
+        MessageInput input;
+        std::string::size_type slash = options.file.find_last_of('/');
+        input.label = slash == std::string::npos ? options.file : options.file.substr(slash + 1);
+        input.data = file_.data();
+        input.size = file_.size();
+        messages_.push_back(input);
+        from_file_ = true;
+        return true;
+    }
+
+    size_t largest = 0;
+    for (size_t size : options.message_sizes) {
+        largest = size > largest ? size : largest;
+    }
+    synthetic_.resize(largest);
+    // RAND_bytes takes an int length
+    for (size_t offset = 0; offset < largest; offset += 1 << 30) {
+        size_t len = largest - offset < (1u << 30) ? largest - offset : (1u << 30);
+        if (RAND_bytes(synthetic_.data() + offset, static_cast<int>(len)) != 1) {
+            error = "failed to generate random message data";
+            return false;
+        }
+    }
+    for (size_t size : options.message_sizes) {
+        MessageInput input;
+        input.label = formatByteSize(size);
+        input.data = synthetic_.data();
+        input.size = size;
+        messages_.push_back(input);
+    }
+    return true;
+}
+
+std::string StreamingInputs::describe() const {
+    if (from_file_) {
+        return messages_.front().label + " (" + std::to_string(messages_.front().size) + " bytes, memory-mapped)";
+    }
+    std::string sizes;
+    for (const auto& input : messages_) {
+        sizes += (sizes.empty() ? "" : ", ") + input.label;
+    }
+    return sizes + " (random data)";
+}
+
+StreamOperation::StreamOperation(EVP_PKEY* key, const SignatureParams& params, const MessageInput& input,
+                                 size_t chunk, const std::vector<unsigned char>* signature, PhaseTimes* phases)
+    : key_(key), md_ctx_(EVP_MD_CTX_new()), params_(params), input_(input), chunk_(chunk > 0 ? chunk : 1),
+      verify_(signature != nullptr), signature_(signature),
+      buffer_(signature ? 0 : EVP_PKEY_get_size(key)), timer_(true), phases_(phases) {}
+
+StreamOperation::~StreamOperation() {
+    if (phases_) {
+        phases_->add(totals_);
+    }
+    EVP_MD_CTX_free(md_ctx_);
+    EVP_PKEY_free(key_);
+}
+
+bool signInput(EVP_PKEY* key, const SignatureParams& params, const MessageInput& input,
+               std::vector<unsigned char>& signature) {
+    EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
+    if (!md_ctx) {
+        return false;
+    }
+    signature.resize(EVP_PKEY_get_size(key));
+    size_t signature_len = signature.size();
+    bool ok = digestSign(md_ctx, key, params, input.data, input.size, signature.data(), &signature_len);
+    signature.resize(ok ? signature_len : 0);
+    EVP_MD_CTX_free(md_ctx);
+    return ok;
+}
+
+void printStreamingTable(std::ostream& out, const RunConfig& config, const std::vector<StreamingPoint>& points) {
+    if (points.empty()) {
+        return;
+    }
+
+    out << std::endl;
+    out << std::left << std::setw(12) << "Message" << std::right << std::setw(14) << config.rate_label
+        << std::setw(11) << "p50(ms)" << std::setw(11) << "p99(ms)" << std::setw(11) << "hash GB/s" << std::setw(12)
+        << "total GB/s" << std::setw(11) << "fixed(us)" << std::setw(8) << "hash%" << std::endl;
+
+    // The largest input gives the cleanest hash rate; the fixed cost does
+    // not depend on the size, so it is averaged over every input.
+    double ns_per_byte = 0.0;
+    uint64_t fixed_ns = 0;
+    uint64_t fixed_ops = 0;
+    size_t largest = 0;
+    for (const auto& point : points) {
+        const PhaseTimes& p = point.phases;
+        uint64_t total_ns = p.init_ns + p.update_ns + p.final_ns;
+        uint64_t hashed = point.input.size * p.operations;
+        // Per-worker bandwidth while hashing, and what all workers achieved together
+        double hash_gbps = p.update_ns > 0 ? static_cast<double>(hashed) / p.update_ns : 0.0;
+        double total_gbps = point.throughput * point.input.size / 1e9;
+        out << std::left << std::setw(12) << point.input.label << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << point.throughput << std::setprecision(3) << std::setw(11) << nsToMs(point.p50_ns)
+            << std::setw(11) << nsToMs(point.p99_ns) << std::setprecision(2) << std::setw(11) << hash_gbps
+            << std::setw(12) << total_gbps << std::setprecision(1) << std::setw(11)
+            << meanUs(p.init_ns + p.final_ns, p.operations) << std::setw(7)
+            << (total_ns > 0 ? 100.0 * p.update_ns / total_ns : 0.0) << "%";
+        if (point.failures > 0) {
+            out << "  (" << point.failures << " failures)";
+        }
+        out << std::endl;
+
+        fixed_ns += p.init_ns + p.final_ns;
+        fixed_ops += p.operations;
+        if (point.input.size >= largest && hashed > 0) {
+            largest = point.input.size;
+            ns_per_byte = static_cast<double>(p.update_ns) / hashed;
+        }
+    }
+    out << "hash GB/s is per worker while hashing; total GB/s is message bytes per second over all workers;"
+        << std::endl;
+    out << "fixed is init + final, the asymmetric part that does not grow with the message." << std::endl;
+
+    if (ns_per_byte > 0.0 && fixed_ops > 0) {
+        double fixed = static_cast<double>(fixed_ns) / fixed_ops;
+        out << std::setprecision(2) << "Hashing outweighs the fixed cost above ~" << approximateBytes(fixed / ns_per_byte)
+            << " per message (" << 1.0 / ns_per_byte << " GB/s vs " << std::setprecision(1) << fixed / 1000.0
+            << " us)" << std::endl;
+    }
+}
+
+} // namespace bench
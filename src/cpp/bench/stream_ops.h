@@ -0,0 +1,176 @@
+#ifndef BENCH_STREAM_OPS_H
+#define BENCH_STREAM_OPS_H
+
+#include <cstddef>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+
+#include "engine.h"
+#include "mapped_file.h"
+#include "options.h"
+#include "results.h"
+#include "signature_ops.h"
+
+namespace bench {
+
+// A message to sign as a stream: a mapped file or a slice of a synthetic
+// buffer. Not owned; it outlives every run over it.
+struct MessageInput {
+    std::string label; // file name, or the size for synthetic input
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+// --message-size / --file / --chunk, shared by the signing tools.
+struct StreamingOptions {
+    std::vector<size_t> message_sizes; // synthetic messages, one run per size
+    std::string file;                   // or one run over a memory-mapped file
+    size_t chunk = 64 * 1024;           // bytes per update call
+
+    bool enabled() const { return !message_sizes.empty() || !file.empty(); }
+};
+
+// Parse argv[i] if it is one of the streaming options.
+OptionStatus parseStreamingOption(int argc, char* argv[], int& i, StreamingOptions& options, std::string& error);
+
+void printStreamingOptions(std::ostream& out);
+
+// The messages of a streaming run, built once before any worker starts and
+// read concurrently by all of them: the mapped file, or prefixes of one
+// random buffer as long as the largest requested size.
+class StreamingInputs {
+public:
+    StreamingInputs() : from_file_(false) {}
+
+    bool load(const StreamingOptions& options, std::string& error);
+
+    const std::vector<MessageInput>& messages() const { return messages_; }
+
+    // e.g. "1K, 64K, 1M (random data)" or "firmware.bin (12345678 bytes, memory-mapped)"
+    std::string describe() const;
+
+private:
+    bool from_file_;
+    MappedFile file_;
+    std::vector<unsigned char> synthetic_;
+    std::vector<MessageInput> messages_;
+};
+
+// Signs or verifies one whole message per call, feeding it to
+// EVP_DigestSign/VerifyUpdate in `chunk`-byte pieces straight from the input,
+// without copying it. Init, the updates and final are always timed: the
+// updates are the hash phase and init plus final the fixed asymmetric cost.
+class StreamOperation : public Operation {
+public:
+    // Takes ownership of `key`. With `signature` null the operation signs;
+    // otherwise it verifies `signature` over the input.
+    StreamOperation(EVP_PKEY* key, const SignatureParams& params, const MessageInput& input, size_t chunk,
+                    const std::vector<unsigned char>* signature, PhaseTimes* phases);
+    ~StreamOperation();
+
+    StreamOperation(const StreamOperation&) = delete;
+    StreamOperation& operator=(const StreamOperation&) = delete;
+
+    bool valid() const { return md_ctx_ != nullptr; }
+
+    bool operator()() {
+        timer_.start();
+        bool ok = verify_ ? digestVerifyInit(md_ctx_, key_, params_) : digestSignInit(md_ctx_, key_, params_);
+        timer_.lap(totals_.init_ns);
+        for (size_t offset = 0; ok && offset < input_.size; offset += chunk_) {
+            size_t len = input_.size - offset < chunk_ ? input_.size - offset : chunk_;
+            ok = (verify_ ? EVP_DigestVerifyUpdate(md_ctx_, input_.data + offset, len)
+                          : EVP_DigestSignUpdate(md_ctx_, input_.data + offset, len)) > 0;
+        }
+        timer_.lap(totals_.update_ns);
+        if (verify_) {
+            ok = ok && EVP_DigestVerifyFinal(md_ctx_, signature_->data(), signature_->size()) == 1;
+        } else {
+            size_t signature_len = buffer_.size();
+            ok = ok && EVP_DigestSignFinal(md_ctx_, buffer_.data(), &signature_len) > 0;
+        }
+        timer_.lap(totals_.final_ns);
+        totals_.operations++;
+        return ok;
+    }
+
+private:
+    EVP_PKEY* key_;
+    EVP_MD_CTX* md_ctx_;
+    SignatureParams params_;
+    MessageInput input_;
+    size_t chunk_;
+    bool verify_;
+    const std::vector<unsigned char>* signature_;
+    std::vector<unsigned char> buffer_; // signing output
+    PhaseTimer timer_;
+    PhaseTimes totals_;
+    PhaseTimes* phases_;
+};
+
+// Sign `input` once, for a verify run over it.
+bool signInput(EVP_PKEY* key, const SignatureParams& params, const MessageInput& input,
+               std::vector<unsigned char>& signature);
+
+struct StreamingPoint {
+    MessageInput input;
+    double throughput = 0.0; // messages per second over all workers
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t failures = 0;
+    PhaseTimes phases;
+};
+
+// One engine run per input. `make_op(input, signature, thread_index, phases)`
+// builds a worker's StreamOperation; `signature` is null when signing. Each
+// run is saved to config.results_output as "<workload> <input label>".
+template <typename OpFactory>
+std::vector<StreamingPoint> runStreaming(const RunConfig& base, const std::string& workload, bool verify,
+                                         EVP_PKEY* key, const SignatureParams& params,
+                                         const std::vector<MessageInput>& inputs, size_t chunk, OpFactory make_op) {
+    std::vector<StreamingPoint> points;
+    for (const auto& input : inputs) {
+        std::vector<unsigned char> signature;
+        if (verify && !signInput(key, params, input, signature)) {
+            std::cerr << "Failed to sign " << input.label << " for verification" << std::endl;
+            break;
+        }
+        RunConfig config = base;
+        config.live_stats = false;
+        std::vector<PhaseTimes> phases(config.num_threads);
+        std::cout << "  " << input.label << "..." << std::flush;
+        const std::vector<unsigned char>* expected = verify ? &signature : nullptr;
+        RunResult result = run(config, [&make_op, &input, expected, &phases](int thread_index) {
+            return make_op(input, expected, thread_index, &phases[thread_index]);
+        });
+
+        StreamingPoint point;
+        point.input = input;
+        point.throughput = result.throughput();
+        point.p50_ns = result.latency->valueAtPercentile(50.0);
+        point.p99_ns = result.latency->valueAtPercentile(99.0);
+        point.failures = result.failures;
+        for (const auto& p : phases) {
+            point.phases.add(p);
+        }
+        points.push_back(point);
+        std::cout << " " << static_cast<uint64_t>(point.throughput) << " " << config.rate_label << std::endl;
+
+        Settings settings;
+        settings.push_back(std::make_pair("message_bytes", std::to_string(input.size)));
+        settings.push_back(std::make_pair("chunk_bytes", std::to_string(chunk)));
+        saveResult(config, workload + " " + input.label, result, settings);
+    }
+    return points;
+}
+
+// One row per input: message rate, latency, hash bandwidth and the fixed
+// init+final cost, followed by the size above which hashing dominates.
+void printStreamingTable(std::ostream& out, const RunConfig& config, const std::vector<StreamingPoint>& points);
+
+} // namespace bench
+
+#endif // BENCH_STREAM_OPS_H
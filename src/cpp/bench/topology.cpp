@@ -0,0 +1,327 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bench {
+
+static const char* kCpuRoot = "/sys/devices/system/cpu/cpu";
+
+static bool readIntFile(const std::string& path, int& value) {
+    std::ifstream in(path);
+    return static_cast<bool>(in >> value);
+}
+
+static bool readLine(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return static_cast<bool>(std::getline(in, line));
+}
+
+// Parse a kernel CPU list such as "0-3,8-11".
+static std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::istringstream r(range);
+        if (!(r >> first)) {
+            continue;
+        }
+        if (!(r >> dash >> last) || dash != '-') {
+            last = first;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Lowest CPU sharing `cpu`'s level-3 cache, or -1 if sysfs doesn't say.
+static int l3DomainOf(int cpu) {
+    std::string cache = std::string(kCpuRoot) + std::to_string(cpu) + "/cache/index";
+    for (int index = 0;; index++) {
+        std::string base = cache + std::to_string(index);
+        int level = 0;
+        if (!readIntFile(base + "/level", level)) {
+            return -1;
+        }
+        std::string shared;
+        if (level == 3 && readLine(base + "/shared_cpu_list", shared)) {
+            std::vector<int> cpus = parseCpuList(shared);
+            return cpus.empty() ? -1 : *std::min_element(cpus.begin(), cpus.end());
+        }
+    }
+}
+
+static std::set<int> allowedCpus() {
+    std::set<int> allowed;
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &mask)) {
+                allowed.insert(cpu);
+            }
+        }
+    }
+#endif
+    return allowed;
+}
+
+// The tightest cpu.max along this process's cgroup v2 path, in CPUs.
+static double cgroupCpuLimit() {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    std::string path;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 3, "0::") == 0) {
+            path = line.substr(3);
+            break;
+        }
+    }
+    if (path.empty()) {
+        return 0.0;
+    }
+
+    double limit = 0.0;
+    for (;;) {
+        std::string max;
+        if (readLine("/sys/fs/cgroup" + (path == "/" ? std::string() : path) + "/cpu.max", max)) {
+            std::istringstream fields(max);
+            std::string quota;
+            double period = 0.0;
+            if (fields >> quota >> period && quota != "max" && period > 0.0) {
+                double cpus = std::atof(quota.c_str()) / period;
+                if (cpus > 0.0 && (limit == 0.0 || cpus < limit)) {
+                    limit = cpus;
+                }
+            }
+        }
+        if (path == "/" || path.empty()) {
+            break;
+        }
+        size_t slash = path.find_last_of('/');
+        path = slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+    }
+    return limit;
+}
+
+static CpuTopology discoverTopology() {
+    CpuTopology topology;
+    long configured = sysconf(_SC_NPROCESSORS_CONF);
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    topology.online_cpus = online > 0 ? static_cast<int>(online) : 1;
+    std::set<int> allowed = allowedCpus();
+
+    for (long cpu = 0; cpu < configured; cpu++) {
+        std::string base = std::string(kCpuRoot) + std::to_string(cpu);
+        int is_online = 1;
+        if (readIntFile(base + "/online", is_online) && is_online == 0) {
+            continue;
+        }
+        if (!allowed.empty() && allowed.count(static_cast<int>(cpu)) == 0) {
+            continue;
+        }
+        LogicalCpu entry;
+        entry.cpu = static_cast<int>(cpu);
+        if (!readIntFile(base + "/topology/physical_package_id", entry.package) ||
+            !readIntFile(base + "/topology/core_id", entry.core)) {
+            // No topology files: treat every CPU as its own core
+            entry.package = 0;
+            entry.core = static_cast<int>(cpu);
+        }
+        entry.l3 = l3DomainOf(entry.cpu);
+        topology.cpus.push_back(entry);
+    }
+    if (topology.cpus.empty()) {
+        for (int cpu = 0; cpu < topology.online_cpus; cpu++) {
+            LogicalCpu entry;
+            entry.cpu = cpu;
+            entry.core = cpu;
+            topology.cpus.push_back(entry);
+        }
+    }
+
+    std::map<std::pair<int, int>, int> siblings;
+    std::set<std::pair<int, int>> domains;
+    std::set<int> packages;
+    for (auto& entry : topology.cpus) {
+        int& seen = siblings[std::make_pair(entry.package, entry.core)];
+        entry.smt_rank = seen++;
+        topology.threads_per_core = std::max(topology.threads_per_core, seen);
+        domains.insert(std::make_pair(entry.package, entry.l3));
+        packages.insert(entry.package);
+    }
+    topology.physical_cores = static_cast<int>(siblings.size());
+    topology.l3_domains = static_cast<int>(domains.size());
+    topology.packages = static_cast<int>(packages.size());
+    topology.cgroup_cpu_limit = cgroupCpuLimit();
+    return topology;
+}
+
+int CpuTopology::usableCpus() const {
+    int allowed = static_cast<int>(cpus.size());
+    if (cgroup_cpu_limit > 0.0) {
+        allowed = std::min(allowed, static_cast<int>(std::ceil(cgroup_cpu_limit)));
+    }
+    return std::max(allowed, 1);
+}
+
+const LogicalCpu* CpuTopology::find(int cpu) const {
+    for (const auto& entry : cpus) {
+        if (entry.cpu == cpu) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+const CpuTopology& cpuTopology() {
+    static const CpuTopology topology = discoverTopology();
+    return topology;
+}
+
+void printTopologySummary(std::ostream& out, const CpuTopology& topology) {
+    out << topology.cpus.size() << " CPUs allowed of " << topology.online_cpus << " online, "
+        << topology.physical_cores << " cores x " << topology.threads_per_core << " SMT, " << topology.l3_domains
+        << " L3 domain" << (topology.l3_domains == 1 ? "" : "s") << ", " << topology.packages << " package"
+        << (topology.packages == 1 ? "" : "s");
+    if (topology.cgroup_cpu_limit > 0.0) {
+        out << ", cgroup quota " << topology.cgroup_cpu_limit << " CPUs";
+    }
+}
+
+bool parsePlacement(const std::string& name, Placement& placement) {
+    if (name == "none") {
+        placement = Placement::None;
+    } else if (name == "compact") {
+        placement = Placement::Compact;
+    } else if (name == "scatter") {
+        placement = Placement::Scatter;
+    } else if (name == "physical") {
+        placement = Placement::Physical;
+    } else if (name == "l3") {
+        placement = Placement::L3;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* placementName(Placement placement) {
+    switch (placement) {
+    case Placement::Compact:
+        return "compact";
+    case Placement::Scatter:
+        return "scatter";
+    case Placement::Physical:
+        return "physical";
+    case Placement::L3:
+        return "l3";
+    case Placement::None:
+    default:
+        return "none";
+    }
+}
+
+std::vector<std::vector<int>> placeWorkers(const CpuTopology& topology, Placement placement, int num_threads) {
+    std::vector<std::vector<int>> plan;
+    if (placement == Placement::None || topology.cpus.empty() || num_threads <= 0) {
+        return plan;
+    }
+
+    // Position of each core within its L3 domain, so scatter can deal cores
+    // out across domains like cards
+    typedef std::pair<int, int> Key;
+    std::map<Key, std::set<int>> domain_cores;
+    for (const auto& c : topology.cpus) {
+        domain_cores[Key(c.package, c.l3)].insert(c.core);
+    }
+    std::vector<LogicalCpu> order = topology.cpus;
+    auto coreRank = [&domain_cores](const LogicalCpu& c) {
+        const std::set<int>& cores = domain_cores[Key(c.package, c.l3)];
+        return static_cast<int>(std::distance(cores.begin(), cores.find(c.core)));
+    };
+
+    if (placement == Placement::L3) {
+        std::vector<std::vector<int>> domains;
+        for (const auto& d : domain_cores) {
+            std::vector<int> cpus;
+            for (const auto& c : topology.cpus) {
+                if (Key(c.package, c.l3) == d.first) {
+                    cpus.push_back(c.cpu);
+                }
+            }
+            domains.push_back(cpus);
+        }
+        for (int i = 0; i < num_threads; i++) {
+            plan.push_back(domains[i % domains.size()]);
+        }
+        return plan;
+    }
+
+    if (placement == Placement::Compact) {
+        std::sort(order.begin(), order.end(), [](const LogicalCpu& a, const LogicalCpu& b) {
+            return std::make_tuple(a.package, a.l3, a.core, a.smt_rank) <
+                   std::make_tuple(b.package, b.l3, b.core, b.smt_rank);
+        });
+    } else {
+        std::sort(order.begin(), order.end(), [&coreRank](const LogicalCpu& a, const LogicalCpu& b) {
+            return std::make_tuple(a.smt_rank, coreRank(a), a.package, a.l3) <
+                   std::make_tuple(b.smt_rank, coreRank(b), b.package, b.l3);
+        });
+        if (placement == Placement::Physical) {
+            order.erase(std::remove_if(order.begin(), order.end(),
+                                       [](const LogicalCpu& c) { return c.smt_rank != 0; }),
+                        order.end());
+        }
+    }
+    for (int i = 0; i < num_threads; i++) {
+        plan.push_back(std::vector<int>(1, order[i % order.size()].cpu));
+    }
+    return plan;
+}
+
+bool pinCurrentThread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &mask);
+        }
+    }
+    return !cpus.empty() && pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+int currentCpu() {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,71 @@
+#ifndef BENCH_TOPOLOGY_H
+#define BENCH_TOPOLOGY_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// One logical CPU the process is allowed to run on.
+struct LogicalCpu {
+    int cpu = 0;      // kernel CPU number
+    int package = 0;  // physical_package_id
+    int core = 0;     // core_id, unique within the package
+    int l3 = -1;      // lowest CPU number sharing this CPU's L3; -1 when unknown
+    int smt_rank = 0; // 0 for the lowest-numbered sibling of its core, 1 for the next, ...
+};
+
+// The machine as this process sees it: online CPUs intersected with the
+// sched_getaffinity mask, grouped into cores and L3 domains from sysfs,
+// plus any cgroup v2 CPU quota. sysconf(_SC_NPROCESSORS_ONLN) sees none of
+// the mask, the quota or the SMT sharing.
+struct CpuTopology {
+    std::vector<LogicalCpu> cpus; // allowed CPUs, ordered by CPU number
+    int online_cpus = 0;
+    int physical_cores = 0;       // distinct (package, core) pairs among `cpus`
+    int l3_domains = 0;
+    int packages = 0;
+    int threads_per_core = 1;     // most allowed siblings on any one core
+    double cgroup_cpu_limit = 0.0; // cpu.max quota / period, 0 when unlimited
+
+    // Allowed CPUs, capped by the cgroup quota (rounded up): the parallelism
+    // the process can actually get.
+    int usableCpus() const;
+
+    // The allowed CPU with this kernel number, or nullptr.
+    const LogicalCpu* find(int cpu) const;
+};
+
+// Discovered on first use and cached; thread-safe.
+const CpuTopology& cpuTopology();
+
+// One-line summary, e.g. "8 CPUs allowed of 16 online, 4 cores x 2 SMT, 1 L3 domain".
+void printTopologySummary(std::ostream& out, const CpuTopology& topology);
+
+// Where worker threads are pinned.
+enum class Placement {
+    None,     // leave it to the scheduler (what the tools always did)
+    Compact,  // fill each core's SMT siblings, then the next core in the same L3 domain
+    Scatter,  // one worker per core across all L3 domains and packages first, then the siblings
+    Physical, // one worker per physical core, never on an SMT sibling
+    L3        // round-robin over L3 domains, free to float within the domain
+};
+
+bool parsePlacement(const std::string& name, Placement& placement);
+const char* placementName(Placement placement);
+
+// The CPU set each of `num_threads` workers is pinned to, or an empty vector
+// for Placement::None. When there are more workers than slots the policy
+// wraps around and workers share CPUs.
+std::vector<std::vector<int>> placeWorkers(const CpuTopology& topology, Placement placement, int num_threads);
+
+// Restrict the calling thread to `cpus`. Always fails off Linux.
+bool pinCurrentThread(const std::vector<int>& cpus);
+
+// The CPU the calling thread is running on right now, or -1.
+int currentCpu();
+
+} // namespace bench
+
+#endif // BENCH_TOPOLOGY_H
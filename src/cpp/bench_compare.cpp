@@ -0,0 +1,225 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "bench/rank_test.h"
+#include "bench/results.h"
+
+// Compares two result files written with --output FILE.json, record by
+// record, and flags latency distributions that moved significantly.
+//
+// Records are matched on workload and thread count, which must be unique
+// within each file. For each pair the per-operation latency histograms are
+// compared with a Mann-Whitney U test; a change counts only if it is both
+// significant (p < alpha) and at least `threshold` percent at the median,
+// since with tens of thousands of samples even a 0.1% shift is
+// "significant".
+
+namespace {
+
+struct CompareOptions {
+    double alpha = 0.01;
+    double threshold_percent = 2.0;
+};
+
+enum class Verdict { Same, Slower, Faster, TooFewSamples };
+
+const char* verdictName(Verdict verdict) {
+    switch (verdict) {
+    case Verdict::Slower:
+        return "REGRESSION";
+    case Verdict::Faster:
+        return "improved";
+    case Verdict::TooFewSamples:
+        return "too few samples";
+    case Verdict::Same:
+    default:
+        return "no change";
+    }
+}
+
+uint64_t percentile(const bench::ResultRecord& record, double p) {
+    for (const auto& entry : record.percentiles) {
+        if (entry.first == p) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+double percentChange(double baseline, double candidate) {
+    return baseline > 0.0 ? 100.0 * (candidate - baseline) / baseline : 0.0;
+}
+
+std::string recordKey(const bench::ResultRecord& record) {
+    return record.workload + " @" + std::to_string(record.threads);
+}
+
+// The first key that appears twice in `records`, or "" if there is none
+std::string duplicateKey(const std::vector<bench::ResultRecord>& records) {
+    std::set<std::string> seen;
+    for (const auto& record : records) {
+        std::string key = recordKey(record);
+        if (!seen.insert(key).second) {
+            return key;
+        }
+    }
+    return std::string();
+}
+
+std::string settingsText(const bench::ResultRecord& record) {
+    std::string text;
+    for (const auto& s : record.settings) {
+        text += (text.empty() ? "" : " ") + s.first + "=" + s.second;
+    }
+    return text;
+}
+
+void printSystem(const char* label, const bench::SystemInfo& system) {
+    std::cout << label << system.openssl_version << " on " << system.cpu_model << " (" << system.os << " "
+              << system.arch << ", " << system.usable_cpus << " usable CPUs)" << std::endl;
+}
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <baseline.json> <candidate.json> [options]" << std::endl;
+    std::cout << "  Compare two result files written by the tools with --output FILE.json" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --alpha P             - Significance level of the Mann-Whitney U test (default 0.01)" << std::endl;
+    std::cout << "  --threshold PCT       - Smallest median latency change worth flagging (default 2)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Exit status: 0 if nothing regressed, 1 if any record regressed, 2 on errors" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    CompareOptions options;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--alpha" && i + 1 < argc) {
+            options.alpha = std::atof(argv[++i]);
+            if (options.alpha <= 0.0 || options.alpha >= 1.0) {
+                std::cerr << "Error: --alpha must be between 0 and 1" << std::endl;
+                return 2;
+            }
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            options.threshold_percent = std::atof(argv[++i]);
+            if (options.threshold_percent < 0.0) {
+                std::cerr << "Error: --threshold must not be negative" << std::endl;
+                return 2;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    bench::SystemInfo baseline_system;
+    bench::SystemInfo candidate_system;
+    std::vector<bench::ResultRecord> baseline;
+    std::vector<bench::ResultRecord> candidate;
+    std::string error;
+    if (!bench::loadResults(argv[1], baseline_system, baseline, error) ||
+        !bench::loadResults(argv[2], candidate_system, candidate, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return 2;
+    }
+
+    // A repeated key would pair runs arbitrarily
+    const char* files[] = {argv[1], argv[2]};
+    const std::vector<bench::ResultRecord>* records[] = {&baseline, &candidate};
+    for (int f = 0; f < 2; f++) {
+        std::string key = duplicateKey(*records[f]);
+        if (!key.empty()) {
+            std::cerr << "Error: " << files[f] << " has more than one record for '" << key
+                      << "'; records must be unique by workload and thread count" << std::endl;
+            return 2;
+        }
+    }
+
+    printSystem("Baseline:  ", baseline_system);
+    printSystem("Candidate: ", candidate_system);
+    if (baseline_system.cpu_model != candidate_system.cpu_model) {
+        std::cout << "Warning: the files come from different CPUs" << std::endl;
+    }
+    std::cout << "Mann-Whitney U on per-operation latency, alpha " << options.alpha << ", threshold "
+              << options.threshold_percent << "% at the median" << std::endl;
+    std::cout << std::endl;
+
+    std::map<std::string, const bench::ResultRecord*> baseline_by_key;
+    for (const auto& record : baseline) {
+        baseline_by_key[recordKey(record)] = &record;
+    }
+
+    std::cout << std::left << std::setw(36) << "Workload" << std::right << std::setw(8) << "threads" << std::setw(10)
+              << "rate" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(11) << "P(slower)"
+              << std::setw(11) << "p-value" << "  verdict" << std::endl;
+
+    int regressions = 0;
+    int matched = 0;
+    std::vector<std::string> notes;
+    for (const auto& cand : candidate) {
+        std::string key = recordKey(cand);
+        auto it = baseline_by_key.find(key);
+        if (it == baseline_by_key.end()) {
+            notes.push_back("Only in candidate: " + key);
+            continue;
+        }
+        const bench::ResultRecord& base = *it->second;
+        baseline_by_key.erase(it);
+        matched++;
+        if (settingsText(base) != settingsText(cand)) {
+            notes.push_back("Settings differ for " + key + ": [" + settingsText(base) + "] vs [" +
+                            settingsText(cand) + "]");
+        }
+
+        bench::RankTestResult test = bench::mannWhitneyU(base.buckets, cand.buckets);
+        double median_change = percentChange(static_cast<double>(percentile(base, 50.0)),
+                                             static_cast<double>(percentile(cand, 50.0)));
+        Verdict verdict = Verdict::Same;
+        if (test.n_baseline < 2 || test.n_candidate < 2) {
+            verdict = Verdict::TooFewSamples;
+        } else if (test.p_value < options.alpha && median_change >= options.threshold_percent) {
+            verdict = Verdict::Slower;
+            regressions++;
+        } else if (test.p_value < options.alpha && median_change <= -options.threshold_percent) {
+            verdict = Verdict::Faster;
+        }
+
+        std::cout << std::left << std::setw(36) << cand.workload << std::right << std::setw(8) << cand.threads
+                  << std::fixed << std::setprecision(1) << std::showpos << std::setw(9)
+                  << percentChange(base.throughput, cand.throughput) << "%" << std::setw(9) << median_change << "%"
+                  << std::setw(9)
+                  << percentChange(static_cast<double>(percentile(base, 99.0)),
+                                   static_cast<double>(percentile(cand, 99.0)))
+                  << "%" << std::noshowpos << std::setprecision(3) << std::setw(11) << test.prob_greater
+                  << std::scientific << std::setprecision(2) << std::setw(11) << test.p_value << std::fixed << "  "
+                  << verdictName(verdict) << std::endl;
+    }
+    for (const auto& left : baseline_by_key) {
+        notes.push_back("Only in baseline: " + left.first);
+    }
+
+    std::cout << "rate/p50/p99: candidate change vs baseline (positive latency change is slower); "
+              << "P(slower): chance a candidate operation takes longer than a baseline one" << std::endl;
+    if (!notes.empty()) {
+        std::cout << std::endl;
+        for (const auto& note : notes) {
+            std::cout << note << std::endl;
+        }
+    }
+    std::cout << std::endl;
+    std::cout << matched << " record(s) compared, " << regressions << " regression(s)" << std::endl;
+    return regressions > 0 ? 1 : 0;
+}
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <vector>
 #include <string>
@@ -18,62 +19,40 @@
 #include <sys/utsname.h>
 #include <unistd.h>
 
+#include "bench/cpu_info.h"
+#include "bench/curves.h"
+#include "bench/latency_histogram.h"
+#include "bench/results.h"
+#include "bench/security_matrix.h"
+#include "bench/topology.h"
+
 struct BenchConfig {
     int iterations = 100;
     int rsa_bits = 3072;
     int ec_curve_nid = NID_X9_62_prime256v1; // P-256
     std::string ec_curve_label = "P-256";
+    std::string eddsa_curve = "Ed25519";     // Ed25519 or Ed448
+    bool explicit_fetch = false; // EVP_MD_fetch SHA-256 once instead of EVP_sha256() per init
+    std::string output;          // --output: JSON/CSV results file, as written by the other tools
+    bool matrix = false;         // --matrix: every RSA size and curve below, multi-threaded
+    int threads = 0;             // --threads: matrix workers (0 = every usable CPU)
+    int keygen_samples = 5;      // --keygen-samples: keys per thread in the matrix
+    std::string rsa_sizes = "2048,3072,4096,7680,15360";
+    std::string curves = "P256,P384,P521";
 };
 
 std::string get_cpu_info() {
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    std::string cpu_model = "Unknown";
-    
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("model name") != std::string::npos) {
-            size_t colon = line.find(":");
-            if (colon != std::string::npos) {
-                cpu_model = line.substr(colon + 2);
-                break;
-            }
-        }
-    }
-    return cpu_model;
+    return bench::cpuModelName();
 }
 
 std::string get_cpu_flags() {
-    std::ifstream cpuinfo("/proc/cpuinfo");
-    std::string line;
-    std::string flags = "";
-    
-    while (std::getline(cpuinfo, line)) {
-        if (line.find("flags") != std::string::npos) {
-            size_t colon = line.find(":");
-            if (colon != std::string::npos) {
-                std::string all_flags = line.substr(colon + 2);
-                std::istringstream iss(all_flags);
-                std::string flag;
-                std::string crypto_flags;
-                
-                // Look for crypto-relevant flags
-                while (iss >> flag) {
-                    if (flag == "aes" || flag == "sha_ni" || flag == "avx" || 
-                        flag == "avx2" || flag == "sse4_1" || flag == "sse4_2" ||
-                        flag == "pclmulqdq" || flag == "rdrand" || flag == "rdseed") {
-                        if (!crypto_flags.empty()) crypto_flags += ", ";
-                        crypto_flags += flag;
-                    }
-                }
-                return crypto_flags.empty() ? "none detected" : crypto_flags;
-            }
-        }
-    }
-    return "unavailable";
+    return bench::cpuCryptoFlags();
 }
 
+// CPUs this process can actually use: the affinity mask capped by any
+// cgroup quota, rather than everything online.
 int get_cpu_cores() {
-    return sysconf(_SC_NPROCESSORS_ONLN);
+    return bench::cpuTopology().usableCpus();
 }
 
 void print_system_info() {
@@ -85,7 +64,9 @@ void print_system_info() {
     std::cout << "OS: " << sys_info.sysname << " " << sys_info.release << std::endl;
     std::cout << "Architecture: " << sys_info.machine << std::endl;
     std::cout << "CPU: " << get_cpu_info() << std::endl;
-    std::cout << "CPU Cores: " << get_cpu_cores() << std::endl;
+    std::cout << "CPU Cores: " << get_cpu_cores() << " usable (";
+    bench::printTopologySummary(std::cout, bench::cpuTopology());
+    std::cout << ")" << std::endl;
     std::cout << "Crypto CPU Features: " << get_cpu_flags() << std::endl;
     std::cout << "OpenSSL Version: " << OPENSSL_VERSION_TEXT << std::endl;
     std::cout << std::endl;
@@ -111,7 +92,16 @@ static int curve_from_string(const std::string &name, std::string &label) {
 }
 
 static void print_usage(const char* prog) {
-    std::cout << "Usage: " << prog << " [--iter N] [--rsa BITS] [--curve P256|P384|P521]" << std::endl;
+    std::cout << "Usage: " << prog << " [--iter N] [--rsa BITS] [--curve P256|P384|P521] [--eddsa Ed25519|Ed448] [--fetch implicit|explicit] [--output FILE]" << std::endl;
+    std::cout << "       " << prog << " --matrix [--threads N] [--iter N] [--keygen-samples N] [--rsa-sizes LIST] [--curves LIST] [--output FILE]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  --matrix            - Keygen, sign and verify for every RSA size and curve on N threads," << std::endl;
+    std::cout << "                        tabulated by NIST security strength" << std::endl;
+    std::cout << "  --threads N         - Matrix worker threads (default: every usable CPU)" << std::endl;
+    std::cout << "  --iter N            - Iterations; in the matrix, signatures and verifications per thread" << std::endl;
+    std::cout << "  --keygen-samples N  - Matrix keys generated per thread (default 5; RSA-15360 takes minutes each)" << std::endl;
+    std::cout << "  --rsa-sizes LIST    - Matrix RSA sizes (default 2048,3072,4096,7680,15360; empty for none)" << std::endl;
+    std::cout << "  --curves LIST       - Matrix curves (default P256,P384,P521; Ed25519 and Ed448 also work)" << std::endl;
 }
 
 static BenchConfig parse_args(int argc, char** argv) {
@@ -135,6 +125,40 @@ static BenchConfig parse_args(int argc, char** argv) {
                     std::exit(2);
                 }
             }
+        } else if (arg == "--eddsa") {
+            if (i + 1 < argc) {
+                const bench::CurveInfo* curve = bench::findCurve(bench::signatureCurves(), argv[++i]);
+                if (curve && bench::isEdDSA(*curve)) {
+                    cfg.eddsa_curve = curve->name;
+                } else {
+                    std::cerr << "Unknown EdDSA curve. Supported: Ed25519, Ed448" << std::endl;
+                    print_usage(argv[0]);
+                    std::exit(2);
+                }
+            }
+        } else if (arg == "--fetch") {
+            if (i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "implicit" || mode == "explicit") {
+                    cfg.explicit_fetch = (mode == "explicit");
+                } else {
+                    std::cerr << "Unknown fetch mode. Supported: implicit, explicit" << std::endl;
+                    print_usage(argv[0]);
+                    std::exit(2);
+                }
+            }
+        } else if (arg == "--output" || arg == "-o") {
+            if (i + 1 < argc) cfg.output = argv[++i];
+        } else if (arg == "--matrix") {
+            cfg.matrix = true;
+        } else if (arg == "--threads" || arg == "-t") {
+            if (i + 1 < argc) cfg.threads = std::stoi(argv[++i]);
+        } else if (arg == "--keygen-samples") {
+            if (i + 1 < argc) cfg.keygen_samples = std::stoi(argv[++i]);
+        } else if (arg == "--rsa-sizes") {
+            if (i + 1 < argc) cfg.rsa_sizes = argv[++i];
+        } else if (arg == "--curves") {
+            if (i + 1 < argc) cfg.curves = argv[++i];
         } else if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
             std::exit(0);
@@ -143,16 +167,45 @@ static BenchConfig parse_args(int argc, char** argv) {
     return cfg;
 }
 
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One single-threaded series as a results record; throughput is derived
+// from the summed per-operation times.
+static bool save_result(const BenchConfig& cfg, const std::string& workload, const char* rate_unit,
+                        const bench::LatencyHistogram& hist) {
+    bench::ResultRecord record = bench::resultRecord(workload, rate_unit, hist);
+    record.operations = hist.count();
+    record.elapsed_seconds = hist.sum() / 1e9;
+    record.throughput = record.elapsed_seconds > 0.0 ? record.operations / record.elapsed_seconds : 0.0;
+    record.settings.push_back(std::make_pair("iterations", std::to_string(cfg.iterations)));
+    record.settings.push_back(std::make_pair("fetch", cfg.explicit_fetch ? "explicit" : "implicit"));
+    std::string error;
+    if (!bench::appendResult(cfg.output, record, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
     const int iterations = cfg.iterations;
     unsigned char data[32];
     memset(data, 0xAA, 32); // Simple test data
     
+    // With --fetch explicit every init below reuses one fetched SHA-256
+    // instead of resolving EVP_sha256() through the provider store
+    EVP_MD* fetched_sha256 = cfg.explicit_fetch ? EVP_MD_fetch(nullptr, "SHA256", nullptr) : nullptr;
+    const EVP_MD* sha256 = fetched_sha256 ? fetched_sha256 : EVP_sha256();
+    
     std::cout << "Cryptographic Operation Performance Comparison" << std::endl;
     std::cout << "=============================================" << std::endl;
     std::cout << "Iterations: " << iterations << std::endl;
     std::cout << "RSA Algorithm: RSA-PSS(" << cfg.rsa_bits << ") with SHA-256 and MGF1-SHA256" << std::endl;
     std::cout << "ECDSA Algorithm: ECDSA " << cfg.ec_curve_label << " with SHA-256" << std::endl;
+    std::cout << "EdDSA Algorithm: " << cfg.eddsa_curve << " (one-shot, no separate digest)" << std::endl;
+    std::cout << "Algorithm fetch: " << (fetched_sha256 ? "explicit (EVP_MD_fetch once)" : "implicit (EVP_sha256() per init)") << std::endl;
     std::cout << std::endl;
     
     // RSA Key Generation and Signing (RSA-PSS)
@@ -169,24 +222,27 @@ void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
     // RSA-PSS Signing with SHA-256 and MGF1-SHA256
     EVP_MD_CTX* rsa_md_ctx = EVP_MD_CTX_new();
     EVP_PKEY_CTX* rsa_sign_ctx = nullptr;
-    EVP_DigestSignInit(rsa_md_ctx, &rsa_sign_ctx, EVP_sha256(), nullptr, rsa_key);
+    EVP_DigestSignInit(rsa_md_ctx, &rsa_sign_ctx, sha256, nullptr, rsa_key);
     
     // Configure RSA-PSS parameters
     EVP_PKEY_CTX_set_rsa_padding(rsa_sign_ctx, RSA_PKCS1_PSS_PADDING);
     EVP_PKEY_CTX_set_rsa_pss_saltlen(rsa_sign_ctx, RSA_PSS_SALTLEN_DIGEST);
-    EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_sign_ctx, EVP_sha256());
+    EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_sign_ctx, sha256);
     
     // Store signatures for verification
     std::vector<std::vector<unsigned char>> rsa_signatures(iterations);
     
+    // Every iteration is also timed on its own for the --output histograms
+    bench::LatencyHistogram rsa_sign_hist;
     auto rsa_sign_start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; i++) {
-        EVP_DigestSignInit(rsa_md_ctx, &rsa_sign_ctx, EVP_sha256(), nullptr, rsa_key);
+        auto op_start = std::chrono::steady_clock::now();
+        EVP_DigestSignInit(rsa_md_ctx, &rsa_sign_ctx, sha256, nullptr, rsa_key);
         
         // Re-configure RSA-PSS parameters for each signature
         EVP_PKEY_CTX_set_rsa_padding(rsa_sign_ctx, RSA_PKCS1_PSS_PADDING);
         EVP_PKEY_CTX_set_rsa_pss_saltlen(rsa_sign_ctx, RSA_PSS_SALTLEN_DIGEST);
-        EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_sign_ctx, EVP_sha256());
+        EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_sign_ctx, sha256);
         
         EVP_DigestSignUpdate(rsa_md_ctx, data, 32);
         
@@ -194,6 +250,7 @@ void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
         EVP_DigestSignFinal(rsa_md_ctx, nullptr, &sig_len);
         rsa_signatures[i].resize(sig_len);
         EVP_DigestSignFinal(rsa_md_ctx, rsa_signatures[i].data(), &sig_len);
+        rsa_sign_hist.record(elapsed_ns(op_start));
     }
     auto rsa_sign_end = std::chrono::high_resolution_clock::now();
     
@@ -210,50 +267,96 @@ void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
     
     // ECDSA Signing
     EVP_MD_CTX* ec_md_ctx = EVP_MD_CTX_new();
-    EVP_DigestSignInit(ec_md_ctx, nullptr, EVP_sha256(), nullptr, ec_key);
+    EVP_DigestSignInit(ec_md_ctx, nullptr, sha256, nullptr, ec_key);
     
     // Store signatures for verification
     std::vector<std::vector<unsigned char>> ec_signatures(iterations);
     
+    bench::LatencyHistogram ec_sign_hist;
     auto ec_sign_start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; i++) {
-        EVP_DigestSignInit(ec_md_ctx, nullptr, EVP_sha256(), nullptr, ec_key);
+        auto op_start = std::chrono::steady_clock::now();
+        EVP_DigestSignInit(ec_md_ctx, nullptr, sha256, nullptr, ec_key);
         EVP_DigestSignUpdate(ec_md_ctx, data, 32);
         
         size_t sig_len = 0;
         EVP_DigestSignFinal(ec_md_ctx, nullptr, &sig_len);
         ec_signatures[i].resize(sig_len);
         EVP_DigestSignFinal(ec_md_ctx, ec_signatures[i].data(), &sig_len);
+        ec_sign_hist.record(elapsed_ns(op_start));
+        // DER signatures are often shorter than the size query returns
+        ec_signatures[i].resize(sig_len);
     }
     auto ec_sign_end = std::chrono::high_resolution_clock::now();
     
     // RSA-PSS Verification
     EVP_MD_CTX* rsa_verify_ctx = EVP_MD_CTX_new();
+    bench::LatencyHistogram rsa_verify_hist;
     auto rsa_verify_start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; i++) {
+        auto op_start = std::chrono::steady_clock::now();
         EVP_PKEY_CTX* rsa_verify_pkey_ctx = nullptr;
-        EVP_DigestVerifyInit(rsa_verify_ctx, &rsa_verify_pkey_ctx, EVP_sha256(), nullptr, rsa_key);
+        EVP_DigestVerifyInit(rsa_verify_ctx, &rsa_verify_pkey_ctx, sha256, nullptr, rsa_key);
         
         // Configure RSA-PSS parameters for verification
         EVP_PKEY_CTX_set_rsa_padding(rsa_verify_pkey_ctx, RSA_PKCS1_PSS_PADDING);
         EVP_PKEY_CTX_set_rsa_pss_saltlen(rsa_verify_pkey_ctx, RSA_PSS_SALTLEN_DIGEST);
-        EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_verify_pkey_ctx, EVP_sha256());
+        EVP_PKEY_CTX_set_rsa_mgf1_md(rsa_verify_pkey_ctx, sha256);
         
         EVP_DigestVerifyUpdate(rsa_verify_ctx, data, 32);
         EVP_DigestVerifyFinal(rsa_verify_ctx, rsa_signatures[i].data(), rsa_signatures[i].size());
+        rsa_verify_hist.record(elapsed_ns(op_start));
     }
     auto rsa_verify_end = std::chrono::high_resolution_clock::now();
     
     // ECDSA Verification
     EVP_MD_CTX* ec_verify_ctx = EVP_MD_CTX_new();
+    bench::LatencyHistogram ec_verify_hist;
     auto ec_verify_start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; i++) {
-        EVP_DigestVerifyInit(ec_verify_ctx, nullptr, EVP_sha256(), nullptr, ec_key);
+        auto op_start = std::chrono::steady_clock::now();
+        EVP_DigestVerifyInit(ec_verify_ctx, nullptr, sha256, nullptr, ec_key);
         EVP_DigestVerifyUpdate(ec_verify_ctx, data, 32);
         EVP_DigestVerifyFinal(ec_verify_ctx, ec_signatures[i].data(), ec_signatures[i].size());
+        ec_verify_hist.record(elapsed_ns(op_start));
     }
     auto ec_verify_end = std::chrono::high_resolution_clock::now();
     
+    // EdDSA key generation, signing and verification. EdDSA hashes the
+    // message itself, so there is no digest and no update/final: each
+    // operation is an init with a NULL digest plus one-shot EVP_DigestSign.
+    const bench::CurveInfo* ed_curve = bench::findCurve(bench::signatureCurves(), cfg.eddsa_curve);
+    auto ed_start = std::chrono::high_resolution_clock::now();
+    EVP_PKEY* ed_key = bench::generateCurveKey(*ed_curve);
+    auto ed_keygen_time = std::chrono::high_resolution_clock::now();
+    
+    EVP_MD_CTX* ed_md_ctx = EVP_MD_CTX_new();
+    std::vector<std::vector<unsigned char>> ed_signatures(iterations);
+    bench::LatencyHistogram ed_sign_hist;
+    auto ed_sign_start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        auto op_start = std::chrono::steady_clock::now();
+        EVP_DigestSignInit(ed_md_ctx, nullptr, nullptr, nullptr, ed_key);
+        
+        size_t sig_len = 0;
+        EVP_DigestSign(ed_md_ctx, nullptr, &sig_len, data, 32);
+        ed_signatures[i].resize(sig_len);
+        EVP_DigestSign(ed_md_ctx, ed_signatures[i].data(), &sig_len, data, 32);
+        ed_sign_hist.record(elapsed_ns(op_start));
+    }
+    auto ed_sign_end = std::chrono::high_resolution_clock::now();
+    
+    EVP_MD_CTX* ed_verify_ctx = EVP_MD_CTX_new();
+    bench::LatencyHistogram ed_verify_hist;
+    auto ed_verify_start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        auto op_start = std::chrono::steady_clock::now();
+        EVP_DigestVerifyInit(ed_verify_ctx, nullptr, nullptr, nullptr, ed_key);
+        EVP_DigestVerify(ed_verify_ctx, ed_signatures[i].data(), ed_signatures[i].size(), data, 32);
+        ed_verify_hist.record(elapsed_ns(op_start));
+    }
+    auto ed_verify_end = std::chrono::high_resolution_clock::now();
+    
     // Calculate timings
     auto rsa_keygen_ms = std::chrono::duration_cast<std::chrono::milliseconds>(rsa_keygen_time - start).count();
     auto rsa_sign_ms = std::chrono::duration_cast<std::chrono::microseconds>(rsa_sign_end - rsa_sign_start).count();
@@ -263,27 +366,63 @@ void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
     auto ec_sign_ms = std::chrono::duration_cast<std::chrono::microseconds>(ec_sign_end - ec_sign_start).count();
     auto ec_verify_ms = std::chrono::duration_cast<std::chrono::microseconds>(ec_verify_end - ec_verify_start).count();
     
+    auto ed_keygen_ms = std::chrono::duration_cast<std::chrono::microseconds>(ed_keygen_time - ed_start).count();
+    auto ed_sign_ms = std::chrono::duration_cast<std::chrono::microseconds>(ed_sign_end - ed_sign_start).count();
+    auto ed_verify_ms = std::chrono::duration_cast<std::chrono::microseconds>(ed_verify_end - ed_verify_start).count();
+    
     std::cout << "Key Generation Performance:" << std::endl;
     std::cout << "  RSA-" << cfg.rsa_bits << ":  " << rsa_keygen_ms << " ms" << std::endl;
     std::cout << "  EC " << cfg.ec_curve_label << ":  " << ec_keygen_ms / 1000.0 << " ms" << std::endl;
+    std::cout << "  " << cfg.eddsa_curve << ":  " << ed_keygen_ms / 1000.0 << " ms" << std::endl;
     std::cout << "  Speed Ratio: " << (double)rsa_keygen_ms / (ec_keygen_ms / 1000.0) << "x faster" << std::endl;
     std::cout << std::endl;
     
     std::cout << "Signing Performance (" << iterations << " signatures):" << std::endl;
     std::cout << "  RSA-PSS-" << cfg.rsa_bits << ": " << rsa_sign_ms << " μs total (" << rsa_sign_ms / iterations << " μs/sig)" << std::endl;
     std::cout << "  ECDSA-" << cfg.ec_curve_label << ":    " << ec_sign_ms << " μs total (" << ec_sign_ms / iterations << " μs/sig)" << std::endl;
+    std::cout << "  " << cfg.eddsa_curve << ":      " << ed_sign_ms << " μs total (" << ed_sign_ms / iterations << " μs/sig)" << std::endl;
     std::cout << "  Speed Ratio: " << (double)rsa_sign_ms / ec_sign_ms << "x faster" << std::endl;
     std::cout << std::endl;
     
     std::cout << "Verification Performance (" << iterations << " verifications):" << std::endl;
     std::cout << "  RSA-PSS-" << cfg.rsa_bits << ": " << rsa_verify_ms << " μs total (" << rsa_verify_ms / iterations << " μs/verify)" << std::endl;
     std::cout << "  ECDSA-" << cfg.ec_curve_label << ":    " << ec_verify_ms << " μs total (" << ec_verify_ms / iterations << " μs/verify)" << std::endl;
+    std::cout << "  " << cfg.eddsa_curve << ":      " << ed_verify_ms << " μs total (" << ed_verify_ms / iterations << " μs/verify)" << std::endl;
     std::cout << "  Speed Ratio: " << (double)rsa_verify_ms / ec_verify_ms << "x faster" << std::endl;
     std::cout << std::endl;
     
+    // Median per-operation times from the histograms, so one slow outlier
+    // doesn't skew the comparison
+    std::string rsa_name = "RSA-PSS-" + std::to_string(cfg.rsa_bits);
+    std::string ecdsa_name = "ECDSA-" + cfg.ec_curve_label;
+    std::cout << "Side by side (median μs per operation; keygen is a single key):" << std::endl;
+    std::cout << "  " << std::left << std::setw(16) << "Algorithm" << std::right << std::setw(12) << "keygen"
+              << std::setw(12) << "sign" << std::setw(12) << "verify" << std::setw(14) << "sigs/s" << std::endl;
+    struct Row {
+        const std::string& name;
+        double keygen_us;
+        const bench::LatencyHistogram& sign;
+        const bench::LatencyHistogram& verify;
+    };
+    const Row rows[] = {
+        {rsa_name, rsa_keygen_ms * 1000.0, rsa_sign_hist, rsa_verify_hist},
+        {ecdsa_name, static_cast<double>(ec_keygen_ms), ec_sign_hist, ec_verify_hist},
+        {cfg.eddsa_curve, static_cast<double>(ed_keygen_ms), ed_sign_hist, ed_verify_hist},
+    };
+    for (const Row& row : rows) {
+        double sign_us = row.sign.valueAtPercentile(50.0) / 1000.0;
+        std::cout << "  " << std::left << std::setw(16) << row.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << row.keygen_us << std::setw(12) << sign_us << std::setw(12)
+                  << row.verify.valueAtPercentile(50.0) / 1000.0 << std::setw(14)
+                  << (sign_us > 0.0 ? 1e6 / sign_us : 0.0) << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6) << std::endl;
+    
     std::cout << "Algorithm Details:" << std::endl;
     std::cout << "  RSA-PSS: PKCS#1 v2.1 with SHA-256, MGF1-SHA256, salt length = digest length" << std::endl;
     std::cout << "  ECDSA: " << cfg.ec_curve_label << " curve with SHA-256 hash" << std::endl;
+    std::cout << "  EdDSA: " << cfg.eddsa_curve << " (RFC 8032), deterministic; hashes the message internally" << std::endl;
     std::cout << std::endl;
     
     std::cout << "Mathematical Complexity Analysis:" << std::endl;
@@ -314,23 +453,89 @@ void benchmark_rsa_vs_ecdsa(const BenchConfig& cfg) {
     std::cout << "  Explanation: RSA uses small public exponent (65537) vs large private key" << std::endl;
     std::cout << "               ECDSA operations have similar computational complexity" << std::endl;
     
+    if (!cfg.output.empty()) {
+        bench::LatencyHistogram rsa_keygen_hist;
+        bench::LatencyHistogram ec_keygen_hist;
+        bench::LatencyHistogram ed_keygen_hist;
+        rsa_keygen_hist.record(std::chrono::duration_cast<std::chrono::nanoseconds>(rsa_keygen_time - start).count());
+        ec_keygen_hist.record(std::chrono::duration_cast<std::chrono::nanoseconds>(ec_keygen_time - ec_start).count());
+        ed_keygen_hist.record(std::chrono::duration_cast<std::chrono::nanoseconds>(ed_keygen_time - ed_start).count());
+        bool ok = save_result(cfg, "crypto_benchmark keygen RSA-" + std::to_string(cfg.rsa_bits), "keys/s",
+                              rsa_keygen_hist) &&
+                  save_result(cfg, "crypto_benchmark keygen EC " + cfg.ec_curve_label, "keys/s", ec_keygen_hist) &&
+                  save_result(cfg, "crypto_benchmark keygen " + cfg.eddsa_curve, "keys/s", ed_keygen_hist) &&
+                  save_result(cfg, "crypto_benchmark sign " + rsa_name, "sigs/s", rsa_sign_hist) &&
+                  save_result(cfg, "crypto_benchmark sign " + ecdsa_name, "sigs/s", ec_sign_hist) &&
+                  save_result(cfg, "crypto_benchmark sign " + cfg.eddsa_curve, "sigs/s", ed_sign_hist) &&
+                  save_result(cfg, "crypto_benchmark verify " + rsa_name, "verifies/s", rsa_verify_hist) &&
+                  save_result(cfg, "crypto_benchmark verify " + ecdsa_name, "verifies/s", ec_verify_hist) &&
+                  save_result(cfg, "crypto_benchmark verify " + cfg.eddsa_curve, "verifies/s", ed_verify_hist);
+        if (ok) {
+            std::cout << std::endl << "Results written to " << cfg.output << std::endl;
+        }
+    }
+    
     // Cleanup
     EVP_PKEY_free(rsa_key);
     EVP_PKEY_free(ec_key);
+    EVP_PKEY_free(ed_key);
     EVP_PKEY_CTX_free(rsa_ctx);
     EVP_PKEY_CTX_free(ec_ctx);
     EVP_MD_CTX_free(rsa_md_ctx);
     EVP_MD_CTX_free(ec_md_ctx);
     EVP_MD_CTX_free(rsa_verify_ctx);
     EVP_MD_CTX_free(ec_verify_ctx);
+    EVP_MD_CTX_free(ed_md_ctx);
+    EVP_MD_CTX_free(ed_verify_ctx);
+    EVP_MD_free(fetched_sha256);
+}
+
+// Every RSA size and curve at the same thread count, one engine run per
+// algorithm and operation, with the results grouped by security strength.
+int benchmark_security_matrix(const BenchConfig& cfg) {
+    std::vector<bench::MatrixAlgorithm> algorithms;
+    std::string error;
+    if (!bench::parseMatrixAlgorithms(cfg.rsa_sizes, cfg.curves, algorithms, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return 2;
+    }
+    if (cfg.iterations < 1 || cfg.keygen_samples < 1 || cfg.threads < 0) {
+        std::cerr << "Error: --iter and --keygen-samples must be at least 1, --threads at least 0" << std::endl;
+        return 2;
+    }
+
+    bench::RunConfig config;
+    config.num_threads = cfg.threads > 0 ? cfg.threads : get_cpu_cores();
+    config.results_output = cfg.output;
+
+    std::cout << "Security Strength Matrix" << std::endl;
+    std::cout << "========================" << std::endl;
+    std::cout << "Threads: " << config.num_threads << std::endl;
+    std::cout << "Per thread: " << cfg.keygen_samples << " keys, " << cfg.iterations
+              << " signatures and verifications" << std::endl;
+    std::cout << "RSA: RSA-PSS with SHA-256 and MGF1-SHA256; EC: ECDSA with SHA-256, EdDSA one-shot" << std::endl;
+    std::cout << std::endl;
+
+    std::vector<bench::MatrixRow> rows = bench::runSecurityMatrix(std::cout, config, algorithms, cfg.iterations,
+                                                                  cfg.keygen_samples);
+    bench::printSecurityMatrix(std::cout, config, rows);
+    if (!cfg.output.empty()) {
+        std::cout << std::endl << "Results written to " << cfg.output << std::endl;
+    }
+    return 0;
 }
 
 int main(int argc, char** argv) {
     ERR_load_crypto_strings();
     BenchConfig cfg = parse_args(argc, argv);
     print_system_info();
-    benchmark_rsa_vs_ecdsa(cfg);
+    int status = 0;
+    if (cfg.matrix) {
+        status = benchmark_security_matrix(cfg);
+    } else {
+        benchmark_rsa_vs_ecdsa(cfg);
+    }
     
     ERR_free_strings();
-    return 0;
+    return status;
 }
@@ -0,0 +1,305 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+
+#include "bench/agreement_ops.h"
+#include "bench/curves.h"
+#include "bench/engine.h"
+#include "bench/library_context.h"
+#include "bench/openssl_util.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/scaling.h"
+
+// Options specific to ecdh_agreement
+struct AgreementOptions {
+    std::vector<bench::AgreementMode> modes = {bench::AgreementMode::Ephemeral, bench::AgreementMode::Static};
+};
+
+class ECDHAgreement {
+private:
+    bench::RunConfig config;
+    AgreementOptions options;
+    std::vector<bench::HandshakeTimes> times; // one slot per worker
+    std::vector<bench::AgreementResult> results;
+
+public:
+    explicit ECDHAgreement(const bench::RunConfig& run_config = bench::RunConfig(),
+                           const AgreementOptions& agreement_options = AgreementOptions())
+        : config(run_config), options(agreement_options) {}
+
+    std::vector<std::string> supportedCurves() const {
+        std::vector<std::string> names;
+        for (const auto& curve : bench::agreementCurves()) {
+            names.push_back(curve.name);
+        }
+        return names;
+    }
+
+    // Called on each worker thread: a keygen context reused for every
+    // handshake, and the worker's own copy of the peer's public key
+    std::unique_ptr<bench::EphemeralAgreementOperation> createEphemeralOperation(const bench::CurveInfo& curve,
+                                                                                 EVP_PKEY* peer,
+                                                                                 bench::HandshakeTimes* sink) {
+        bench::LibraryContext* libctx = bench::threadLibraryContext();
+        OSSL_LIB_CTX* ctx = libctx ? libctx->get() : nullptr;
+        EVP_PKEY_CTX* keygen_ctx = bench::newCurveKeygenContext(curve, ctx);
+        EVP_PKEY* thread_peer = bench::copyKeyForThread(peer);
+        if (!keygen_ctx || !thread_peer) {
+            std::cerr << "Failed to set up " << curve.name << " key agreement for thread" << std::endl;
+            EVP_PKEY_CTX_free(keygen_ctx);
+            EVP_PKEY_free(thread_peer);
+            return nullptr;
+        }
+        return std::unique_ptr<bench::EphemeralAgreementOperation>(
+            new bench::EphemeralAgreementOperation(keygen_ctx, thread_peer, ctx, sink));
+    }
+
+    // Called on each worker thread: the worker's own static key, agreeing
+    // with a copy of the shared peer key
+    std::unique_ptr<bench::StaticAgreementOperation> createStaticOperation(const bench::CurveInfo& curve,
+                                                                           EVP_PKEY* peer,
+                                                                           bench::HandshakeTimes* sink) {
+        bench::LibraryContext* libctx = bench::threadLibraryContext();
+        OSSL_LIB_CTX* ctx = libctx ? libctx->get() : nullptr;
+        EVP_PKEY* key = bench::generateCurveKey(curve, ctx);
+        EVP_PKEY* thread_peer = bench::copyKeyForThread(peer);
+        if (!key || !thread_peer) {
+            std::cerr << "Failed to set up " << curve.name << " key agreement for thread" << std::endl;
+            EVP_PKEY_free(key);
+            EVP_PKEY_free(thread_peer);
+            return nullptr;
+        }
+        std::unique_ptr<bench::StaticAgreementOperation> op(
+            new bench::StaticAgreementOperation(key, thread_peer, ctx, sink));
+        if (!op->valid()) {
+            std::cerr << "Failed to create derive context for thread" << std::endl;
+            return nullptr;
+        }
+        return op;
+    }
+
+    void run(const std::string& curve_name, int num_threads, int num_loops) {
+        const bench::CurveInfo* curve = bench::findCurve(bench::agreementCurves(), curve_name);
+        if (!curve) {
+            std::cerr << "Error: Unsupported curve '" << curve_name << "'" << std::endl;
+            std::cerr << "Supported curves: P256, P384, P521, X25519, X448" << std::endl;
+            return;
+        }
+
+        std::cout << "Starting key agreement performance test with:" << std::endl;
+        std::cout << "Curve: " << curve->name << " (" << curve->description << ")" << std::endl;
+        std::cout << "Threads: " << num_threads << std::endl;
+        std::cout << "Stats collection: " << bench::statsModeName(config.stats_mode) << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Loops per thread: " << num_loops << std::endl;
+            std::cout << "Total operations per mode: " << (num_threads * num_loops) << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        std::cout << "Modes:";
+        for (bench::AgreementMode mode : options.modes) {
+            std::cout << " " << bench::agreementModeName(mode);
+        }
+        std::cout << std::endl;
+        std::cout << "Library context: "
+                  << (config.compare_libctx ? "shared vs isolated" : bench::libCtxModeName(config.libctx_mode))
+                  << std::endl;
+        std::cout << std::endl;
+
+        // The other side of every agreement; each worker derives against its own copy
+        EVP_PKEY* peer = bench::generateCurveKey(*curve);
+        if (!peer) {
+            bench::reportOpenSSLError("Failed to generate the peer key");
+            return;
+        }
+
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+        for (bench::AgreementMode mode : options.modes) {
+            std::string workload = std::string("ecdh_agreement ") + bench::agreementModeName(mode) + " " + curve->name;
+            if (mode == bench::AgreementMode::Ephemeral) {
+                config.unit_label = "Handshakes";
+                config.rate_label = "handshakes/s";
+                std::cout << "Ephemeral key generation + derive:" << std::endl;
+                execute(*curve, mode, workload, [this, curve, peer](int thread_index) {
+                    return createEphemeralOperation(*curve, peer, &times[thread_index]);
+                });
+            } else {
+                config.unit_label = "Derives";
+                config.rate_label = "derives/s";
+                std::cout << "Static-static derive:" << std::endl;
+                execute(*curve, mode, workload, [this, curve, peer](int thread_index) {
+                    return createStaticOperation(*curve, peer, &times[thread_index]);
+                });
+            }
+            std::cout << std::endl;
+        }
+        EVP_PKEY_free(peer);
+    }
+
+    // Every curve and mode measured so far, side by side
+    void printSummary() {
+        if (results.size() > 1) {
+            std::cout << "Key agreement summary:";
+            bench::printAgreementTable(std::cout, results);
+        }
+    }
+
+    void listSupportedCurves() {
+        std::cout << "Supported key agreement curves:" << std::endl;
+        for (const auto& curve : bench::agreementCurves()) {
+            std::cout << "  " << std::left << std::setw(7) << curve.name << std::right << "- " << curve.description
+                      << std::endl;
+        }
+    }
+
+private:
+    template <typename OpFactory>
+    void execute(const bench::CurveInfo& curve, bench::AgreementMode mode, const std::string& workload,
+                 OpFactory make_op) {
+        times.assign(config.num_threads, bench::HandshakeTimes());
+        if (config.rate_sweep) {
+            bench::runRateSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.async_sweep) {
+            bench::compareAsyncJobs(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.compare_libctx) {
+            bench::compareLibraryContexts(std::cout, config, make_op);
+            return;
+        }
+        if (config.sweep) {
+            bench::runSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        bench::RunResult result = bench::run(config, make_op);
+        bench::printRunReport(std::cout, config, result);
+        bench::saveResult(config, workload, result);
+
+        bench::AgreementResult row;
+        row.curve = curve.name;
+        row.mode = mode;
+        row.throughput = result.throughput();
+        row.p50_ns = result.latency->valueAtPercentile(50.0);
+        row.p99_ns = result.latency->valueAtPercentile(99.0);
+        row.p999_ns = result.latency->valueAtPercentile(99.9);
+        row.failures = result.failures;
+        for (const auto& t : times) {
+            row.times.add(t);
+        }
+        results.push_back(row);
+    }
+};
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <curve> <num_threads> <num_loops> [options]" << std::endl;
+    std::cout << "  curve       - Curve name (P256, P384, P521, X25519, X448, or ALL)" << std::endl;
+    std::cout << "  num_threads - Number of worker threads" << std::endl;
+    std::cout << "  num_loops   - Number of operations per thread for each mode" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --mode ephemeral|static|both" << std::endl;
+    std::cout << "                        - Ephemeral: generate a key pair and derive per handshake, as an" << std::endl;
+    std::cout << "                          (EC)DHE server does; static: derive only, between two long-lived" << std::endl;
+    std::cout << "                          keys. Default: both, one run each" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " X25519 4 5000               # Ephemeral and static X25519, 4 threads" << std::endl;
+    std::cout << "  " << program_name << " ALL 8 2000 --mode ephemeral  # Handshake cost for every curve" << std::endl;
+    std::cout << "  " << program_name << " P256 8 2000 --mode static --sweep" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Use '" << program_name << " --curves' to list supported curves" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && (std::string(argv[1]) == "--curves" || std::string(argv[1]) == "-c")) {
+        ECDHAgreement agreement;
+        agreement.listSupportedCurves();
+        return 0;
+    }
+
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string curve_name = argv[1];
+    int num_threads = std::atoi(argv[2]);
+    int num_loops = std::atoi(argv[3]);
+
+    // Convert to uppercase for consistency
+    std::transform(curve_name.begin(), curve_name.end(), curve_name.begin(), ::toupper);
+
+    if (num_threads < 1 || num_threads > 100) {
+        std::cerr << "Error: Number of threads must be between 1 and 100" << std::endl;
+        return 1;
+    }
+
+    if (num_loops < 1) {
+        std::cerr << "Error: Number of loops must be at least 1" << std::endl;
+        return 1;
+    }
+
+    bench::RunConfig config;
+    AgreementOptions options;
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--mode" && bench::optionValue(argc, argv, i, value)) {
+            if (value == "ephemeral") {
+                options.modes = {bench::AgreementMode::Ephemeral};
+            } else if (value == "static") {
+                options.modes = {bench::AgreementMode::Static};
+            } else if (value != "both") {
+                std::cerr << "Error: --mode must be ephemeral, static or both" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Initialize OpenSSL
+    ERR_load_crypto_strings();
+
+    ECDHAgreement agreement(config, options);
+    std::vector<std::string> curves;
+    if (curve_name == "ALL") {
+        curves = agreement.supportedCurves();
+    } else {
+        curves.push_back(curve_name);
+    }
+    for (size_t i = 0; i < curves.size(); i++) {
+        if (i > 0) {
+            std::cout << std::endl;
+        }
+        agreement.run(curves[i], num_threads, num_loops);
+    }
+    agreement.printSummary();
+
+    // Cleanup OpenSSL
+    ERR_free_strings();
+
+    return 0;
+}
@@ -1,292 +1,364 @@
 #include <iostream>
-#include <vector>
-#include <thread>
-#include <atomic>
-#include <chrono>
-#include <mutex>
-#include <iomanip>
+#include <memory>
 #include <algorithm>
-#include <string>
-#include <map>
+#include <iomanip>
 #include <random>
-#include <openssl/ec.h>
+#include <string>
+#include <vector>
 #include <openssl/evp.h>
 #include <openssl/err.h>
 #include <openssl/rand.h>
 
-class ECDSASigner {
+#include "bench/algorithms.h"
+#include "bench/curves.h"
+#include "bench/engine.h"
+#include "bench/key_working_set.h"
+#include "bench/library_context.h"
+#include "bench/openssl_util.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/scaling.h"
+#include "bench/signature_ops.h"
+#include "bench/signer.h"
+#include "bench/stream_ops.h"
+
+// --keys: sign or verify over a shared set of keys instead of one per thread
+struct WorkingSetOptions {
+    size_t keys = 1;              // --keys: shared working set of keys; 1 keeps the per-thread key
+    bool sweep = false;           // --keys-sweep: 1, 4, 16, ... keys up to --keys
+    bench::KeyAccess access = bench::KeyAccess::Uniform;
+    double zipf_exponent = 1.0;
+
+    bool enabled() const { return keys > 1 || sweep; }
+};
+
+class ECDSASigner : public bench::SignerBench {
 private:
-    uint64_t total_signatures_generated{0};
-    uint64_t total_time_microseconds{0};
-    uint64_t min_time_microseconds{0};
-    uint64_t max_time_microseconds{0};
-    bool first_signature_generated{false};
-    std::mutex stats_mutex;
-    std::chrono::steady_clock::time_point start_time;
-    
-    // Mapping of curve names to OpenSSL NID constants
-    std::map<std::string, int> curve_map = {
-        {"P256", NID_X9_62_prime256v1},
-        {"P384", NID_secp384r1},
-        {"P521", NID_secp521r1}
-    };
+    WorkingSetOptions working_set;
     
+    static const size_t kMessageSize = 32;
+
 public:
-    ECDSASigner() {
-        start_time = std::chrono::steady_clock::now();
-        min_time_microseconds = 0;
-        max_time_microseconds = 0;
-        first_signature_generated = false;
+    explicit ECDSASigner(const bench::RunConfig& run_config = bench::RunConfig(),
+                         const bench::SignerOptions& signer_options = bench::SignerOptions(),
+                         const WorkingSetOptions& working_set_options = WorkingSetOptions())
+        : SignerBench(run_config, signer_options, bench::SignatureParams()), working_set(working_set_options) {}
+    
+    std::vector<std::string> supportedCurves() const {
+        std::vector<std::string> names;
+        for (const auto& curve : bench::signatureCurves()) {
+            names.push_back(curve.name);
+        }
+        return names;
+    }
+    
+    EVP_PKEY* createECKey(const bench::CurveInfo& curve) {
+        bench::LibraryContext* libctx = bench::threadLibraryContext();
+        return bench::generateCurveKey(curve, libctx ? libctx->get() : nullptr);
     }
     
-    EVP_PKEY* createECKey(const std::string& curve_name) {
-        auto it = curve_map.find(curve_name);
-        if (it == curve_map.end()) {
-            std::cerr << "Unsupported curve: " << curve_name << std::endl;
+    // Called on each worker thread: one EC key and signing context per thread
+    std::unique_ptr<bench::SignOperation> createSignOperation(const bench::CurveInfo& curve,
+                                                              const bench::SignatureParams& op_params,
+                                                              bench::ContextStrategy strategy,
+                                                              bench::PhaseTimes* phase_sink) {
+        EVP_PKEY* ec_key = createECKey(curve);
+        if (!ec_key) {
+            std::cerr << "Failed to create EC key for thread" << std::endl;
             return nullptr;
         }
         
-        int curve_nid = it->second;
-        
-        EVP_PKEY_CTX* pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
-        if (!pctx) {
+        std::unique_ptr<bench::SignOperation> op(new bench::SignOperation(ec_key, op_params, kMessageSize, strategy, phase_sink));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
             return nullptr;
         }
-        
-        if (EVP_PKEY_keygen_init(pctx) <= 0) {
-            EVP_PKEY_CTX_free(pctx);
+        return op;
+    }
+    
+    // Called on each worker thread: a private copy of the key and a verify context
+    std::unique_ptr<bench::VerifyOperation> createVerifyOperation(EVP_PKEY* key, const bench::SignatureCorpus& corpus,
+                                                                  const bench::SignatureParams& op_params,
+                                                                  int thread_index, int num_threads) {
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy EC key for thread" << std::endl;
             return nullptr;
         }
         
-        if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, curve_nid) <= 0) {
-            EVP_PKEY_CTX_free(pctx);
+        size_t start = corpus.size() * thread_index / num_threads;
+        std::unique_ptr<bench::VerifyOperation> op(new bench::VerifyOperation(thread_key, op_params, corpus, start));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
             return nullptr;
         }
-        
-        EVP_PKEY* pkey = nullptr;
-        if (EVP_PKEY_keygen(pctx, &pkey) <= 0) {
-            EVP_PKEY_CTX_free(pctx);
+        return op;
+    }
+    
+    // Called on each worker thread: a private copy of the key streaming one message
+    std::unique_ptr<bench::StreamOperation> createStreamOperation(EVP_PKEY* key, const bench::MessageInput& input,
+                                                                  const std::vector<unsigned char>* signature,
+                                                                  bench::PhaseTimes* phase_sink) {
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy EC key for thread" << std::endl;
             return nullptr;
         }
         
-        EVP_PKEY_CTX_free(pctx);
-        return pkey;
+        std::unique_ptr<bench::StreamOperation> op(new bench::StreamOperation(
+            thread_key, paramsFor(options.fetch_mode), input, options.streaming.chunk, signature, phase_sink));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
+            return nullptr;
+        }
+        return op;
     }
     
-    void updateStats(uint64_t time_microseconds) {
-        // Use mutex to protect all statistics for consistency
-        std::lock_guard<std::mutex> lock(stats_mutex);
-        
-        // Sanity check: reject clearly invalid timing values
-        // EC signing should never take more than 1 second (1,000,000 microseconds)
-        if (time_microseconds == 0 || time_microseconds > 1000000ULL) {
-            return; // Skip this invalid measurement
+    void run(const std::string& curve_name, int num_threads, int num_loops) {
+        // Validate curve name
+        const bench::CurveInfo* curve = bench::findCurve(bench::signatureCurves(), curve_name);
+        if (!curve) {
+            std::cerr << "Error: Unsupported curve '" << curve_name << "'" << std::endl;
+            std::cerr << "Supported curves: P256, P384, P521, Ed25519, Ed448" << std::endl;
+            return;
         }
+        // EdDSA signs the message whole: no digest, update or separate hash step
+        bool eddsa = bench::isEdDSA(*curve);
+        if (eddsa && (options.streaming.enabled() || options.compare_strategies ||
+                      options.strategy == bench::ContextStrategy::Prehash)) {
+            std::cerr << "Error: " << curve->name << " is EdDSA, which signs in one shot; --message-size, --file"
+                      << " and --ctx prehash/all need ECDSA" << std::endl;
+            return;
+        }
+        params.one_shot = eddsa;
         
-        total_signatures_generated++;
-        total_time_microseconds += time_microseconds;
-        
-        if (!first_signature_generated) {
-            min_time_microseconds = time_microseconds;
-            max_time_microseconds = time_microseconds;
-            first_signature_generated = true;
-        } else {
-            if (time_microseconds < min_time_microseconds) {
-                min_time_microseconds = time_microseconds;
-            }
-            if (time_microseconds > max_time_microseconds) {
-                max_time_microseconds = time_microseconds;
+        std::cout << "Starting " << (eddsa ? "EdDSA " : "EC-DSA ") << (options.verify ? "verification" : "signing")
+                  << " performance test with:" << std::endl;
+        std::cout << "Curve: " << curve->name << std::endl;
+        std::cout << "Threads: " << num_threads << std::endl;
+        std::cout << "Stats collection: " << bench::statsModeName(config.stats_mode) << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Loops per thread: " << num_loops << std::endl;
+            std::cout << (options.verify ? "Total verifications: " : "Total signatures to generate: ")
+                      << (num_threads * num_loops) << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        if (options.streaming.enabled()) {
+            std::cout << (options.streaming.file.empty() ? "Messages: " : "Message: ") << messages.describe()
+                      << ", fed in " << bench::formatByteSize(options.streaming.chunk) << " chunks" << std::endl;
+        } else if (working_set.enabled()) {
+            std::cout << "Key working set: " << working_set.keys << " shared keys, "
+                      << bench::keyAccessName(working_set.access);
+            if (working_set.access == bench::KeyAccess::Zipf) {
+                std::cout << " (s = " << working_set.zipf_exponent << ")";
             }
+            std::cout << " access" << (working_set.sweep ? ", swept from 1 key" : "") << std::endl;
+            std::cout << (options.verify ? "Messages: one 32-byte message signed per key, up front"
+                                         : "Data size: 32 bytes (random data per signature)") << std::endl;
+        } else if (options.verify) {
+            std::cout << "Corpus: " << options.corpus_size << " distinct 32-byte messages, signed up front" << std::endl;
+        } else {
+            std::cout << "Data size: 32 bytes (random data per signature)" << std::endl;
         }
-    }
-    
-    void workerThread(const std::string& curve_name, int num_loops) {
-        // Create one EC key per thread before the loop starts
-        EVP_PKEY* ec_key = createECKey(curve_name);
-        if (!ec_key) {
-            std::cerr << "Failed to create EC key for thread" << std::endl;
-            return;
+        std::cout << "Hash algorithm: " << (eddsa ? "none (EdDSA, one-shot EVP_DigestSign)" : "SHA-256") << std::endl;
+        std::cout << "Library context: "
+                  << (config.compare_libctx ? "shared vs isolated" : bench::libCtxModeName(config.libctx_mode))
+                  << std::endl;
+        std::cout << "Algorithm fetch: "
+                  << (eddsa ? "n/a (EdDSA)"
+                            : options.compare_fetch ? "implicit vs explicit" : bench::fetchModeName(options.fetch_mode))
+                  << std::endl;
+        if (!options.verify) {
+            std::cout << "Context strategy: "
+                      << (options.compare_strategies ? "all" : bench::contextStrategyName(options.strategy)) << std::endl;
         }
+        std::cout << std::endl;
         
-        // Create signing context
-        EVP_MD_CTX* md_ctx = EVP_MD_CTX_new();
-        if (!md_ctx) {
-            EVP_PKEY_free(ec_key);
-            std::cerr << "Failed to create MD context for thread" << std::endl;
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+        workload = std::string("ecdsa_signer ") + (options.verify ? "verify " : "sign ") + curve->name;
+        
+        const char* signature_name = eddsa ? curve->key_type : "ECDSA";
+        if (!fetchAlgorithms(signature_name)) {
+            bench::reportOpenSSLError(std::string("Failed to fetch SHA-256 and ") + signature_name);
             return;
         }
         
-        // Initialize for signing with SHA-256
-        if (EVP_DigestSignInit(md_ctx, nullptr, EVP_sha256(), nullptr, ec_key) <= 0) {
-            EVP_MD_CTX_free(md_ctx);
-            EVP_PKEY_free(ec_key);
-            std::cerr << "Failed to initialize signing context for thread" << std::endl;
+        if (options.streaming.enabled()) {
+            streamMessages(*curve);
             return;
         }
         
-        // Pre-allocate variables outside the loop for better performance
-        unsigned char data[32];
-        unsigned char* signature = nullptr;
-        size_t signature_len = 0;
-        auto start_time = std::chrono::steady_clock::now();
-        auto end_time = std::chrono::steady_clock::now();
-        
-        // Random number generator for data
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<unsigned char> dis(0, 255);
+        if (working_set.enabled()) {
+            runWorkingSet(*curve);
+            return;
+        }
         
-        // Perform signing operations in the loop
-        for (int i = 0; i < num_loops; i++) {
-            // Fill buffer with random data
-            for (int j = 0; j < 32; j++) {
-                data[j] = dis(gen);
+        if (!options.verify) {
+            if (options.compare_fetch) {
+                compareFetch([this, curve](bench::FetchMode mode, int) {
+                    return createSignOperation(*curve, paramsFor(mode), options.strategy, nullptr);
+                });
+                return;
             }
-            
-            start_time = std::chrono::steady_clock::now();
-            
-            // Reset the context for each signature
-            if (EVP_DigestSignInit(md_ctx, nullptr, EVP_sha256(), nullptr, ec_key) > 0) {
-                // Update with data to be signed
-                if (EVP_DigestSignUpdate(md_ctx, data, 32) > 0) {
-                    // Get signature length
-                    if (EVP_DigestSignFinal(md_ctx, nullptr, &signature_len) > 0) {
-                        // Allocate signature buffer
-                        signature = (unsigned char*)OPENSSL_malloc(signature_len);
-                        if (signature) {
-                            // Generate actual signature
-                            if (EVP_DigestSignFinal(md_ctx, signature, &signature_len) > 0) {
-                                end_time = std::chrono::steady_clock::now();
-                                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-                                
-                                // Ensure we got a valid positive duration
-                                if (duration.count() > 0) {
-                                    updateStats(static_cast<uint64_t>(duration.count()));
-                                }
-                            }
-                            
-                            // Clean up signature buffer
-                            OPENSSL_free(signature);
-                            signature = nullptr;
-                        }
-                    }
-                }
+            if (options.compare_strategies) {
+                compareStrategies([this, curve](bench::ContextStrategy strategy, int, bench::PhaseTimes* sink) {
+                    return createSignOperation(*curve, paramsFor(options.fetch_mode), strategy, sink);
+                });
+                return;
             }
+            execute([this, curve](int thread_index) {
+                return createSignOperation(*curve, paramsFor(options.fetch_mode), options.strategy,
+                                           phaseSink(thread_index));
+            });
+            return;
         }
         
-        // Clean up
-        EVP_MD_CTX_free(md_ctx);
-        EVP_PKEY_free(ec_key);
+        EVP_PKEY* key = createECKey(*curve);
+        bench::SignatureCorpus corpus;
+        if (!key || !corpus.build(key, params, options.corpus_size, kMessageSize)) {
+            bench::reportOpenSSLError("Failed to build the signature corpus");
+            EVP_PKEY_free(key);
+            return;
+        }
+        if (options.compare_fetch) {
+            compareFetch([this, key, &corpus](bench::FetchMode mode, int thread_index) {
+                return createVerifyOperation(key, corpus, paramsFor(mode), thread_index, config.num_threads);
+            });
+        } else {
+            execute([this, key, &corpus](int thread_index) {
+                return createVerifyOperation(key, corpus, paramsFor(options.fetch_mode), thread_index,
+                                             config.num_threads);
+            });
+        }
+        EVP_PKEY_free(key);
     }
     
-    void printStats() {
-        auto current_time = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time);
-        
-        // Get all statistics safely under the same mutex
-        uint64_t total_signatures, total_time, min_time, max_time;
-        bool signatures_generated;
-        {
-            std::lock_guard<std::mutex> lock(stats_mutex);
-            total_signatures = total_signatures_generated;
-            total_time = total_time_microseconds;
-            min_time = min_time_microseconds;
-            max_time = max_time_microseconds;
-            signatures_generated = first_signature_generated;
+    void listSupportedCurves() {
+        std::cout << "Supported EC curves:" << std::endl;
+        for (const auto& curve : bench::signatureCurves()) {
+            std::cout << "  " << std::left << std::setw(8) << curve.name << std::right << "- " << curve.description
+                      << std::endl;
         }
-        
-        if (total_signatures == 0) {
-            std::cout << "\rSigs: 0, Throughput: 0.00 sigs/s, Avg: 0.00ms, Min: 0.00ms, Max: 0.00ms" << std::flush;
+    }
+
+private:
+    // One key, copied to every worker, and one run per message
+    void streamMessages(const bench::CurveInfo& curve) {
+        EVP_PKEY* key = createECKey(curve);
+        if (!key) {
+            bench::reportOpenSSLError("Failed to create EC key");
             return;
         }
-        
-        double throughput = (elapsed.count() > 0) ? static_cast<double>(total_signatures) / elapsed.count() : 0.0;
-        double avg_time_ms = static_cast<double>(total_time) / total_signatures / 1000.0;
-        
-        // Convert to milliseconds
-        double min_time_ms = static_cast<double>(min_time) / 1000.0;
-        double max_time_ms = static_cast<double>(max_time) / 1000.0;
-        
-        // If we haven't generated any signatures yet or values are uninitialized, show 0
-        if (!signatures_generated || min_time == 0 || max_time == 0) {
-            min_time_ms = 0.0;
-            max_time_ms = 0.0;
+        std::cout << (options.verify ? "Streaming verification:" : "Streaming signatures:") << std::endl;
+        std::vector<bench::StreamingPoint> points = bench::runStreaming(
+            config, workload, options.verify, key, params, messages.messages(), options.streaming.chunk,
+            [this, key](const bench::MessageInput& input, const std::vector<unsigned char>* signature, int,
+                        bench::PhaseTimes* sink) { return createStreamOperation(key, input, signature, sink); });
+        bench::printStreamingTable(std::cout, config, points);
+        EVP_PKEY_free(key);
+    }
+    
+    // Called on each worker thread: an operation over the first `keys` keys
+    // of the shared set, picked the same way on every run of a sweep
+    std::unique_ptr<bench::WorkingSetOperation> createWorkingSetOperation(const bench::KeyWorkingSet& keys,
+                                                                          size_t prefix, uint64_t seed,
+                                                                          int thread_index) {
+        bench::KeyPicker picker(prefix, working_set.access, working_set.zipf_exponent, thread_index, config.num_threads, seed);
+        std::unique_ptr<bench::WorkingSetOperation> op(new bench::WorkingSetOperation(
+            keys, paramsFor(options.fetch_mode), options.verify, kMessageSize, picker));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
+            return nullptr;
         }
-        
-        std::cout << "\rSigs: " << std::setw(6) << total_signatures 
-                  << ", Throughput: " << std::fixed << std::setprecision(2) << std::setw(8) << throughput << " sigs/s"
-                  << ", Avg: " << std::setw(6) << avg_time_ms << "ms"
-                  << ", Min: " << std::setw(6) << min_time_ms << "ms"
-                  << ", Max: " << std::setw(6) << max_time_ms << "ms" 
-                  << std::flush;
+        return op;
     }
     
-    void run(const std::string& curve_name, int num_threads, int num_loops) {
-        // Validate curve name
-        if (curve_map.find(curve_name) == curve_map.end()) {
-            std::cerr << "Error: Unsupported curve '" << curve_name << "'" << std::endl;
-            std::cerr << "Supported curves: P256, P384, P521" << std::endl;
+    // Every key is made once and shared by all workers; a sweep runs over
+    // growing prefixes of the same set
+    void runWorkingSet(const bench::CurveInfo& curve) {
+        bench::KeyWorkingSet keys;
+        std::string error;
+        std::cout << "Generating " << working_set.keys << " " << curve.name << " key"
+                  << (working_set.keys == 1 ? "" : "s")
+                  << (options.verify ? " and signatures" : "") << "..." << std::flush;
+        if (!keys.build(curve, working_set.keys, options.verify, params, kMessageSize, error)) {
+            std::cout << std::endl;
+            bench::reportOpenSSLError("Failed to build the key working set: " + error);
             return;
         }
-        
-        std::cout << "Starting EC-DSA signing performance test with:" << std::endl;
-        std::cout << "Curve: " << curve_name << std::endl;
-        std::cout << "Threads: " << num_threads << std::endl;
-        std::cout << "Loops per thread: " << num_loops << std::endl;
-        std::cout << "Total signatures to generate: " << (num_threads * num_loops) << std::endl;
-        std::cout << "Data size: 32 bytes (random data per signature)" << std::endl;
-        std::cout << "Hash algorithm: SHA-256" << std::endl;
-        std::cout << std::endl;
-        
-        std::vector<std::thread> threads;
-        
-        // Start worker threads
-        for (int i = 0; i < num_threads; i++) {
-            threads.emplace_back(&ECDSASigner::workerThread, this, curve_name, num_loops);
+        std::cout << " done";
+        if (keys.heapBytes() > 0) {
+            std::cout << ", " << bench::approximateBytes(static_cast<double>(keys.heapBytes())) << " of heap";
         }
+        std::cout << std::endl << std::endl;
+        uint64_t seed = config.seeded ? config.seed : std::random_device{}();
         
-        // Stats printing thread
-        std::atomic<bool> done{false};
-        std::thread stats_thread([this, &done]() {
-            while (!done.load()) {
-                printStats();
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-            }
-        });
-        
-        // Wait for all worker threads to complete
-        for (auto& t : threads) {
-            t.join();
+        if (!working_set.sweep) {
+            bench::Settings settings = runSettings();
+            settings.push_back(std::make_pair("keys", std::to_string(working_set.keys)));
+            settings.push_back(std::make_pair("key_access", bench::keyAccessName(working_set.access)));
+            execute([this, &keys, seed](int thread_index) {
+                return createWorkingSetOperation(keys, keys.size(), seed, thread_index);
+            }, settings, [](const bench::RunResult&) {});
+            return;
         }
         
-        done = true;
-        stats_thread.join();
-        
-        // Print final statistics
-        std::cout << std::endl << std::endl;
-        std::cout << "Final Statistics:" << std::endl;
-        printStats();
-        std::cout << std::endl;
-    }
-    
-    void listSupportedCurves() {
-        std::cout << "Supported EC curves:" << std::endl;
-        std::cout << "  P256  - NIST P-256 (secp256r1, prime256v1) - 256-bit" << std::endl;
-        std::cout << "  P384  - NIST P-384 (secp384r1) - 384-bit" << std::endl;
-        std::cout << "  P521  - NIST P-521 (secp521r1) - 521-bit" << std::endl;
+        std::cout << "Key working set sweep:" << std::endl;
+        bench::RunConfig step_config = config;
+        step_config.live_stats = false;
+        std::vector<bench::WorkingSetPoint> points;
+        for (size_t prefix : bench::workingSetSteps(keys.size())) {
+            std::cout << "  " << prefix << " key" << (prefix == 1 ? "" : "s") << "..." << std::flush;
+            bench::RunResult result = bench::run(step_config, [this, &keys, prefix, seed](int thread_index) {
+                return createWorkingSetOperation(keys, prefix, seed, thread_index);
+            });
+            std::cout << " " << std::fixed << std::setprecision(1) << result.throughput() << " " << config.rate_label
+                      << std::endl;
+            bench::Settings settings;
+            settings.push_back(std::make_pair("keys", std::to_string(prefix)));
+            settings.push_back(std::make_pair("key_access", bench::keyAccessName(working_set.access)));
+            bench::saveResult(step_config, workload + " keys-" + std::to_string(prefix), result, settings);
+            
+            bench::WorkingSetPoint point;
+            point.keys = prefix;
+            point.footprint_bytes = keys.heapBytes() * prefix / keys.size();
+            point.throughput = result.throughput();
+            point.p50_ns = result.latency->valueAtPercentile(50.0);
+            point.p99_ns = result.latency->valueAtPercentile(99.0);
+            point.failures = result.failures;
+            points.push_back(point);
+        }
+        bench::printWorkingSetTable(std::cout, config, points);
     }
 };
 
 void printUsage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " <curve> <num_threads> <num_loops>" << std::endl;
-    std::cout << "  curve       - EC curve name (P256, P384, P521)" << std::endl;
+    std::cout << "Usage: " << program_name << " <curve> <num_threads> <num_loops> [options]" << std::endl;
+    std::cout << "  curve       - EC curve name (P256, P384, P521, Ed25519, Ed448, or ALL)" << std::endl;
+    std::cout << "                Ed25519 and Ed448 sign with EdDSA (one-shot, no separate digest)" << std::endl;
     std::cout << "  num_threads - Number of worker threads" << std::endl;
     std::cout << "  num_loops   - Number of signatures to generate per thread" << std::endl;
     std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    bench::printSignerOptions(std::cout);
+    std::cout << "  --keys N              - Sign or verify with N shared keys (up to 1000000), a different one" << std::endl;
+    std::cout << "                          each operation, to see the cost of key data falling out of cache" << std::endl;
+    std::cout << "  --key-access uniform|zipf[:S]|sequential" << std::endl;
+    std::cout << "                        - Which key each operation uses (default uniform; Zipf exponent S" << std::endl;
+    std::cout << "                          defaults to 1)" << std::endl;
+    std::cout << "  --keys-sweep          - Run at 1, 4, 16, ... keys up to --keys and tabulate against cache sizes" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << program_name << " P256 4 1000  # Generate 4000 P-256 signatures using 4 threads" << std::endl;
     std::cout << "  " << program_name << " P384 8 500   # Generate 4000 P-384 signatures using 8 threads" << std::endl;
     std::cout << "  " << program_name << " P521 2 250   # Generate 500 P-521 signatures using 2 threads" << std::endl;
+    std::cout << "  " << program_name << " Ed25519 4 1000  # Generate 4000 Ed25519 signatures using 4 threads" << std::endl;
+    std::cout << "  " << program_name << " ALL 8 2000 --verify --sweep  # Verify scaling for every curve" << std::endl;
+    std::cout << "  " << program_name << " P256 4 20 --message-size 4K,1M,64M  # Where hashing starts to dominate" << std::endl;
+    std::cout << "  " << program_name << " P256 1 2000 --keys 100000 --keys-sweep  # Throughput as keys outgrow the caches" << std::endl;
     std::cout << std::endl;
     std::cout << "Use '" << program_name << " --curves' to list supported curves" << std::endl;
 }
@@ -298,7 +370,7 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
-    if (argc != 4) {
+    if (argc < 4) {
         printUsage(argv[0]);
         return 1;
     }
@@ -320,11 +392,88 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    bench::RunConfig config;
+    bench::SignerOptions options;
+    WorkingSetOptions working_set;
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Unrecognized) {
+            status = bench::parseSignerOption(argc, argv, i, options, error);
+        }
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+        
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--keys" && bench::optionValue(argc, argv, i, value)) {
+            uint64_t keys = 0;
+            if (bench::parseCount(value, 1, 1000000, keys)) {
+                working_set.keys = static_cast<size_t>(keys);
+            } else {
+                std::cerr << "Error: --keys must be between 1 and 1000000" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--key-access" && bench::optionValue(argc, argv, i, value)) {
+            if (!bench::parseKeyAccess(value, working_set.access, working_set.zipf_exponent)) {
+                std::cerr << "Error: --key-access must be uniform, sequential, zipf or zipf:S with 0 < S <= 10"
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--keys-sweep") {
+            working_set.sweep = true;
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    std::string option_error;
+    if (!bench::checkSignerOptions(config, options, option_error)) {
+        std::cerr << "Error: " << option_error << std::endl;
+        return 1;
+    }
+    if (working_set.enabled()) {
+        if (options.streaming.enabled() || options.phase_timing || options.compare_fetch ||
+            config.libctx_mode == bench::LibCtxMode::Isolated || config.compare_libctx) {
+            std::cerr << "Error: --keys and --keys-sweep cannot be combined with --message-size, --file, --ctx,"
+                      << " --fetch compare or --libctx isolated/compare" << std::endl;
+            return 1;
+        }
+        if (working_set.sweep && (config.sweep || config.async_sweep || config.rate_sweep)) {
+            std::cerr << "Error: --keys-sweep cannot be combined with --sweep, --async-sweep or --rate-sweep"
+                      << std::endl;
+            return 1;
+        }
+    }
+    
     // Initialize OpenSSL
     ERR_load_crypto_strings();
     
-    ECDSASigner signer;
-    signer.run(curve_name, num_threads, num_loops);
+    ECDSASigner signer(config, options, working_set);
+    std::string load_error;
+    if (!signer.loadMessages(load_error)) {
+        std::cerr << "Error: " << load_error << std::endl;
+        return 1;
+    }
+    std::vector<std::string> curves;
+    if (curve_name == "ALL") {
+        curves = signer.supportedCurves();
+    } else {
+        curves.push_back(curve_name);
+    }
+    for (size_t i = 0; i < curves.size(); i++) {
+        if (i > 0) {
+            std::cout << std::endl << std::endl;
+        }
+        signer.run(curves[i], num_threads, num_loops);
+    }
     
     // Cleanup OpenSSL
     ERR_free_strings();
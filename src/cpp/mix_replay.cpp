@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+
+#include "bench/engine.h"
+#include "bench/mixed_workload.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+
+// Options specific to mix_replay
+struct MixOptions {
+    bool trace = false;       // the workload argument is a trace file rather than a mix
+    int keys_per_algorithm = 1;
+    double speed = 1.0;       // timed traces: replay this many times faster than recorded
+    bool ignore_timestamps = false;
+    bool isolated = false;    // also run every class by itself
+};
+
+class MixReplay {
+private:
+    bench::RunConfig config;
+    MixOptions options;
+    bench::Workload workload;
+    bench::MixedKeys keys;
+    uint64_t seed = 0;
+
+public:
+    MixReplay(const bench::RunConfig& run_config, const MixOptions& mix_options)
+        : config(run_config), options(mix_options) {}
+
+    int run(const std::string& spec, int num_threads, uint64_t num_loops) {
+        std::string error;
+        bool loaded = options.trace ? bench::loadTrace(spec, workload, error)
+                                    : bench::parseMix(spec, options.keys_per_algorithm, workload, error);
+        if (!loaded) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (options.ignore_timestamps) {
+            workload.timed = false;
+        }
+        if (workload.isTrace() && static_cast<size_t>(num_threads) > workload.trace.size()) {
+            std::cerr << "Error: the trace has " << workload.trace.size() << " operations, fewer than the "
+                      << num_threads << " threads replaying it" << std::endl;
+            return 1;
+        }
+        if (workload.timed && config.timeBounded()) {
+            std::cerr << "Error: a timed trace sets its own pace; use --no-timestamps with --duration or --steady-state"
+                      << std::endl;
+            return 1;
+        }
+        // 0 operations per thread: one pass over the trace, split evenly.
+        // Every worker runs the same count, so the entries past the last
+        // full round are left out.
+        size_t left_out = 0;
+        if (num_loops == 0) {
+            if (!workload.isTrace()) {
+                std::cerr << "Error: Number of operations must be at least 1" << std::endl;
+                return 1;
+            }
+            num_loops = workload.trace.size() / static_cast<size_t>(num_threads);
+            left_out = workload.trace.size() % static_cast<size_t>(num_threads);
+        }
+        seed = config.seeded ? config.seed : std::random_device{}();
+
+        std::cout << "Starting mixed workload replay with:" << std::endl;
+        printWorkload(spec);
+        std::cout << "Threads: " << num_threads << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Operations per thread: " << num_loops << std::endl;
+        }
+        if (left_out > 0) {
+            std::cout << "Warning: replaying " << workload.trace.size() - left_out << " of the trace's "
+                      << workload.trace.size() << " operations; the last " << left_out
+                      << " don't divide evenly among " << num_threads << " threads" << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        std::cout << std::endl;
+
+        size_t key_count = 0;
+        for (int k : workload.keys) {
+            key_count += static_cast<size_t>(k);
+        }
+        std::cout << "Generating " << key_count << " key(s) and the signed messages to verify..." << std::flush;
+        bench::Clock::time_point setup_start = bench::Clock::now();
+        if (!keys.build(workload, error)) {
+            std::cout << std::endl;
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        std::cout << " done in " << std::fixed << std::setprecision(2)
+                  << bench::elapsedSeconds(setup_start, bench::Clock::now()) << "s" << std::endl << std::endl;
+
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+
+        bench::MixedLatency latency(num_threads, static_cast<int>(workload.classes.size()));
+        bench::RunResult result = measure(workload, config, latency);
+        bench::printRunReport(std::cout, config, result);
+
+        std::vector<bench::MixClassResult> rows;
+        for (size_t c = 0; c < workload.classes.size(); c++) {
+            rows.push_back(classResult(static_cast<int>(c), latency, result));
+        }
+        if (options.isolated) {
+            std::cout << std::endl << "Each class alone:" << std::endl;
+            for (size_t c = 0; c < workload.classes.size(); c++) {
+                measureAlone(static_cast<int>(c), rows[c]);
+            }
+        }
+
+        bench::printMixTable(std::cout, rows, result.throughput(),
+                             workload.timed ? "from each entry's timestamp, so queueing behind a late worker counts"
+                                            : "from the start of each operation");
+        saveResults(spec, result, latency);
+        return 0;
+    }
+
+private:
+    bench::RunResult measure(const bench::Workload& replayed, const bench::RunConfig& run_config,
+                             bench::MixedLatency& latency) {
+        int workers = run_config.num_threads;
+        return bench::run(run_config, [this, &replayed, &latency, workers](int thread_index) {
+            std::unique_ptr<bench::MixedOperation> op(new bench::MixedOperation(
+                replayed, keys, thread_index, workers, options.speed, seed, &latency));
+            if (!op->valid()) {
+                std::cerr << "Failed to set up worker " << thread_index << std::endl;
+                return std::unique_ptr<bench::MixedOperation>();
+            }
+            return op;
+        });
+    }
+
+    bench::MixClassResult classResult(int c, const bench::MixedLatency& latency, const bench::RunResult& result) {
+        bench::LatencyHistogram hist;
+        latency.merge(c, hist);
+        bench::MixClassResult row;
+        row.label = workload.classes[c].label;
+        row.operations = hist.count();
+        row.throughput = result.elapsed_seconds > 0.0 ? hist.count() / result.elapsed_seconds : 0.0;
+        row.mean_ns = hist.mean();
+        row.p50_ns = hist.valueAtPercentile(50.0);
+        row.p99_ns = hist.valueAtPercentile(99.0);
+        row.p999_ns = hist.valueAtPercentile(99.9);
+        return row;
+    }
+
+    // The class by itself, as many operations as it had in the mix, on the
+    // same threads and keys
+    void measureAlone(int c, bench::MixClassResult& row) {
+        if (row.operations == 0) {
+            return;
+        }
+        bench::Workload alone = workload;
+        alone.trace.clear();
+        alone.timed = false;
+        for (size_t i = 0; i < alone.classes.size(); i++) {
+            alone.classes[i].weight = static_cast<int>(i) == c ? 1.0 : 0.0;
+        }
+        bench::RunConfig quiet = config;
+        quiet.live_stats = false;
+        quiet.loops_per_thread = std::max<uint64_t>(1, row.operations / static_cast<uint64_t>(config.num_threads));
+
+        std::cout << "  " << row.label << "..." << std::flush;
+        bench::MixedLatency latency(config.num_threads, static_cast<int>(alone.classes.size()));
+        bench::RunResult result = measure(alone, quiet, latency);
+        bench::LatencyHistogram hist;
+        latency.merge(c, hist);
+        row.isolated_p50_ns = hist.valueAtPercentile(50.0);
+        row.isolated_p99_ns = hist.valueAtPercentile(99.0);
+        std::cout << " " << static_cast<uint64_t>(result.throughput()) << " " << config.rate_label << std::endl;
+    }
+
+    void printWorkload(const std::string& spec) {
+        if (workload.isTrace()) {
+            std::cout << "Trace: " << spec << ", " << workload.trace.size() << " operations, ";
+            if (workload.timed) {
+                std::cout << "timed over " << std::fixed << std::setprecision(3)
+                          << workload.trace_span_us / 1e6 << "s, replayed at " << std::setprecision(2)
+                          << options.speed << "x" << std::endl;
+            } else {
+                std::cout << "replayed back to back" << std::endl;
+            }
+        } else {
+            std::cout << "Weighted mix, " << options.keys_per_algorithm
+                      << " key(s) per signing algorithm picked at random" << std::endl;
+        }
+        double total_weight = 0.0;
+        std::vector<uint64_t> counts(workload.classes.size(), 0);
+        for (const auto& entry : workload.trace) {
+            counts[entry.op_class]++;
+        }
+        for (const auto& c : workload.classes) {
+            total_weight += c.weight;
+        }
+        for (size_t i = 0; i < workload.classes.size(); i++) {
+            const bench::OpClass& c = workload.classes[i];
+            double share = workload.isTrace() ? 100.0 * counts[i] / workload.trace.size()
+                                              : 100.0 * c.weight / total_weight;
+            std::cout << "  " << std::left << std::setw(28) << c.label << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(6) << share << "%";
+            if (c.op != bench::MixOp::Keygen) {
+                std::cout << "  (" << workload.keys[c.algorithm] << " key(s))";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    std::string workloadName(const std::string& spec) const {
+        return std::string("mix_replay ") + (workload.isTrace() ? "trace " : "mix ") + spec;
+    }
+
+    // The whole run, then one record per class
+    void saveResults(const std::string& spec, const bench::RunResult& result, const bench::MixedLatency& latency) {
+        bench::Settings settings;
+        if (workload.timed) {
+            settings.push_back(std::make_pair("speed", std::to_string(options.speed)));
+        }
+        if (!workload.isTrace()) {
+            settings.push_back(std::make_pair("keys_per_algorithm", std::to_string(options.keys_per_algorithm)));
+        }
+        bench::saveResult(config, workloadName(spec), result, settings);
+        if (config.results_output.empty()) {
+            return;
+        }
+        for (size_t c = 0; c < workload.classes.size(); c++) {
+            bench::LatencyHistogram hist;
+            latency.merge(static_cast<int>(c), hist);
+            bench::ResultRecord record =
+                bench::resultRecord(workloadName(spec) + " " + workload.classes[c].label, config.rate_label, hist);
+            record.threads = config.num_threads;
+            record.settings = settings;
+            record.operations = hist.count();
+            record.elapsed_seconds = result.elapsed_seconds;
+            record.throughput = result.elapsed_seconds > 0.0 ? hist.count() / result.elapsed_seconds : 0.0;
+            std::string error;
+            if (!bench::appendResult(config.results_output, record, error)) {
+                std::cerr << "Warning: " << error << std::endl;
+                return;
+            }
+        }
+    }
+};
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <workload> <num_threads> <num_ops> [options]" << std::endl;
+    std::cout << "  workload    - A weighted mix of op:algorithm:weight[:bytes] entries, inline or in a file," << std::endl;
+    std::cout << "                or with --trace a trace file to replay" << std::endl;
+    std::cout << "  num_threads - Number of threads sharing the workload" << std::endl;
+    std::cout << "  num_ops     - Operations per thread (traces: 0 = one pass over the trace)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Operations are keygen, sign and verify; algorithms P256, P384, P521, Ed25519, Ed448" << std::endl;
+    std::cout << "and RSA-<bits> (RSA-PSS with SHA-256). Messages default to 32 bytes." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Trace files hold one operation per line, fields separated by spaces or commas:" << std::endl;
+    std::cout << "  op algorithm [key_id [message_bytes [timestamp_us]]]" << std::endl;
+    std::cout << "Entries are dealt to the threads round-robin. With timestamps each operation starts at" << std::endl;
+    std::cout << "its recorded time and its latency is measured from it." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --trace            - The workload argument is a trace file" << std::endl;
+    std::cout << "  --keys N           - Mixes: keys per signing algorithm, one picked at random per" << std::endl;
+    std::cout << "                       operation (default 1)" << std::endl;
+    std::cout << "  --speed X          - Replay a timed trace X times faster than recorded (default 1)" << std::endl;
+    std::cout << "  --no-timestamps    - Replay a timed trace back to back" << std::endl;
+    std::cout << "  --isolated         - Also run each class by itself and compare its latency with the mix" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " verify:P256:85,sign:P256:12,keygen:P256:3 4 10000" << std::endl;
+    std::cout << "  " << program_name << " verify:P256:60,verify:RSA-2048:25,sign:Ed25519:12,keygen:RSA-2048:0.1 8 5000 --isolated" << std::endl;
+    std::cout << "  " << program_name << " production.trace 8 0 --trace --speed 2" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string spec = argv[1];
+    int num_threads = std::atoi(argv[2]);
+    long long num_ops = std::atoll(argv[3]);
+
+    bench::RunConfig config;
+    MixOptions options;
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--trace") {
+            options.trace = true;
+        } else if (arg == "--keys" && bench::optionValue(argc, argv, i, value)) {
+            options.keys_per_algorithm = std::atoi(value.c_str());
+            if (options.keys_per_algorithm < 1 || options.keys_per_algorithm > 100000) {
+                std::cerr << "Error: --keys must be between 1 and 100000" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--speed" && bench::optionValue(argc, argv, i, value)) {
+            options.speed = std::atof(value.c_str());
+            if (!(options.speed > 0.0) || options.speed > 1e6) {
+                std::cerr << "Error: --speed must be a positive factor" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--no-timestamps") {
+            options.ignore_timestamps = true;
+        } else if (arg == "--isolated") {
+            options.isolated = true;
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (num_threads < 1 || num_threads > 1000) {
+        std::cerr << "Error: Number of threads must be between 1 and 1000" << std::endl;
+        return 1;
+    }
+    if (num_ops < 0) {
+        std::cerr << "Error: Number of operations cannot be negative" << std::endl;
+        return 1;
+    }
+    // Per-class latency is recorded by the operation itself, which cannot
+    // tell warmup from measurement, and a timed trace is already an open
+    // loop; the sweeps would need one set of histograms per step
+    if (config.warmup_seconds > 0.0 || config.openLoop() || config.rate_sweep || config.sweep ||
+        config.compare_libctx || config.async_jobs > 0 || config.async_sweep) {
+        std::cerr << "Error: --warmup, --rate, --rate-sweep, --sweep, --libctx compare and --async do not apply"
+                  << " to mix_replay (timed traces are its open-loop mode)" << std::endl;
+        return 1;
+    }
+
+    // Initialize OpenSSL
+    ERR_load_crypto_strings();
+
+    MixReplay replay(config, options);
+    int status = replay.run(spec, num_threads, static_cast<uint64_t>(num_ops));
+
+    // Cleanup OpenSSL
+    ERR_free_strings();
+
+    return status;
+}
@@ -1,36 +1,55 @@
 #include <iostream>
-#include <vector>
-#include <thread>
-#include <atomic>
-#include <chrono>
-#include <mutex>
 #include <iomanip>
+#include <memory>
 #include <algorithm>
+#include <atomic>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 
+#include "bench/engine.h"
+#include "bench/keys.h"
+#include "bench/library_context.h"
+#include "bench/mpmc_queue.h"
+#include "bench/operations.h"
+#include "bench/options.h"
+#include "bench/parallel_rsa.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/rsa_primes.h"
+#include "bench/scaling.h"
+#include "bench/topology.h"
+
 class RSAGenerator {
 private:
-    uint64_t total_keys_generated{0};
-    uint64_t total_time_microseconds{0};
-    uint64_t min_time_microseconds{0};
-    uint64_t max_time_microseconds{0};
-    bool first_key_generated{false};
-    std::mutex stats_mutex;
-    std::chrono::steady_clock::time_point start_time;
+    bench::RunConfig config;
+    std::vector<bench::PrimeCountResult> results;
     
 public:
-    RSAGenerator() {
-        start_time = std::chrono::steady_clock::now();
-        min_time_microseconds = 0;
-        max_time_microseconds = 0;
-        first_key_generated = false;
+    explicit RSAGenerator(const bench::RunConfig& run_config = defaultConfig()) : config(run_config) {
+        config.unit_label = "Keys";
+        config.rate_label = "keys/s";
+    }
+    
+    // Keygen time varies several-fold with the random prime search, so by
+    // default hand keys out from a shared counter instead of fixed per-thread
+    // quotas; otherwise most cores idle while the unluckiest thread finishes.
+    static bench::RunConfig defaultConfig() {
+        bench::RunConfig defaults;
+        defaults.schedule = bench::Schedule::Dynamic;
+        return defaults;
     }
     
-    EVP_PKEY_CTX* createKeygenContext(int keysize) {
-        EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    // In isolated mode the context belongs to the calling worker's own library context
+    EVP_PKEY_CTX* createKeygenContext(int keysize, int primes = 2) {
+        bench::LibraryContext* libctx = bench::threadLibraryContext();
+        EVP_PKEY_CTX* ctx = bench::newKeyContext("RSA", EVP_PKEY_RSA, libctx ? libctx->get() : nullptr);
         if (!ctx) {
             return nullptr;
         }
@@ -45,169 +64,603 @@ public:
             return nullptr;
         }
         
+        if (primes != 2 && EVP_PKEY_CTX_set_rsa_keygen_primes(ctx, primes) <= 0) {
+            EVP_PKEY_CTX_free(ctx);
+            return nullptr;
+        }
+        
         return ctx;
     }
     
-    void updateStats(uint64_t time_microseconds) {
-        // Use mutex to protect all statistics for consistency
-        std::lock_guard<std::mutex> lock(stats_mutex);
+    // Called on each worker thread: the key generation context is created once per thread
+    std::unique_ptr<bench::KeygenOperation> createKeygenOperation(int keysize, int primes) {
+        EVP_PKEY_CTX* ctx = createKeygenContext(keysize, primes);
+        if (!ctx) {
+            std::cerr << "Failed to create key generation context for thread" << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<bench::KeygenOperation>(new bench::KeygenOperation(ctx, "RSA"));
+    }
+    
+    void run(int keysize, int primes, int num_threads, int num_loops) {
+        std::cout << "Starting RSA key generation with:" << std::endl;
+        std::cout << "Key size: " << keysize << " bits" << std::endl;
+        std::cout << "Primes: " << primes << (primes == 2 ? "" : " (multi-prime)") << std::endl;
+        std::cout << "Threads: " << num_threads << std::endl;
+        std::cout << "Stats collection: " << bench::statsModeName(config.stats_mode) << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Loops per thread: " << num_loops
+                      << (config.schedule == bench::Schedule::Dynamic ? " (average)" : "") << std::endl;
+            std::cout << "Total keys to generate: " << (num_threads * num_loops) << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        std::cout << "Library context: "
+                  << (config.compare_libctx ? "shared vs isolated" : bench::libCtxModeName(config.libctx_mode))
+                  << std::endl;
+        std::cout << std::endl;
         
-        // Sanity check: reject clearly invalid timing values
-        // RSA key generation should never take more than 1 hour (3,600,000,000 microseconds)
-        // or be negative/zero due to timing issues
-        if (time_microseconds == 0 || time_microseconds > 3600000000ULL) {
-            return; // Skip this invalid measurement
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+        auto make_op = [this, keysize, primes](int) {
+            return createKeygenOperation(keysize, primes);
+        };
+        std::string workload = "rsa_generator keygen RSA-" + std::to_string(keysize) + bench::rsaPrimesSuffix(primes);
+        if (config.rate_sweep) {
+            bench::runRateSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.async_sweep) {
+            bench::compareAsyncJobs(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.compare_libctx) {
+            bench::compareLibraryContexts(std::cout, config, make_op);
+            return;
+        }
+        if (config.sweep) {
+            bench::runSweep(std::cout, config, workload, make_op);
+            return;
         }
+        bench::RunResult result = bench::run(config, make_op);
         
-        total_keys_generated++;
-        total_time_microseconds += time_microseconds;
+        bench::printRunReport(std::cout, config, result);
+        bench::saveResult(config, workload, result);
         
-        if (!first_key_generated) {
-            min_time_microseconds = time_microseconds;
-            max_time_microseconds = time_microseconds;
-            first_key_generated = true;
-        } else {
-            if (time_microseconds < min_time_microseconds) {
-                min_time_microseconds = time_microseconds;
-            }
-            if (time_microseconds > max_time_microseconds) {
-                max_time_microseconds = time_microseconds;
+        bench::PrimeCountResult row;
+        row.bits = keysize;
+        row.primes = primes;
+        row.throughput = result.throughput();
+        row.mean_ns = result.latency->mean();
+        row.p50_ns = result.latency->valueAtPercentile(50.0);
+        row.p99_ns = result.latency->valueAtPercentile(99.0);
+        row.failures = result.failures;
+        results.push_back(row);
+    }
+    
+    // Keygen cost of every prime count measured, side by side
+    void printPrimeSummary() {
+        if (results.size() > 1) {
+            std::cout << std::endl << "Key generation by prime count:";
+            bench::printPrimeCountTable(std::cout, "keys/s", results);
+        }
+    }
+};
+
+// Settings for --pool mode: background producers keep a bounded pool of
+// pre-generated keys topped up while consumers draw from it at a set rate.
+struct PoolConfig {
+    bool enabled = false;
+    int consumers = 1;
+    size_t capacity = 64;
+    double demand_rate = 0.0;   // keys/s across all consumers; 0 = take as fast as possible
+    bool prefill = true;        // wait for a full pool before consumers start
+    int primes = 2;
+};
+
+// Simulated consumer stalls for a pool of the given depth, replaying the
+// measured keygen times in order. The pool starts full when `prefill` is set
+// and empty otherwise, as with --no-prefill. Producers refill whenever pool +
+// in-flight keys fall below the depth (or a request is waiting), requests
+// arrive every 1/demand_rate seconds and are served FIFO: a request that
+// arrives while an earlier one is still waiting queues behind it and counts
+// as a stall.
+static uint64_t simulatePoolStalls(const std::vector<double>& keygen_seconds, int producers,
+                                   double demand_rate, uint64_t requests, uint64_t depth, bool prefill) {
+    std::priority_queue<double, std::vector<double>, std::greater<double>> in_flight;
+    uint64_t pool = prefill ? depth : 0;
+    int idle_producers = producers;
+    size_t next_sample = 0;
+    
+    auto start_production = [&](double now, uint64_t waiting) {
+        while (idle_producers > 0 && pool + in_flight.size() < depth + waiting) {
+            in_flight.push(now + keygen_seconds[next_sample++ % keygen_seconds.size()]);
+            idle_producers--;
+        }
+    };
+    
+    start_production(0.0, 0);
+    uint64_t stalls = 0;
+    double served = 0.0; // when the previous request got its key
+    for (uint64_t k = 0; k < requests; k++) {
+        double arrival = static_cast<double>(k) / demand_rate;
+        bool queued = arrival < served;
+        double now = queued ? served : arrival;
+        while (!in_flight.empty() && in_flight.top() <= now) {
+            double done = in_flight.top();
+            in_flight.pop();
+            pool++;
+            idle_producers++;
+            start_production(done, 0);
+        }
+        if (pool > 0) {
+            pool--;
+            start_production(now, 0);
+            served = now;
+            if (queued) {
+                stalls++;
             }
+            continue;
+        }
+        // Empty pool: this request waits for the next key to come off a producer
+        stalls++;
+        start_production(now, 1);
+        double done = in_flight.top();
+        in_flight.pop();
+        idle_producers++;
+        start_production(done, 0);
+        served = done;
+    }
+    return stalls;
+}
+
+// Smallest pool depth whose simulated stalled-request count is within
+// `allowed`. False if no depth is: an empty pool at the start can stall
+// more requests than that however deep it is allowed to grow.
+static bool minimumPoolDepth(const std::vector<double>& keygen_seconds, int producers, double demand_rate,
+                             uint64_t requests, bool prefill, uint64_t allowed, uint64_t& depth) {
+    if (simulatePoolStalls(keygen_seconds, producers, demand_rate, requests, requests, prefill) > allowed) {
+        return false;
+    }
+    uint64_t lo = 0;
+    uint64_t hi = requests;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (simulatePoolStalls(keygen_seconds, producers, demand_rate, requests, mid, prefill) <= allowed) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
         }
     }
+    depth = lo;
+    return true;
+}
+
+// --pool mode: N producer threads fill a lock-free ring of EVP_PKEY* while
+// consumer threads drain it at the configured demand rate, the way our
+// provisioning hosts hide keygen latency.
+class RSAKeyPoolBenchmark {
+private:
+    typedef bench::Clock Clock;
     
-    void workerThread(int keysize, int num_loops) {
-        // Create the key generation context once per thread
-        EVP_PKEY_CTX* ctx = createKeygenContext(keysize);
-        if (!ctx) {
-            std::cerr << "Failed to create key generation context for thread" << std::endl;
-            return;
+    RSAGenerator& generator;
+    bench::RunConfig config;
+    PoolConfig pool_config;
+    
+    struct OccupancySample {
+        double seconds;
+        size_t depth;
+    };
+    
+public:
+    RSAKeyPoolBenchmark(RSAGenerator& gen, const bench::RunConfig& run_config, const PoolConfig& pool)
+        : generator(gen), config(run_config), pool_config(pool) {}
+    
+    void run(int keysize, int producers, uint64_t total_keys) {
+        std::cout << "Starting RSA key pool simulation with:" << std::endl;
+        std::cout << "Key size: " << keysize << " bits" << std::endl;
+        std::cout << "Primes: " << pool_config.primes << std::endl;
+        std::cout << "Producer threads: " << producers << std::endl;
+        std::cout << "Consumer threads: " << pool_config.consumers << std::endl;
+        std::cout << "Pool capacity: " << pool_config.capacity << " keys"
+                  << (pool_config.prefill ? " (filled before consumers start)" : " (starts empty)") << std::endl;
+        std::cout << "Demand: ";
+        if (pool_config.demand_rate > 0.0) {
+            std::cout << pool_config.demand_rate << " keys/s" << std::endl;
+        } else {
+            std::cout << "unthrottled (consumers take keys as fast as they appear)" << std::endl;
         }
+        std::cout << "Keys to consume: " << total_keys << std::endl;
+        std::cout << std::endl;
         
-        // Pre-allocate variables outside the loop for better performance
-        EVP_PKEY* pkey = nullptr;
-        auto start_time = std::chrono::steady_clock::now();
-        auto end_time = std::chrono::steady_clock::now();
-        
-        // Generate keys using the reused context
-        for (int i = 0; i < num_loops; i++) {
-            start_time = std::chrono::steady_clock::now();
-            int keygen_result = EVP_PKEY_keygen(ctx, &pkey);
-            if (keygen_result > 0) {
-                end_time = std::chrono::steady_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-                // Ensure we got a valid positive duration
-                if (duration.count() > 0) {
-                    updateStats(static_cast<uint64_t>(duration.count()));
+        bench::MPMCQueue<EVP_PKEY*> pool(pool_config.capacity);
+        std::atomic<bool> stop_producers{false};
+        std::atomic<bool> stop_sampler{false};
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<int> live_producers{producers};
+        bench::LatencyRecorder keygen_latency(producers, config.stats_mode);
+        bench::LatencyRecorder take_latency(pool_config.consumers, config.stats_mode);
+        std::vector<std::vector<double>> keygen_seconds(producers);
+        std::vector<uint64_t> stall_ns(pool_config.consumers, 0);
+        std::vector<uint64_t> stalled_takes(pool_config.consumers, 0);
+        std::vector<OccupancySample> occupancy;
+        
+        Clock::time_point fill_start = Clock::now();
+        std::vector<std::thread> producer_threads;
+        for (int i = 0; i < producers; i++) {
+            producer_threads.emplace_back([&, i]() {
+                EVP_PKEY_CTX* ctx = generator.createKeygenContext(keysize, pool_config.primes);
+                if (!ctx) {
+                    std::cerr << "Failed to create key generation context for producer" << std::endl;
+                    live_producers--;
+                    return;
+                }
+                std::vector<double>& samples = keygen_seconds[i];
+                while (!stop_producers.load(std::memory_order_relaxed)) {
+                    // Back off while the pool is full rather than holding finished keys in hand
+                    if (pool.sizeApprox() >= pool.capacity()) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                        continue;
+                    }
+                    EVP_PKEY* pkey = nullptr;
+                    Clock::time_point start = Clock::now();
+                    if (EVP_PKEY_keygen(ctx, &pkey) <= 0) {
+                        bench::reportOpenSSLError("RSA key generation failed in producer");
+                        break;
+                    }
+                    uint64_t ns = bench::elapsedNs(start, Clock::now());
+                    keygen_latency.record(i, ns);
+                    samples.push_back(ns / 1e9);
+                    while (!pool.tryPush(pkey)) {
+                        if (stop_producers.load(std::memory_order_relaxed)) {
+                            EVP_PKEY_free(pkey);
+                            break;
+                        }
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
                 }
-                // Clean up the key
-                EVP_PKEY_free(pkey);
-                pkey = nullptr;
-            } else {
-                unsigned long err = ERR_get_error();
-                char err_buf[256];
-                ERR_error_string_n(err, err_buf, sizeof(err_buf));
-                std::cerr << "RSA key generation failed in thread. OpenSSL error: " << err_buf << std::endl;
-                break; // Bail out of the thread on failure
+                EVP_PKEY_CTX_free(ctx);
+                live_producers--;
+            });
+        }
+        
+        if (pool_config.prefill) {
+            while (pool.sizeApprox() < pool.capacity() && live_producers.load() > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::cout << "Pool filled in " << std::fixed << std::setprecision(3)
+                      << bench::elapsedSeconds(fill_start, Clock::now()) << "s" << std::endl;
+        }
+        
+        Clock::time_point start = Clock::now();
+        std::thread sampler([&]() {
+            while (!stop_sampler.load(std::memory_order_relaxed)) {
+                OccupancySample sample = {bench::elapsedSeconds(start, Clock::now()), pool.sizeApprox()};
+                occupancy.push_back(sample);
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
             }
+        });
+        
+        std::vector<std::thread> consumer_threads;
+        for (int i = 0; i < pool_config.consumers; i++) {
+            consumer_threads.emplace_back([&, i]() {
+                // Open-loop demand: each consumer takes a key every `period`,
+                // staggered so consumers don't arrive in lockstep
+                std::chrono::nanoseconds period(0);
+                if (pool_config.demand_rate > 0.0) {
+                    period = std::chrono::nanoseconds(
+                        static_cast<int64_t>(1e9 * pool_config.consumers / pool_config.demand_rate));
+                }
+                Clock::time_point next = start + period * i / pool_config.consumers;
+                uint64_t my_stall_ns = 0;
+                uint64_t my_stalled = 0;
+                while (claimed.fetch_add(1, std::memory_order_relaxed) < total_keys) {
+                    Clock::time_point intended = Clock::now();
+                    if (period.count() > 0) {
+                        std::this_thread::sleep_until(next);
+                        intended = next;
+                        next += period;
+                    }
+                    EVP_PKEY* pkey = nullptr;
+                    if (!pool.tryPop(pkey)) {
+                        Clock::time_point stall_start = Clock::now();
+                        while (!pool.tryPop(pkey) && live_producers.load(std::memory_order_relaxed) > 0) {
+                            std::this_thread::sleep_for(std::chrono::microseconds(50));
+                        }
+                        my_stall_ns += bench::elapsedNs(stall_start, Clock::now());
+                        my_stalled++;
+                        if (!pkey) {
+                            break; // every producer has failed
+                        }
+                    }
+                    take_latency.record(i, bench::elapsedNs(intended, Clock::now()));
+                    EVP_PKEY_free(pkey);
+                }
+                stall_ns[i] = my_stall_ns;
+                stalled_takes[i] = my_stalled;
+            });
+        }
+        
+        for (auto& t : consumer_threads) {
+            t.join();
+        }
+        double elapsed = bench::elapsedSeconds(start, Clock::now());
+        stop_sampler = true;
+        sampler.join();
+        stop_producers = true;
+        for (auto& t : producer_threads) {
+            t.join();
+        }
+        EVP_PKEY* leftover = nullptr;
+        while (pool.tryPop(leftover)) {
+            EVP_PKEY_free(leftover);
         }
-        // Clean up the context when thread is done
-        EVP_PKEY_CTX_free(ctx);
+        
+        std::vector<double> all_keygen;
+        for (const auto& samples : keygen_seconds) {
+            all_keygen.insert(all_keygen.end(), samples.begin(), samples.end());
+        }
+        printReport(total_keys, elapsed, producers, keygen_latency, take_latency, stall_ns, stalled_takes,
+                    occupancy, all_keygen);
     }
     
-    void printStats() {
-        auto current_time = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time);
+private:
+    void printReport(uint64_t total_keys, double elapsed, int producers, bench::LatencyRecorder& keygen_latency,
+                     bench::LatencyRecorder& take_latency, const std::vector<uint64_t>& stall_ns,
+                     const std::vector<uint64_t>& stalled_takes, const std::vector<OccupancySample>& occupancy,
+                     const std::vector<double>& keygen_seconds) {
+        bench::LatencyHistogram keygen;
+        bench::LatencyHistogram takes;
+        keygen_latency.snapshot(keygen);
+        take_latency.snapshot(takes);
         
-        // Get all statistics safely under the same mutex
-        uint64_t total_keys, total_time, min_time, max_time;
-        bool keys_generated;
-        {
-            std::lock_guard<std::mutex> lock(stats_mutex);
-            total_keys = total_keys_generated;
-            total_time = total_time_microseconds;
-            min_time = min_time_microseconds;
-            max_time = max_time_microseconds;
-            keys_generated = first_key_generated;
+        uint64_t total_stall_ns = 0;
+        uint64_t total_stalled = 0;
+        for (size_t i = 0; i < stall_ns.size(); i++) {
+            total_stall_ns += stall_ns[i];
+            total_stalled += stalled_takes[i];
         }
         
-        if (total_keys == 0) {
-            std::cout << "\rKeys: 0, Throughput: 0.00 keys/s, Avg: 0.00ms, Min: 0.00ms, Max: 0.00ms" << std::flush;
+        std::cout << std::endl << "Pool Statistics:" << std::endl;
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Keys consumed: " << total_keys << " in " << elapsed << "s ("
+                  << total_keys / elapsed << " keys/s)" << std::endl;
+        std::cout << "Keys generated: " << keygen.count() << ", keygen avg " << keygen.mean() / 1e6
+                  << "ms, p99 " << bench::nsToMs(keygen.valueAtPercentile(99.0)) << "ms" << std::endl;
+        std::cout << "Consumer stall time: " << std::setprecision(3) << total_stall_ns / 1e9 << "s total, "
+                  << std::setprecision(1) << 100.0 * total_stall_ns / 1e9 / (elapsed * pool_config.consumers)
+                  << "% of consumer time; " << total_stalled << " of " << total_keys << " takes stalled ("
+                  << 100.0 * total_stalled / total_keys << "%)" << std::endl;
+        bench::printLatencyPercentiles(std::cout, takes, "Take latency (from intended take time)");
+        
+        printOccupancy(occupancy, elapsed);
+        printSizing(keygen_seconds, producers, total_keys);
+    }
+    
+    void printOccupancy(const std::vector<OccupancySample>& occupancy, double elapsed) {
+        if (occupancy.empty()) {
             return;
         }
+        const int kRows = 20;
+        double interval = std::max(0.5, elapsed / kRows);
+        size_t empty_samples = 0;
         
-        double throughput = (elapsed.count() > 0) ? static_cast<double>(total_keys) / elapsed.count() : 0.0;
-        double avg_time_ms = static_cast<double>(total_time) / total_keys / 1000.0;
-        
-        // Convert to milliseconds with proper bounds checking
-        double min_time_ms = static_cast<double>(min_time) / 1000.0;
-        double max_time_ms = static_cast<double>(max_time) / 1000.0;
-        
-        // If we haven't generated any keys yet or values are uninitialized, show 0
-        if (!keys_generated || min_time == 0 || max_time == 0) {
-            min_time_ms = 0.0;
-            max_time_ms = 0.0;
+        std::cout << std::endl << "Pool occupancy over time (capacity " << pool_config.capacity << "):" << std::endl;
+        std::cout << "      Interval     Min     Avg     Max" << std::endl;
+        size_t i = 0;
+        while (i < occupancy.size()) {
+            double bucket_start = static_cast<int>(occupancy[i].seconds / interval) * interval;
+            size_t lo = SIZE_MAX, hi = 0, n = 0;
+            double sum = 0.0;
+            for (; i < occupancy.size() && occupancy[i].seconds < bucket_start + interval; i++) {
+                size_t d = occupancy[i].depth;
+                lo = std::min(lo, d);
+                hi = std::max(hi, d);
+                sum += d;
+                n++;
+                if (d == 0) {
+                    empty_samples++;
+                }
+            }
+            std::cout << std::fixed << std::setprecision(1) << std::setw(6) << bucket_start << "-"
+                      << std::setw(6) << bucket_start + interval << "s" << std::setw(8) << lo
+                      << std::setw(8) << sum / n << std::setw(8) << hi << std::endl;
+        }
+        std::cout << "Pool was empty in " << std::setprecision(1) << 100.0 * empty_samples / occupancy.size()
+                  << "% of samples" << std::endl;
+    }
+    
+    void printMinimumDepth(const char* label, const std::vector<double>& keygen_seconds, int producers,
+                           uint64_t requests, uint64_t allowed) {
+        uint64_t depth = 0;
+        std::cout << "  Minimum depth with " << label << ": ";
+        if (minimumPoolDepth(keygen_seconds, producers, pool_config.demand_rate, requests, pool_config.prefill,
+                             allowed, depth)) {
+            std::cout << depth << " keys" << std::endl;
+        } else {
+            std::cout << "none; an empty pool at the start stalls more requests at any depth"
+                      << std::endl;
+        }
+    }
+    
+    void printSizing(const std::vector<double>& keygen_seconds, int producers, uint64_t requests) {
+        std::cout << std::endl;
+        if (pool_config.demand_rate <= 0.0) {
+            std::cout << "Pool sizing: set --demand <keys/s> to compute the minimum sustaining pool depth" << std::endl;
+            return;
+        }
+        if (keygen_seconds.empty()) {
+            return;
         }
+        double mean = 0.0;
+        for (double s : keygen_seconds) {
+            mean += s;
+        }
+        mean /= keygen_seconds.size();
+        double capacity_rate = producers / mean;
         
-        std::cout << "\rKeys: " << std::setw(6) << total_keys 
-                  << ", Throughput: " << std::fixed << std::setprecision(2) << std::setw(6) << throughput << " keys/s"
-                  << ", Avg: " << std::setw(7) << avg_time_ms << "ms"
-                  << ", Min: " << std::setw(7) << min_time_ms << "ms"
-                  << ", Max: " << std::setw(7) << max_time_ms << "ms" 
-                  << std::flush;
+        std::cout << "Pool sizing (simulated from " << keygen_seconds.size() << " measured keygen times, "
+                  << producers << " producers, " << requests << " requests at " << std::setprecision(2)
+                  << pool_config.demand_rate << " keys/s, "
+                  << (pool_config.prefill ? "pool filled first" : "pool starting empty") << "):" << std::endl;
+        std::cout << "  Production capacity: " << capacity_rate << " keys/s" << std::endl;
+        printMinimumDepth("no stalled requests", keygen_seconds, producers, requests, 0);
+        printMinimumDepth("<=1% stalled requests", keygen_seconds, producers, requests, requests / 100);
+        if (pool_config.demand_rate >= capacity_rate) {
+            std::cout << "  Warning: demand exceeds production capacity, so any pool eventually drains;"
+                      << " the depths above only cover this run's " << requests << " requests" << std::endl;
+        }
+    }
+};
+
+// --single-key mode: the latency of one key when the caller is waiting for
+// it. Keys are generated one at a time on a single engine worker, first with
+// the stock EVP_PKEY_keygen and then with the prime search spread over 1, 2,
+// 4, ... num_threads threads.
+class RSASingleKeyBenchmark {
+private:
+    struct Row {
+        std::string method;
+        int threads = 1;
+        bench::RunResult result;
+        bench::SingleKeyTimes times;
+    };
+    
+    RSAGenerator& generator;
+    bench::RunConfig config;
+    std::vector<Row> rows;
+    
+public:
+    RSASingleKeyBenchmark(RSAGenerator& gen, const bench::RunConfig& run_config) : generator(gen), config(run_config) {
+        config.num_threads = 1;
+        config.live_stats = false;
     }
     
-    void run(int keysize, int num_threads, int num_loops) {
-        std::cout << "Starting RSA key generation with:" << std::endl;
+    void run(int keysize, int max_threads, int num_keys) {
+        std::cout << "Starting single-key RSA generation latency test with:" << std::endl;
         std::cout << "Key size: " << keysize << " bits" << std::endl;
-        std::cout << "Threads: " << num_threads << std::endl;
-        std::cout << "Loops per thread: " << num_loops << std::endl;
-        std::cout << "Total keys to generate: " << (num_threads * num_loops) << std::endl;
+        std::cout << "Search threads: up to " << max_threads << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Keys per configuration: " << num_keys << ", generated one at a time" << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        std::cout << "Library context: " << bench::libCtxModeName(config.libctx_mode) << std::endl;
         std::cout << std::endl;
         
-        std::vector<std::thread> threads;
+        config.loops_per_thread = num_keys;
+        std::string workload = "rsa_generator single-key RSA-" + std::to_string(keysize);
         
-        // Start worker threads
-        for (int i = 0; i < num_threads; i++) {
-            threads.emplace_back(&RSAGenerator::workerThread, this, keysize, num_loops);
-        }
+        std::cout << "  stock EVP_PKEY_keygen..." << std::flush;
+        Row stock;
+        stock.method = "stock";
+        stock.result = bench::run(config, [this, keysize](int) { return generator.createKeygenOperation(keysize, 2); });
+        bench::saveResult(config, workload + " stock", stock.result);
+        std::cout << " p50 " << std::fixed << std::setprecision(1) << bench::nsToMs(stock.result.latency->valueAtPercentile(50.0))
+                  << " ms" << std::endl;
+        rows.push_back(std::move(stock));
         
-        // Stats printing thread
-        std::atomic<bool> done{false};
-        std::thread stats_thread([this, &done]() {
-            while (!done.load()) {
-                printStats();
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        for (int threads : bench::scalingSteps(max_threads)) {
+            std::cout << "  parallel, " << threads << " thread" << (threads == 1 ? "" : "s") << "..." << std::flush;
+            Row row;
+            row.method = "parallel";
+            row.threads = threads;
+            bench::SingleKeyTimes* times = &row.times;
+            row.result = bench::run(config, [keysize, threads, times](int) {
+                bench::LibraryContext* libctx = bench::threadLibraryContext();
+                return std::unique_ptr<bench::ParallelKeygenOperation>(new bench::ParallelKeygenOperation(
+                    keysize, threads, libctx ? libctx->get() : nullptr, times));
+            });
+            bench::saveResult(config, workload + " parallel-" + std::to_string(threads), row.result,
+                              {{"search_threads", std::to_string(threads)}});
+            std::cout << " p50 " << std::fixed << std::setprecision(1)
+                      << bench::nsToMs(row.result.latency->valueAtPercentile(50.0)) << " ms";
+            if (row.result.failures > 0) {
+                std::cout << " (key generation or EVP_PKEY_check failed)";
             }
-        });
-        
-        // Wait for all worker threads to complete
-        for (auto& t : threads) {
-            t.join();
+            std::cout << std::endl;
+            rows.push_back(std::move(row));
         }
         
-        done = true;
-        stats_thread.join();
+        printTable();
+    }
+    
+private:
+    void printTable() {
+        const bench::LatencyHistogram& stock = *rows.front().result.latency;
+        double stock_p50 = static_cast<double>(stock.valueAtPercentile(50.0));
         
-        // Print final statistics
-        std::cout << std::endl << std::endl;
-        std::cout << "Final Statistics:" << std::endl;
-        printStats();
-        std::cout << std::endl;
+        std::cout << std::endl << "Single-key latency (ms):" << std::endl;
+        std::cout << std::left << std::setw(10) << "Method" << std::right << std::setw(8) << "threads" << std::setw(7)
+                  << "keys" << std::setw(9) << "mean" << std::setw(9) << "p50" << std::setw(9) << "p90"
+                  << std::setw(9) << "p99" << std::setw(9) << "max" << std::setw(10) << "p50 gain" << std::setw(9)
+                  << "search" << std::setw(10) << "assemble" << std::setw(8) << "check" << std::setw(8) << "primes"
+                  << std::endl;
+        for (const auto& row : rows) {
+            const bench::LatencyHistogram& hist = *row.result.latency;
+            std::cout << std::left << std::setw(10) << row.method << std::right << std::setw(8) << row.threads
+                      << std::setw(7) << row.result.operations << std::fixed << std::setprecision(1) << std::setw(9)
+                      << hist.mean() / 1e6 << std::setw(9) << bench::nsToMs(hist.valueAtPercentile(50.0))
+                      << std::setw(9) << bench::nsToMs(hist.valueAtPercentile(90.0)) << std::setw(9)
+                      << bench::nsToMs(hist.valueAtPercentile(99.0)) << std::setw(9) << bench::nsToMs(hist.max());
+            double p50 = static_cast<double>(hist.valueAtPercentile(50.0));
+            std::ostringstream gain;
+            gain << std::fixed << std::setprecision(2) << (p50 > 0.0 ? stock_p50 / p50 : 0.0) << "x";
+            std::cout << std::setw(10) << gain.str();
+            const bench::SingleKeyTimes& t = row.times;
+            if (t.keys > 0) {
+                std::cout << std::setw(9) << t.search_ns / 1e6 / t.keys << std::setprecision(2) << std::setw(10)
+                          << t.assemble_ns / 1e6 / t.keys << std::setw(8) << t.check_ns / 1e6 / t.keys
+                          << std::setprecision(1) << std::setw(8) << static_cast<double>(t.candidates) / t.keys;
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "p50 gain: stock p50 over this p50. search/assemble/check: mean ms per key spent finding p and q"
+                  << std::endl;
+        std::cout << "(until the losing searchers stopped), building the key with EVP_PKEY_fromdata, and in"
+                  << std::endl;
+        std::cout << "EVP_PKEY_check. primes: primes found per key, including any rejected before two were accepted."
+                  << std::endl;
+        std::cout << "stock uses OpenSSL's SP 800-56B generation (auxiliary primes) for two-prime keys of 2048 bits"
+                  << std::endl;
+        std::cout << "and up; parallel tests plain probable primes, so it can win even on one thread." << std::endl;
+        std::cout << "Usable CPUs: " << bench::cpuTopology().usableCpus()
+                  << "; search threads beyond that only add scheduling delay." << std::endl;
     }
 };
 
 void printUsage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " <keysize> <num_threads> <num_loops>" << std::endl;
+    std::cout << "Usage: " << program_name << " <keysize> <num_threads> <num_loops> [options]" << std::endl;
     std::cout << "  keysize     - RSA key size in bits (e.g., 1024, 2048, 4096)" << std::endl;
     std::cout << "  num_threads - Number of worker threads" << std::endl;
-    std::cout << "  num_loops   - Number of key pairs to generate per thread" << std::endl;
+    std::cout << "  num_loops   - Number of key pairs to generate per thread (on average with the" << std::endl;
+    std::cout << "                default dynamic schedule; the total is num_threads*num_loops)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --primes N[,N...]     - Primes per modulus, 2 (default) to 5; more than one count runs" << std::endl;
+    std::cout << "                          each and compares them. RSA-1024+ allows 3, RSA-4096+ 4," << std::endl;
+    std::cout << "                          RSA-8192 5" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Single-key latency mode (one key at a time; num_loops keys per configuration):" << std::endl;
+    std::cout << "  --single-key          - Time stock EVP_PKEY_keygen, then a p/q search run concurrently on" << std::endl;
+    std::cout << "                          1, 2, 4, ... num_threads threads, assembled with EVP_PKEY_fromdata" << std::endl;
+    std::cout << "                          and validated with EVP_PKEY_check" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Key pool mode (num_threads producers fill a pool; num_threads*num_loops keys are consumed):" << std::endl;
+    std::cout << "  --pool                - Pre-generate keys into a bounded lock-free pool" << std::endl;
+    std::cout << "  --pool-size N         - Pool capacity in keys, at least 2 (default 64)" << std::endl;
+    std::cout << "  --consumers N         - Consumer threads draining the pool (default 1)" << std::endl;
+    std::cout << "  --demand R            - Total consumer demand in keys/s (default: unthrottled)" << std::endl;
+    std::cout << "  --no-prefill          - Start consumers against an empty pool" << std::endl;
     std::cout << std::endl;
-    std::cout << "Example: " << program_name << " 2048 4 100" << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " 2048 4 100" << std::endl;
+    std::cout << "  " << program_name << " 4096 4 10 --primes 2,3,4  # multi-prime keygen cost" << std::endl;
+    std::cout << "  " << program_name << " 4096 8 20 --single-key    # latency of one on-demand key" << std::endl;
+    std::cout << "  " << program_name << " 2048 4 50 --pool --pool-size 32 --demand 20  # size a key pool" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
+    if (argc < 4) {
         printUsage(argv[0]);
         return 1;
     }
@@ -231,11 +684,147 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    bench::RunConfig config = RSAGenerator::defaultConfig();
+    PoolConfig pool_config;
+    std::vector<int> primes = {2};
+    bool single_key = false;
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+        
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--primes" && bench::optionValue(argc, argv, i, value)) {
+            if (!bench::parseRSAPrimes(value, primes)) {
+                std::cerr << "Error: --primes takes prime counts between 2 and 5" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--single-key") {
+            single_key = true;
+        } else if (arg == "--pool") {
+            pool_config.enabled = true;
+        } else if (arg == "--no-prefill") {
+            pool_config.prefill = false;
+        } else if (arg == "--pool-size" && bench::optionValue(argc, argv, i, value)) {
+            pool_config.capacity = std::strtoull(value.c_str(), nullptr, 10);
+            if (pool_config.capacity < 2) {
+                std::cerr << "Error: Pool size must be at least 2" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--consumers" && bench::optionValue(argc, argv, i, value)) {
+            pool_config.consumers = std::atoi(value.c_str());
+            if (pool_config.consumers < 1 || pool_config.consumers > 100) {
+                std::cerr << "Error: Number of consumers must be between 1 and 100" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--demand" && bench::optionValue(argc, argv, i, value)) {
+            pool_config.demand_rate = std::atof(value.c_str());
+            if (pool_config.demand_rate < 0.0) {
+                std::cerr << "Error: Demand must not be negative" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    for (int count : primes) {
+        if (count > bench::maxRSAPrimes(keysize)) {
+            std::cerr << "Error: RSA-" << keysize << " keys can have at most " << bench::maxRSAPrimes(keysize)
+                      << " primes" << std::endl;
+            return 1;
+        }
+    }
+    if (pool_config.enabled && primes.size() > 1) {
+        std::cerr << "Error: --pool takes a single --primes count" << std::endl;
+        return 1;
+    }
+    pool_config.primes = primes[0];
+    if (single_key) {
+        if (pool_config.enabled || primes.size() > 1 || primes[0] != 2) {
+            std::cerr << "Error: --single-key generates two-prime keys and cannot be combined with --pool or --primes"
+                      << std::endl;
+            return 1;
+        }
+        if (config.sweep || config.compare_libctx) {
+            std::cerr << "Error: --single-key already varies the thread count; it cannot be combined with --sweep"
+                      << " or --libctx compare" << std::endl;
+            return 1;
+        }
+        if (config.async_jobs > 0 || config.async_sweep) {
+            std::cerr << "Error: --single-key runs its own prime search threads and cannot be combined with --async"
+                      << std::endl;
+            return 1;
+        }
+        if (config.openLoop() || config.rate_sweep) {
+            std::cerr << "Error: --single-key measures one key at a time and cannot be combined with --rate" << std::endl;
+            return 1;
+        }
+        // The p and q searchers race, so which candidates get tried depends on timing
+        if (config.seeded) {
+            std::cerr << "Error: --seed cannot be combined with --single-key" << std::endl;
+            return 1;
+        }
+        if (keysize % 2 != 0) {
+            std::cerr << "Error: --single-key needs an even key size" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Pooled keys outlive the producer that made them, so they must all
+    // come from the shared context
+    if (pool_config.enabled && (config.libctx_mode != bench::LibCtxMode::Shared || config.compare_libctx)) {
+        std::cerr << "Error: --libctx cannot be combined with --pool" << std::endl;
+        return 1;
+    }
+    // The pool runs its own producer and consumer threads outside the engine
+    if (pool_config.enabled && (config.placement != bench::Placement::None || config.timeBounded() ||
+                                config.warmup_seconds > 0.0)) {
+        std::cerr << "Error: --pin, --duration, --warmup and --steady-state cannot be combined with --pool"
+                  << std::endl;
+        return 1;
+    }
+    if (pool_config.enabled && (config.openLoop() || config.rate_sweep || config.async_jobs > 0 ||
+                                config.async_sweep)) {
+        std::cerr << "Error: --pool consumers draw at --demand; --rate, --rate-sweep and --async do not apply"
+                  << std::endl;
+        return 1;
+    }
+    // Producers refill the pool as consumers drain it, so how many keys
+    // each one makes depends on timing
+    if (pool_config.enabled && config.seeded) {
+        std::cerr << "Error: --seed cannot be combined with --pool" << std::endl;
+        return 1;
+    }
+    
     // Initialize OpenSSL
     ERR_load_crypto_strings();
     
-    RSAGenerator generator;
-    generator.run(keysize, num_threads, num_loops);
+    RSAGenerator generator(config);
+    if (single_key) {
+        RSASingleKeyBenchmark single(generator, config);
+        single.run(keysize, num_threads, num_loops);
+    } else if (pool_config.enabled) {
+        RSAKeyPoolBenchmark pool(generator, config, pool_config);
+        pool.run(keysize, num_threads, static_cast<uint64_t>(num_threads) * num_loops);
+    } else {
+        for (size_t i = 0; i < primes.size(); i++) {
+            if (i > 0) {
+                std::cout << std::endl;
+            }
+            generator.run(keysize, primes[i], num_threads, num_loops);
+        }
+        generator.printPrimeSummary();
+    }
     
     // Cleanup OpenSSL
     ERR_free_strings();
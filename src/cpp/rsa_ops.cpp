@@ -0,0 +1,267 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+
+#include "bench/engine.h"
+#include "bench/keys.h"
+#include "bench/library_context.h"
+#include "bench/openssl_util.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/rsa_ops.h"
+#include "bench/scaling.h"
+
+// Every key size rsa_generator accepts
+static const std::vector<int> kAllKeySizes = {512, 1024, 2048, 3072, 4096, 6144, 8192};
+
+// Options specific to rsa_ops
+struct RsaOpsOptions {
+    std::vector<bench::RsaOp> ops;
+};
+
+class RSAOps {
+private:
+    bench::RunConfig config;
+    RsaOpsOptions options;
+    std::vector<bench::RsaOpResult> results;
+
+public:
+    explicit RSAOps(const bench::RunConfig& run_config, const RsaOpsOptions& ops_options)
+        : config(run_config), options(ops_options) {}
+
+    // Called on each worker thread: its own copy of the key and a context
+    // set up once for the operation
+    std::unique_ptr<bench::RsaOperation> createOperation(EVP_PKEY* key, bench::RsaOp op) {
+        bench::LibraryContext* libctx = bench::threadLibraryContext();
+        OSSL_LIB_CTX* ctx = libctx ? libctx->get() : nullptr;
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy key for thread" << std::endl;
+            return nullptr;
+        }
+        std::unique_ptr<bench::RsaOperation> operation(new bench::RsaOperation(thread_key, op, ctx));
+        if (!operation->valid()) {
+            bench::reportOpenSSLError(std::string("Failed to set up ") + bench::rsaOpInfo(op).name);
+            return nullptr;
+        }
+        return operation;
+    }
+
+    void run(const std::vector<int>& keysizes, int num_threads, int num_loops) {
+        std::cout << "Starting RSA operation matrix with:" << std::endl;
+        std::cout << "Key sizes:";
+        for (int bits : keysizes) {
+            std::cout << " " << bits;
+        }
+        std::cout << std::endl;
+        std::cout << "Threads: " << num_threads << std::endl;
+        std::cout << "Stats collection: " << bench::statsModeName(config.stats_mode) << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Loops per thread: " << num_loops << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        std::cout << "Library context: "
+                  << (config.compare_libctx ? "shared vs isolated" : bench::libCtxModeName(config.libctx_mode))
+                  << std::endl;
+        std::cout << "Operations:" << std::endl;
+        for (bench::RsaOp op : options.ops) {
+            const bench::RsaOpInfo& info = bench::rsaOpInfo(op);
+            std::cout << "  " << std::left << std::setw(21) << info.name << std::right << "- " << info.description
+                      << std::endl;
+        }
+
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+        config.unit_label = "Operations";
+        config.rate_label = "ops/s";
+        for (int bits : keysizes) {
+            std::cout << std::endl;
+            std::cout << "RSA-" << bits << ": generating key..." << std::endl;
+            EVP_PKEY* key = bench::generateRSAKey(bits);
+            if (!key) {
+                bench::reportOpenSSLError("Failed to generate RSA key");
+                continue;
+            }
+            for (bench::RsaOp op : options.ops) {
+                measure(key, bits, op);
+            }
+            EVP_PKEY_free(key);
+        }
+
+        if (!config.compare_libctx && !config.sweep && !config.async_sweep && !config.rate_sweep) {
+            bench::printRsaOpMatrix(std::cout, config, keysizes, options.ops, results);
+        }
+    }
+
+private:
+    void measure(EVP_PKEY* key, int bits, bench::RsaOp op) {
+        const bench::RsaOpInfo& info = bench::rsaOpInfo(op);
+        bench::RsaOpResult row;
+        row.op = op;
+        row.bits = bits;
+        if (!bench::rsaOpFits(op, bits)) {
+            std::cout << "  " << info.name << ": skipped, padding does not fit RSA-" << bits << std::endl;
+            results.push_back(row);
+            return;
+        }
+
+        auto make_op = [this, key, op](int) { return createOperation(key, op); };
+        std::string workload = std::string("rsa_ops ") + info.name + " RSA-" + std::to_string(bits);
+        if (config.rate_sweep) {
+            std::cout << "  " << info.name << ":" << std::endl;
+            bench::runRateSweep(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.async_sweep) {
+            std::cout << "  " << info.name << ":" << std::endl;
+            bench::compareAsyncJobs(std::cout, config, workload, make_op);
+            return;
+        }
+        if (config.compare_libctx) {
+            std::cout << "  " << info.name << ":" << std::endl;
+            bench::compareLibraryContexts(std::cout, config, make_op);
+            return;
+        }
+        if (config.sweep) {
+            std::cout << "  " << info.name << ":" << std::endl;
+            bench::runSweep(std::cout, config, workload, make_op);
+            return;
+        }
+
+        // One line per operation; the matrix at the end has the comparison
+        bench::RunConfig quiet = config;
+        quiet.live_stats = false;
+        bench::RunResult result = bench::run(quiet, make_op);
+        bench::saveResult(config, workload, result);
+
+        row.measured = result.operations > 0;
+        row.throughput = result.throughput();
+        row.mean_ns = result.latency->mean();
+        row.p50_ns = result.latency->valueAtPercentile(50.0);
+        row.p99_ns = result.latency->valueAtPercentile(99.0);
+        row.failures = result.failures;
+        results.push_back(row);
+
+        std::cout << "  " << std::left << std::setw(21) << info.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << row.throughput << " ops/s" << std::setprecision(3)
+                  << "  p50 " << std::setw(9) << bench::nsToMs(row.p50_ns) << " ms  p99 " << std::setw(9)
+                  << bench::nsToMs(row.p99_ns) << " ms";
+        if (row.failures > 0) {
+            std::cout << "  (" << row.failures << " failed)";
+        }
+        std::cout << std::endl;
+    }
+};
+
+static bool parseKeySizes(const std::string& list, std::vector<int>& keysizes) {
+    keysizes.clear();
+    if (list == "ALL" || list == "all") {
+        keysizes = kAllKeySizes;
+        return true;
+    }
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        int bits = std::atoi(item.c_str());
+        if (bits < 512 || bits > 8192) {
+            return false;
+        }
+        keysizes.push_back(bits);
+    }
+    return !keysizes.empty();
+}
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <key_sizes> <num_threads> <num_loops> [options]" << std::endl;
+    std::cout << "  key_sizes   - Comma-separated RSA key sizes (512-8192), or ALL for" << std::endl;
+    std::cout << "                512,1024,2048,3072,4096,6144,8192" << std::endl;
+    std::cout << "  num_threads - Number of worker threads" << std::endl;
+    std::cout << "  num_loops   - Number of operations per thread for each operation and key size" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --ops LIST            - Comma-separated operations to measure, or all (default)" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Operations:" << std::endl;
+    for (const auto& info : bench::rsaOps()) {
+        std::cout << "  " << std::left << std::setw(21) << info.name << std::right << "- " << info.description
+                  << std::endl;
+    }
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " 2048 4 500                  # Every operation on RSA-2048, 4 threads" << std::endl;
+    std::cout << "  " << program_name << " ALL 8 200                   # Full matrix" << std::endl;
+    std::cout << "  " << program_name << " 2048,4096 4 500 --ops sign-pkcs1,sign-pss,raw-private" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<int> keysizes;
+    if (!parseKeySizes(argv[1], keysizes)) {
+        std::cerr << "Error: Key sizes must be ALL or a comma-separated list of sizes between 512 and 8192"
+                  << std::endl;
+        return 1;
+    }
+    int num_threads = std::atoi(argv[2]);
+    int num_loops = std::atoi(argv[3]);
+
+    if (num_threads < 1 || num_threads > 100) {
+        std::cerr << "Error: Number of threads must be between 1 and 100" << std::endl;
+        return 1;
+    }
+
+    if (num_loops < 1) {
+        std::cerr << "Error: Number of loops must be at least 1" << std::endl;
+        return 1;
+    }
+
+    bench::RunConfig config;
+    RsaOpsOptions options;
+    bench::parseRsaOps("all", options.ops);
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--ops" && bench::optionValue(argc, argv, i, value)) {
+            if (!bench::parseRsaOps(value, options.ops)) {
+                std::cerr << "Error: Unknown operation in --ops '" << value << "'" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Initialize OpenSSL
+    ERR_load_crypto_strings();
+
+    RSAOps matrix(config, options);
+    matrix.run(keysizes, num_threads, num_loops);
+
+    // Cleanup OpenSSL
+    ERR_free_strings();
+
+    return 0;
+}
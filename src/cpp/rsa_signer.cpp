@@ -0,0 +1,342 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <openssl/rsa.h>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+
+#include "bench/algorithms.h"
+#include "bench/engine.h"
+#include "bench/keys.h"
+#include "bench/library_context.h"
+#include "bench/openssl_util.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/rsa_primes.h"
+#include "bench/scaling.h"
+#include "bench/signature_ops.h"
+#include "bench/signer.h"
+#include "bench/stream_ops.h"
+
+class RSASigner : public bench::SignerBench {
+private:
+    std::vector<int> prime_counts;         // --primes: one key per prime count
+    int key_bits = 0;                      // the key being measured
+    int key_primes = 2;
+    std::vector<bench::PrimeCountResult> prime_results;
+
+    static const size_t kMessageSize = 32;
+
+public:
+    explicit RSASigner(const bench::RunConfig& run_config = bench::RunConfig(),
+                       const bench::SignerOptions& signer_options = bench::SignerOptions(),
+                       const std::vector<int>& primes = std::vector<int>(1, 2))
+        : SignerBench(run_config, signer_options, bench::SignatureParams::rsaPSS()), prime_counts(primes) {}
+
+    // Called on each worker thread. RSA keygen is far too slow to repeat per
+    // thread, so every worker signs with its own copy of one shared key.
+    std::unique_ptr<bench::SignOperation> createSignOperation(EVP_PKEY* key, const bench::SignatureParams& op_params,
+                                                              bench::ContextStrategy strategy,
+                                                              bench::PhaseTimes* phase_sink) {
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy RSA key for thread" << std::endl;
+            return nullptr;
+        }
+
+        std::unique_ptr<bench::SignOperation> op(new bench::SignOperation(thread_key, op_params, kMessageSize, strategy, phase_sink));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
+            return nullptr;
+        }
+        return op;
+    }
+
+    std::unique_ptr<bench::VerifyOperation> createVerifyOperation(EVP_PKEY* key, const bench::SignatureCorpus& corpus,
+                                                                  const bench::SignatureParams& op_params,
+                                                                  int thread_index, int num_threads) {
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy RSA key for thread" << std::endl;
+            return nullptr;
+        }
+
+        size_t start = corpus.size() * thread_index / num_threads;
+        std::unique_ptr<bench::VerifyOperation> op(new bench::VerifyOperation(thread_key, op_params, corpus, start));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
+            return nullptr;
+        }
+        return op;
+    }
+
+    std::unique_ptr<bench::StreamOperation> createStreamOperation(EVP_PKEY* key, const bench::MessageInput& input,
+                                                                  const std::vector<unsigned char>* signature,
+                                                                  bench::PhaseTimes* phase_sink) {
+        EVP_PKEY* thread_key = bench::copyKeyForThread(key);
+        if (!thread_key) {
+            std::cerr << "Failed to copy RSA key for thread" << std::endl;
+            return nullptr;
+        }
+
+        std::unique_ptr<bench::StreamOperation> op(new bench::StreamOperation(
+            thread_key, paramsFor(options.fetch_mode), input, options.streaming.chunk, signature, phase_sink));
+        if (!op->valid()) {
+            std::cerr << "Failed to create MD context for thread" << std::endl;
+            return nullptr;
+        }
+        return op;
+    }
+
+    void run(int keysize, int primes, int num_threads, int num_loops) {
+        std::cout << "Starting RSA " << (options.verify ? "verification" : "signing")
+                  << " performance test with:" << std::endl;
+        std::cout << "Key size: " << keysize << " bits" << std::endl;
+        std::cout << "Primes: " << primes << (primes == 2 ? "" : " (multi-prime)") << std::endl;
+        std::cout << "Threads: " << num_threads << std::endl;
+        std::cout << "Stats collection: " << bench::statsModeName(config.stats_mode) << std::endl;
+        if (!config.timeBounded()) {
+            std::cout << "Loops per thread: " << num_loops << std::endl;
+            std::cout << (options.verify ? "Total verifications: " : "Total signatures to generate: ")
+                      << (num_threads * num_loops) << std::endl;
+        }
+        bench::printRunLength(std::cout, config);
+        if (options.streaming.enabled()) {
+            std::cout << (options.streaming.file.empty() ? "Messages: " : "Message: ") << messages.describe()
+                      << ", fed in " << bench::formatByteSize(options.streaming.chunk) << " chunks" << std::endl;
+        } else if (options.verify) {
+            std::cout << "Corpus: " << options.corpus_size << " distinct 32-byte messages, signed up front" << std::endl;
+        } else {
+            std::cout << "Data size: 32 bytes (random data per signature)" << std::endl;
+        }
+        std::cout << "Algorithm: " << params.describe() << std::endl;
+        std::cout << "Library context: "
+                  << (config.compare_libctx ? "shared vs isolated" : bench::libCtxModeName(config.libctx_mode))
+                  << std::endl;
+        std::cout << "Algorithm fetch: "
+                  << (options.compare_fetch ? "implicit vs explicit" : bench::fetchModeName(options.fetch_mode)) << std::endl;
+        if (!options.verify) {
+            std::cout << "Context strategy: "
+                      << (options.compare_strategies ? "all" : bench::contextStrategyName(options.strategy)) << std::endl;
+        }
+        std::cout << std::endl;
+
+        EVP_PKEY* key = bench::generateRSAKey(keysize, nullptr, primes);
+        if (!key) {
+            bench::reportOpenSSLError("RSA key generation failed");
+            return;
+        }
+
+        config.num_threads = num_threads;
+        config.loops_per_thread = num_loops;
+        workload = std::string("rsa_signer ") + (options.verify ? "verify" : "sign") + " RSA-PSS-" +
+                   std::to_string(keysize) + bench::rsaPrimesSuffix(primes);
+        key_bits = keysize;
+        key_primes = primes;
+
+        if (!fetchAlgorithms("RSA")) {
+            bench::reportOpenSSLError("Failed to fetch SHA-256 and RSA");
+            EVP_PKEY_free(key);
+            return;
+        }
+
+        if (options.streaming.enabled()) {
+            std::cout << (options.verify ? "Streaming verification:" : "Streaming signatures:") << std::endl;
+            std::vector<bench::StreamingPoint> points = bench::runStreaming(
+                config, workload, options.verify, key, params, messages.messages(), options.streaming.chunk,
+                [this, key](const bench::MessageInput& input, const std::vector<unsigned char>* signature, int,
+                            bench::PhaseTimes* sink) { return createStreamOperation(key, input, signature, sink); });
+            bench::printStreamingTable(std::cout, config, points);
+            EVP_PKEY_free(key);
+            return;
+        }
+
+        if (!options.verify) {
+            if (options.compare_fetch) {
+                compareFetch([this, key](bench::FetchMode mode, int) {
+                    return createSignOperation(key, paramsFor(mode), options.strategy, nullptr);
+                });
+            } else if (options.compare_strategies) {
+                compareStrategies([this, key](bench::ContextStrategy strategy, int, bench::PhaseTimes* sink) {
+                    return createSignOperation(key, paramsFor(options.fetch_mode), strategy, sink);
+                });
+            } else {
+                execute([this, key](int thread_index) {
+                    return createSignOperation(key, paramsFor(options.fetch_mode), options.strategy,
+                                               phaseSink(thread_index));
+                });
+            }
+            EVP_PKEY_free(key);
+            return;
+        }
+
+        bench::SignatureCorpus corpus;
+        if (!corpus.build(key, params, options.corpus_size, kMessageSize)) {
+            bench::reportOpenSSLError("Failed to build the signature corpus");
+            EVP_PKEY_free(key);
+            return;
+        }
+        if (options.compare_fetch) {
+            compareFetch([this, key, &corpus](bench::FetchMode mode, int thread_index) {
+                return createVerifyOperation(key, corpus, paramsFor(mode), thread_index, config.num_threads);
+            });
+        } else {
+            execute([this, key, &corpus](int thread_index) {
+                return createVerifyOperation(key, corpus, paramsFor(options.fetch_mode), thread_index,
+                                             config.num_threads);
+            });
+        }
+        EVP_PKEY_free(key);
+    }
+
+    // Signing or verification cost of every key size and prime count, side by side
+    void printPrimeSummary() {
+        if (prime_counts.size() > 1 && !prime_results.empty()) {
+            std::cout << std::endl << std::endl << (options.verify ? "Verification" : "Signing") << " by prime count:";
+            bench::printPrimeCountTable(std::cout, config.rate_label, prime_results);
+        }
+    }
+
+private:
+    // Every measured run of the current key feeds the prime-count summary
+    template <typename OpFactory>
+    void execute(OpFactory make_op) {
+        SignerBench::execute(make_op, runSettings(), [this](const bench::RunResult& result) {
+            bench::PrimeCountResult row;
+            row.bits = key_bits;
+            row.primes = key_primes;
+            row.throughput = result.throughput();
+            row.mean_ns = result.latency->mean();
+            row.p50_ns = result.latency->valueAtPercentile(50.0);
+            row.p99_ns = result.latency->valueAtPercentile(99.0);
+            row.failures = result.failures;
+            prime_results.push_back(row);
+        });
+    }
+};
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <keysize[,keysize...]> <num_threads> <num_loops> [options]" << std::endl;
+    std::cout << "  keysize     - RSA key size(s) in bits (e.g., 2048 or 2048,3072,4096)" << std::endl;
+    std::cout << "  num_threads - Number of worker threads" << std::endl;
+    std::cout << "  num_loops   - Number of signatures to generate per thread" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    bench::printSignerOptions(std::cout);
+    std::cout << "  --primes N[,N...]     - Primes per modulus, 2 (default) to 5, each measured on its own key;" << std::endl;
+    std::cout << "                          counts a key size does not allow (3 needs RSA-1024+, 4 RSA-4096+," << std::endl;
+    std::cout << "                          5 RSA-8192+) are skipped" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " 2048 4 250                     # 1000 RSA-PSS-2048 signatures, 4 threads" << std::endl;
+    std::cout << "  " << program_name << " 2048,3072,4096 8 2000 --verify  # Verify throughput for three key sizes" << std::endl;
+    std::cout << "  " << program_name << " 4096 4 500 --primes 2,3,4          # Multi-prime signing speedup" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<int> keysizes;
+    std::stringstream keysize_list(argv[1]);
+    std::string item;
+    while (std::getline(keysize_list, item, ',')) {
+        int keysize = std::atoi(item.c_str());
+        if (keysize < 512 || keysize > 16384) {
+            std::cerr << "Error: Key size must be between 512 and 16384 bits" << std::endl;
+            return 1;
+        }
+        keysizes.push_back(keysize);
+    }
+    int num_threads = std::atoi(argv[2]);
+    int num_loops = std::atoi(argv[3]);
+
+    if (keysizes.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (num_threads < 1 || num_threads > 100) {
+        std::cerr << "Error: Number of threads must be between 1 and 100" << std::endl;
+        return 1;
+    }
+
+    if (num_loops < 1) {
+        std::cerr << "Error: Number of loops must be at least 1" << std::endl;
+        return 1;
+    }
+
+    bench::RunConfig config;
+    bench::SignerOptions options;
+    std::vector<int> primes(1, 2);
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Unrecognized) {
+            status = bench::parseSignerOption(argc, argv, i, options, error);
+        }
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--primes" && bench::optionValue(argc, argv, i, value)) {
+            if (!bench::parseRSAPrimes(value, primes)) {
+                std::cerr << "Error: --primes takes prime counts between 2 and 5" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::string option_error;
+    if (!bench::checkSignerOptions(config, options, option_error)) {
+        std::cerr << "Error: " << option_error << std::endl;
+        return 1;
+    }
+
+    // Initialize OpenSSL
+    ERR_load_crypto_strings();
+
+    RSASigner signer(config, options, primes);
+    std::string load_error;
+    if (!signer.loadMessages(load_error)) {
+        std::cerr << "Error: " << load_error << std::endl;
+        return 1;
+    }
+    bool first = true;
+    for (int keysize : keysizes) {
+        for (int prime_count : primes) {
+            if (!first) {
+                std::cout << std::endl << std::endl;
+            }
+            first = false;
+            if (prime_count > bench::maxRSAPrimes(keysize)) {
+                std::cout << "Skipping RSA-" << keysize << " with " << prime_count << " primes: at most "
+                          << bench::maxRSAPrimes(keysize) << " allowed" << std::endl;
+                continue;
+            }
+            signer.run(keysize, prime_count, num_threads, num_loops);
+        }
+    }
+    signer.printPrimeSummary();
+
+    // Cleanup OpenSSL
+    ERR_free_strings();
+
+    return 0;
+}
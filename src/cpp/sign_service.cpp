@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+#include <unistd.h>
+
+#include "bench/curves.h"
+#include "bench/engine.h"
+#include "bench/openssl_util.h"
+#include "bench/options.h"
+#include "bench/report.h"
+#include "bench/results.h"
+#include "bench/scaling.h"
+#include "bench/sign_service.h"
+
+// Options specific to sign_service
+struct ServiceOptions {
+    enum Mode { Both, Serve, Connect };
+
+    Mode mode = Both;
+    bench::ServiceConfig server;
+    size_t message_size = 32;
+    bool batch_sweep = false;
+};
+
+class SignService {
+private:
+    bench::RunConfig config;
+    ServiceOptions options;
+    const bench::CurveInfo* curve = nullptr;
+    bench::SignatureParams params;
+
+public:
+    SignService(const bench::RunConfig& run_config, const ServiceOptions& service_options)
+        : config(run_config), options(service_options) {}
+
+    // Called on each worker thread: the worker's own connection, used for
+    // one request at a time
+    std::unique_ptr<bench::ServiceRequestOperation> createRequestOperation() {
+        std::string error;
+        int fd = bench::connectService(options.server.socket_path, error);
+        if (fd < 0) {
+            std::cerr << "Failed to connect: " << error << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<bench::ServiceRequestOperation>(
+            new bench::ServiceRequestOperation(fd, options.message_size));
+    }
+
+    int run(const std::string& curve_name, int num_connections, int num_requests) {
+        curve = bench::findCurve(bench::signatureCurves(), curve_name);
+        if (!curve) {
+            std::cerr << "Error: Unsupported curve '" << curve_name << "'" << std::endl;
+            std::cerr << "Supported curves: P256, P384, P521, Ed25519, Ed448" << std::endl;
+            return 1;
+        }
+        params.one_shot = bench::isEdDSA(*curve);
+
+        std::cout << "Starting signing service test with:" << std::endl;
+        if (options.mode != ServiceOptions::Connect) {
+            std::cout << "Server: " << curve->name << " " << (params.one_shot ? "EdDSA" : "ECDSA with SHA-256")
+                      << ", " << options.server.workers << " signing worker(s), batches of up to "
+                      << (options.batch_sweep ? std::string("1..") : std::string())
+                      << options.server.max_batch << " waiting at most " << options.server.max_wait_us << " us"
+                      << std::endl;
+        }
+        std::cout << "Socket: " << options.server.socket_path << std::endl;
+        if (options.mode != ServiceOptions::Serve) {
+            std::cout << "Connections: " << num_connections << ", one request in flight each" << std::endl;
+            if (!config.timeBounded()) {
+                std::cout << "Requests per connection: " << num_requests << std::endl;
+            }
+            std::cout << "Message size: " << options.message_size << " bytes (random data per request)" << std::endl;
+            bench::printRunLength(std::cout, config);
+        }
+        std::cout << std::endl;
+
+        config.num_threads = num_connections;
+        config.loops_per_thread = num_requests;
+        config.unit_label = "Requests";
+        config.rate_label = "requests/s";
+        if (options.mode == ServiceOptions::Serve) {
+            return serve();
+        }
+        if (options.mode == ServiceOptions::Connect) {
+            measure(nullptr);
+            return 0;
+        }
+        if (options.batch_sweep) {
+            return batchSweep();
+        }
+
+        std::unique_ptr<bench::SignServer> server = startServer(options.server);
+        if (!server) {
+            return 1;
+        }
+        measure(server.get());
+        return 0;
+    }
+
+private:
+    std::unique_ptr<bench::SignServer> startServer(const bench::ServiceConfig& server_config) {
+        EVP_PKEY* key = bench::generateCurveKey(*curve);
+        if (!key) {
+            bench::reportOpenSSLError("Failed to generate the server key");
+            return nullptr;
+        }
+        std::unique_ptr<bench::SignServer> server(new bench::SignServer(server_config, key, params));
+        std::string error;
+        if (!server->start(error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return nullptr;
+        }
+        return server;
+    }
+
+    std::string workload(const bench::ServiceConfig& server_config) const {
+        return std::string("sign_service ") + curve->name + " batch-" + std::to_string(server_config.max_batch) +
+               " wait-" + std::to_string(server_config.max_wait_us) + "us";
+    }
+
+    // Run the clients against `server`, or against an external server when
+    // it is null, and report both sides
+    void measure(bench::SignServer* server) {
+        auto make_op = [this](int) { return createRequestOperation(); };
+        std::string name = workload(options.server);
+        if (config.rate_sweep) {
+            bench::runRateSweep(std::cout, config, name, make_op);
+            return;
+        }
+        if (config.sweep) {
+            bench::runSweep(std::cout, config, name, make_op);
+            return;
+        }
+        bench::ServiceStats before = server ? server->stats() : bench::ServiceStats();
+        bench::RunResult result = bench::run(config, make_op);
+        bench::printRunReport(std::cout, config, result);
+        bench::saveResult(config, name, result);
+        if (server) {
+            printServerStats(difference(server->stats(), before));
+        }
+    }
+
+    int batchSweep() {
+        std::vector<int> steps;
+        for (int batch = 1; batch < options.server.max_batch; batch *= 2) {
+            steps.push_back(batch);
+        }
+        steps.push_back(options.server.max_batch);
+
+        std::cout << "Batch sweep (" << config.num_threads << " connections, " << options.server.workers
+                  << " signing worker(s)):" << std::endl;
+        std::vector<bench::ServicePoint> points;
+        for (int batch : steps) {
+            bench::ServiceConfig server_config = options.server;
+            server_config.max_batch = batch;
+            std::unique_ptr<bench::SignServer> server = startServer(server_config);
+            if (!server) {
+                return 1;
+            }
+            std::cout << "  batch " << batch << "..." << std::flush;
+            bench::RunConfig quiet = config;
+            quiet.live_stats = false;
+            bench::RunResult result = bench::run(quiet, [this](int) { return createRequestOperation(); });
+            server->stop();
+            bench::saveResult(config, workload(server_config), result);
+
+            bench::ServicePoint point;
+            point.max_batch = batch;
+            point.max_wait_us = server_config.max_wait_us;
+            point.throughput = result.throughput();
+            point.p50_ns = result.latency->valueAtPercentile(50.0);
+            point.p99_ns = result.latency->valueAtPercentile(99.0);
+            point.p999_ns = result.latency->valueAtPercentile(99.9);
+            point.client_failures = result.failures;
+            point.server = server->stats();
+            points.push_back(point);
+            std::cout << " " << static_cast<uint64_t>(point.throughput) << " " << config.rate_label << std::endl;
+        }
+        bench::printServiceTable(std::cout, config, points);
+        return 0;
+    }
+
+    // --serve: run until SIGINT or SIGTERM
+    int serve() {
+        // Blocked before the server's threads start, so they inherit the mask
+        // and the signal is left for sigwait below
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        std::unique_ptr<bench::SignServer> server = startServer(options.server);
+        if (!server) {
+            return 1;
+        }
+        std::cout << "Serving on " << options.server.socket_path << "; Ctrl-C to stop" << std::endl;
+        int signal = 0;
+        sigwait(&signals, &signal);
+        server->stop();
+        std::cout << std::endl;
+        printServerStats(server->stats());
+        return 0;
+    }
+
+    static bench::ServiceStats difference(const bench::ServiceStats& after, const bench::ServiceStats& before) {
+        bench::ServiceStats stats;
+        stats.requests = after.requests - before.requests;
+        stats.failures = after.failures - before.failures;
+        stats.batches = after.batches - before.batches;
+        stats.queue_ns = after.queue_ns - before.queue_ns;
+        stats.sign_ns = after.sign_ns - before.sign_ns;
+        return stats;
+    }
+
+    void printServerStats(const bench::ServiceStats& stats) {
+        std::cout << "Server: " << stats.requests << " requests in " << stats.batches << " batches (mean "
+                  << std::fixed << std::setprecision(2) << stats.meanBatch() << "), mean queue wait "
+                  << std::setprecision(3) << bench::nsToMs(static_cast<uint64_t>(stats.meanQueueNs()))
+                  << "ms, mean sign " << bench::nsToMs(static_cast<uint64_t>(stats.meanSignNs())) << "ms";
+        if (stats.failures > 0) {
+            std::cout << ", " << stats.failures << " failed";
+        }
+        std::cout << std::endl;
+    }
+};
+
+void printUsage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <curve> <num_connections> <num_requests> [options]" << std::endl;
+    std::cout << "  curve           - Signing curve (P256, P384, P521, Ed25519, Ed448)" << std::endl;
+    std::cout << "  num_connections - Client connections, one engine worker and one request in flight each" << std::endl;
+    std::cout << "  num_requests    - Requests per connection" << std::endl;
+    std::cout << std::endl;
+    std::cout << "By default the server runs in this process on a private socket and the clients measure it." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --workers N           - Signing threads in the server (default 1)" << std::endl;
+    std::cout << "  --batch N             - Requests a worker takes from the queue at once (default 1)" << std::endl;
+    std::cout << "  --batch-wait US       - Longest the oldest queued request waits for a batch to fill" << std::endl;
+    std::cout << "                          (default 0: take whatever is queued)" << std::endl;
+    std::cout << "  --batch-sweep         - Restart the server at batch sizes 1, 2, 4, ... --batch (default 16)" << std::endl;
+    std::cout << "                          and compare them" << std::endl;
+    std::cout << "  --message-size BYTES  - Request message size (default 32)" << std::endl;
+    std::cout << "  --socket PATH         - Unix socket path (default /tmp/sign_service.sock, or a per-process" << std::endl;
+    std::cout << "                          path when server and clients share this process)" << std::endl;
+    std::cout << "  --serve               - Only run the server, until SIGINT/SIGTERM; connections and" << std::endl;
+    std::cout << "                          requests are ignored" << std::endl;
+    std::cout << "  --connect             - Only run the clients, against a server started with --serve" << std::endl;
+    bench::printCommonOptions(std::cout);
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  " << program_name << " P256 16 2000 --workers 2                  # 16 clients, no batching" << std::endl;
+    std::cout << "  " << program_name << " P256 32 1000 --batch-sweep --batch-wait 50" << std::endl;
+    std::cout << "  " << program_name << " P256 0 0 --serve --batch 8 &" << std::endl;
+    std::cout << "  " << program_name << " P256 16 2000 --connect --rate 20000" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string curve_name = argv[1];
+    int num_connections = std::atoi(argv[2]);
+    int num_requests = std::atoi(argv[3]);
+
+    // Convert to uppercase for consistency
+    std::transform(curve_name.begin(), curve_name.end(), curve_name.begin(), ::toupper);
+
+    bench::RunConfig config;
+    ServiceOptions options;
+    bool batch_given = false;
+    for (int i = 4; i < argc; i++) {
+        std::string error;
+        bench::OptionStatus status = bench::parseCommonOption(argc, argv, i, config, error);
+        if (status == bench::OptionStatus::Error) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        if (status == bench::OptionStatus::Consumed) {
+            continue;
+        }
+
+        std::string arg = argv[i];
+        std::string value;
+        if (arg == "--workers" && bench::optionValue(argc, argv, i, value)) {
+            options.server.workers = std::atoi(value.c_str());
+            if (options.server.workers < 1 || options.server.workers > 256) {
+                std::cerr << "Error: --workers must be between 1 and 256" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--batch" && bench::optionValue(argc, argv, i, value)) {
+            options.server.max_batch = std::atoi(value.c_str());
+            batch_given = true;
+            if (options.server.max_batch < 1 || options.server.max_batch > 4096) {
+                std::cerr << "Error: --batch must be between 1 and 4096" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--batch-wait" && bench::optionValue(argc, argv, i, value)) {
+            long wait = std::atol(value.c_str());
+            if (wait < 0 || wait > 1000000) {
+                std::cerr << "Error: --batch-wait must be between 0 and 1000000 microseconds" << std::endl;
+                return 1;
+            }
+            options.server.max_wait_us = static_cast<uint64_t>(wait);
+        } else if (arg == "--batch-sweep") {
+            options.batch_sweep = true;
+        } else if (arg == "--message-size" && bench::optionValue(argc, argv, i, value)) {
+            long size = std::atol(value.c_str());
+            if (size < 1 || size > static_cast<long>(bench::kServiceMaxMessage)) {
+                std::cerr << "Error: --message-size must be between 1 and " << bench::kServiceMaxMessage << std::endl;
+                return 1;
+            }
+            options.message_size = static_cast<size_t>(size);
+        } else if (arg == "--socket" && bench::optionValue(argc, argv, i, value)) {
+            options.server.socket_path = value;
+        } else if (arg == "--serve") {
+            options.mode = ServiceOptions::Serve;
+        } else if (arg == "--connect") {
+            options.mode = ServiceOptions::Connect;
+        } else {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.mode != ServiceOptions::Serve) {
+        if (num_connections < 1 || num_connections > 1000) {
+            std::cerr << "Error: Number of connections must be between 1 and 1000" << std::endl;
+            return 1;
+        }
+        if (num_requests < 1) {
+            std::cerr << "Error: Number of requests must be at least 1" << std::endl;
+            return 1;
+        }
+    }
+    if (options.batch_sweep && !batch_given) {
+        options.server.max_batch = 16;
+    }
+    if (options.batch_sweep && options.mode != ServiceOptions::Both) {
+        std::cerr << "Error: --batch-sweep restarts the server, so it needs server and clients in one process"
+                  << std::endl;
+        return 1;
+    }
+    if (options.batch_sweep && (config.sweep || config.rate_sweep)) {
+        std::cerr << "Error: only one of --batch-sweep, --sweep and --rate-sweep can be used at a time" << std::endl;
+        return 1;
+    }
+    // The clients only move bytes; there is nothing for these to act on
+    if (config.libctx_mode != bench::LibCtxMode::Shared || config.compare_libctx || config.async_jobs > 0 ||
+        config.async_sweep) {
+        std::cerr << "Error: --libctx and --async do not apply to sign_service" << std::endl;
+        return 1;
+    }
+    if (options.server.socket_path.empty()) {
+        options.server.socket_path = options.mode == ServiceOptions::Both
+                                         ? "/tmp/sign_service." + std::to_string(getpid()) + ".sock"
+                                         : "/tmp/sign_service.sock";
+    }
+
+    // Initialize OpenSSL
+    ERR_load_crypto_strings();
+
+    SignService service(config, options);
+    int status = service.run(curve_name, num_connections, num_requests);
+
+    // Cleanup OpenSSL
+    ERR_free_strings();
+
+    return status;
+}